@@ -1,20 +1,43 @@
 import esphome.codegen as cg
 import esphome.config_validation as cv
-from esphome.components import uart, number, switch, button
+from esphome import automation, pins
+from esphome.components import uart, number, switch, button, select, sensor
 from esphome.const import (
+    CONF_ACCELERATION,
+    CONF_DECELERATION,
+    CONF_DELAY,
     CONF_ID,
     CONF_ADDRESS,
+    CONF_BAUD_RATE,
+    CONF_INVERTED,
+    CONF_RX_PIN,
+    CONF_TX_PIN,
+    CONF_TYPE,
     CONF_NAME,
+    CONF_PIN,
+    CONF_PORT,
+    CONF_POSITION,
+    CONF_SIZE,
+    CONF_DURATION,
     ENTITY_CATEGORY_CONFIG,
+    ENTITY_CATEGORY_DIAGNOSTIC,
+    STATE_CLASS_MEASUREMENT,
+    STATE_CLASS_TOTAL_INCREASING,
+    UNIT_MILLISECOND,
+    UNIT_PERCENT,
 )
 
 CODEOWNERS = ["@lcasale"]
-DEPENDENCIES = ["uart"]
-AUTO_LOAD = ["number", "switch", "button"]
+AUTO_LOAD = ["number", "switch", "button", "select", "sensor", "socket"]
 
 CONF_UART_ID = "uart_id"
+CONF_UART_NUM = "uart_num"
+CONF_TRANSPORT = "transport"
+CONF_TRANSPORT_ID = "transport_id"
 CONF_MAX_SPEED = "max_speed"
 CONF_ENGINE = "engine"
+CONF_ENGINES = "engines"
+CONF_PROTOCOL = "protocol"
 CONF_SPEED = "speed"
 CONF_DIRECTION = "direction"
 CONF_HORN = "horn"
@@ -24,32 +47,211 @@ CONF_REAR_COUPLER = "rear_coupler"
 CONF_BOOST = "boost"
 CONF_BRAKE = "brake"
 CONF_STOP = "stop"
+CONF_AUX1_ON = "aux1_on"
+CONF_AUX1_OFF = "aux1_off"
+CONF_AUX1_OPTION1 = "aux1_option1"
+CONF_AUX1_OPTION2 = "aux1_option2"
+CONF_AUX2_ON = "aux2_on"
+CONF_AUX2_OFF = "aux2_off"
+CONF_AUX2_OPTION1 = "aux2_option1"
+CONF_AUX2_OPTION2 = "aux2_option2"
+CONF_LET_OFF = "let_off"
+CONF_HORN_PATTERNS = "horn_patterns"
+CONF_HORN_SIGNALS = "horn_signals"
+CONF_PATTERN_ID = "pattern_id"
+CONF_SEGMENTS_ID = "segments_id"
+CONF_SIGNAL = "signal"
+CONF_LONG = "long"
+CONF_SHORT = "short"
+CONF_GAP = "gap"
 CONF_TEST_BUTTON = "test_button"
+CONF_TRACE_BUTTON = "trace_button"
+CONF_TRACE_SIZE = "trace_size"
+CONF_FRAME_LOG = "frame_log"
+CONF_SWITCHES = "switches"
+CONF_ACCESSORIES = "accessories"
+CONF_ROUTES = "routes"
+CONF_SWITCH_ID = "switch_id"
+CONF_PACE = "pace"
+CONF_TRAINS = "trains"
+CONF_UNITS = "units"
+CONF_ENGINE_ID = "engine_id"
+CONF_REVERSED = "reversed"
+CONF_ASSIGN = "assign"
+CONF_ASSIGN_ON_BOOT = "assign_on_boot"
+CONF_SEQUENCES = "sequences"
+CONF_STEPS = "steps"
+CONF_ACTION = "action"
+CONF_REPEAT = "repeat"
+CONF_QUEUE_SIZE = "queue_size"
+CONF_DROP_POLICY = "drop_policy"
+CONF_STREAM_INTERVAL = "stream_interval"
+CONF_FRAMES_SENT = "frames_sent"
+CONF_BYTES_SENT = "bytes_sent"
+CONF_BUSY_TIME = "busy_time"
+CONF_BUS_UTILIZATION = "bus_utilization"
+CONF_QUEUE_HIGH_WATER = "queue_high_water"
+CONF_LATENCY_P50 = "latency_p50"
+CONF_LATENCY_P99 = "latency_p99"
+CONF_BRIDGE = "bridge"
+CONF_FRAME_GAP = "frame_gap"
+CONF_BURST_LIMIT = "burst_limit"
+CONF_BURST_PAUSE = "burst_pause"
+CONF_ADAPTIVE_PACING = "adaptive_pacing"
+CONF_MAX_FRAME_GAP = "max_frame_gap"
+CONF_HALT_REPETITIONS = "halt_repetitions"
+CONF_CAB = "cab"
+CONF_ROSTER = "roster"
+CONF_ROSTER_ID = "roster_id"
+CONF_SELECT = "select"
+CONF_SUPPRESS_DUPLICATES = "suppress_duplicates"
+CONF_REFRESH = "refresh"
+CONF_BUDGET = "budget"
+CONF_ESTOP = "estop"
+CONF_DEBOUNCE = "debounce"
+CONF_LATENCY = "latency"
+CONF_RECORDER = "recorder"
+CONF_RECORD_SWITCH = "record_switch"
+CONF_REPLAY_SWITCH = "replay_switch"
+CONF_DUMP_BUTTON = "dump_button"
 
 # Create namespace
 tmcc_ns = cg.esphome_ns.namespace("tmcc")
 
 # C++ class references
-TMCCBus = tmcc_ns.class_("TMCCBus", cg.Component)
+TMCCBus = tmcc_ns.class_("TMCCBus", cg.PollingComponent)
+TMCCTransport = tmcc_ns.class_("TMCCTransport")
+TMCCUARTTransport = tmcc_ns.class_("TMCCUARTTransport", TMCCTransport)
+TMCCIDFUARTTransport = tmcc_ns.class_("TMCCIDFUARTTransport", TMCCTransport)
+TMCCLoopbackTransport = tmcc_ns.class_("TMCCLoopbackTransport", TMCCTransport)
+TMCCSocketTransport = tmcc_ns.class_("TMCCSocketTransport", TMCCTransport)
 TMCCEngine = tmcc_ns.class_("TMCCEngine", cg.Component)
 TMCCEngineSpeed = tmcc_ns.class_("TMCCEngineSpeed", number.Number, cg.Component)
 TMCCEngineDirection = tmcc_ns.class_("TMCCEngineDirection", switch.Switch, cg.Component)
-TMCCEngineHorn = tmcc_ns.class_("TMCCEngineHorn", button.Button, cg.Component)
-TMCCEngineBell = tmcc_ns.class_("TMCCEngineBell", button.Button, cg.Component)
-TMCCEngineFrontCoupler = tmcc_ns.class_("TMCCEngineFrontCoupler", button.Button, cg.Component)
-TMCCEngineRearCoupler = tmcc_ns.class_("TMCCEngineRearCoupler", button.Button, cg.Component)
-TMCCEngineBoost = tmcc_ns.class_("TMCCEngineBoost", button.Button, cg.Component)
-TMCCEngineBrake = tmcc_ns.class_("TMCCEngineBrake", button.Button, cg.Component)
-TMCCEngineStop = tmcc_ns.class_("TMCCEngineStop", button.Button, cg.Component)
+TMCCEngineActionButton = tmcc_ns.class_("TMCCEngineActionButton", button.Button)
+TMCCEngineStop = tmcc_ns.class_("TMCCEngineStop", button.Button)
 TMCCTestButton = tmcc_ns.class_("TMCCTestButton", button.Button, cg.Component)
+TMCCTraceButton = tmcc_ns.class_("TMCCTraceButton", button.Button, cg.Component)
 
+TMCCHornPattern = tmcc_ns.class_("TMCCHornPattern")
+TMCCHornPatternButton = tmcc_ns.class_("TMCCHornPatternButton", button.Button)
+TMCCHornPatternAction = tmcc_ns.class_("TMCCHornPatternAction", automation.Action)
+TMCCStartHornAction = tmcc_ns.class_("TMCCStartHornAction", automation.Action)
+TMCCStopHornAction = tmcc_ns.class_("TMCCStopHornAction", automation.Action)
+TMCCTrain = tmcc_ns.class_("TMCCTrain", TMCCEngine)
+TMCCTrainAssign = tmcc_ns.class_("TMCCTrainAssign", button.Button, cg.Component)
+TMCCSequence = tmcc_ns.class_("TMCCSequence", button.Button, cg.Component)
+TMCCSwitch = tmcc_ns.class_("TMCCSwitch", switch.Switch, cg.Component)
+TMCCAccessory = tmcc_ns.class_("TMCCAccessory", switch.Switch, cg.Component)
+TMCCRoute = tmcc_ns.class_("TMCCRoute", button.Button, cg.Component)
+TMCCBridge = tmcc_ns.class_("TMCCBridge", cg.Component)
+TMCCRefresh = tmcc_ns.class_("TMCCRefresh", cg.Component)
+TMCCEStop = tmcc_ns.class_("TMCCEStop", cg.Component)
+TMCCRecorder = tmcc_ns.class_("TMCCRecorder", cg.Component)
+TMCCRecordSwitch = tmcc_ns.class_("TMCCRecordSwitch", switch.Switch)
+TMCCReplaySwitch = tmcc_ns.class_("TMCCReplaySwitch", switch.Switch)
+TMCCRecordingDumpButton = tmcc_ns.class_("TMCCRecordingDumpButton", button.Button)
+TMCCCab = tmcc_ns.class_("TMCCCab", TMCCEngine)
+TMCCCabEntry = tmcc_ns.struct("TMCCCabEntry")
+TMCCCabSelect = tmcc_ns.class_("TMCCCabSelect", select.Select)
 
-# Engine configuration schema
-ENGINE_SCHEMA = cv.Schema(
+TMCCDropPolicy = tmcc_ns.enum("TMCCDropPolicy", is_class=True)
+DROP_POLICIES = {
+    "drop_newest": TMCCDropPolicy.DROP_NEWEST,
+    "drop_oldest": TMCCDropPolicy.DROP_OLDEST,
+}
+
+TMCCProtocol = tmcc_ns.enum("TMCCProtocol", is_class=True)
+PROTOCOLS = {
+    "tmcc1": TMCCProtocol.TMCC1,
+    "legacy": TMCCProtocol.LEGACY,
+}
+
+TMCCEngineAction = tmcc_ns.enum("TMCCEngineAction", is_class=True)
+ENGINE_ACTIONS = {
+    "forward": TMCCEngineAction.FORWARD,
+    "toggle_direction": TMCCEngineAction.TOGGLE_DIRECTION,
+    "reverse": TMCCEngineAction.REVERSE,
+    "boost": TMCCEngineAction.BOOST,
+    "front_coupler": TMCCEngineAction.FRONT_COUPLER,
+    "rear_coupler": TMCCEngineAction.REAR_COUPLER,
+    "brake": TMCCEngineAction.BRAKE,
+    "aux1_off": TMCCEngineAction.AUX1_OFF,
+    "aux1_option1": TMCCEngineAction.AUX1_OPTION1,
+    "aux1_option2": TMCCEngineAction.AUX1_OPTION2,
+    "aux1_on": TMCCEngineAction.AUX1_ON,
+    "aux2_off": TMCCEngineAction.AUX2_OFF,
+    "aux2_option1": TMCCEngineAction.AUX2_OPTION1,
+    "aux2_option2": TMCCEngineAction.AUX2_OPTION2,
+    "aux2_on": TMCCEngineAction.AUX2_ON,
+    "horn": TMCCEngineAction.BLOW_HORN1,
+    "bell": TMCCEngineAction.RING_BELL,
+    "let_off_sound": TMCCEngineAction.LET_OFF_SOUND,
+    "horn2": TMCCEngineAction.BLOW_HORN2,
+}
+
+# Engine buttons, each a TMCCEngineActionButton for its action
+ACTION_BUTTONS = {
+    CONF_HORN: TMCCEngineAction.BLOW_HORN1,
+    CONF_BELL: TMCCEngineAction.RING_BELL,
+    CONF_FRONT_COUPLER: TMCCEngineAction.FRONT_COUPLER,
+    CONF_REAR_COUPLER: TMCCEngineAction.REAR_COUPLER,
+    CONF_BOOST: TMCCEngineAction.BOOST,
+    CONF_BRAKE: TMCCEngineAction.BRAKE,
+    CONF_AUX1_ON: TMCCEngineAction.AUX1_ON,
+    CONF_AUX1_OFF: TMCCEngineAction.AUX1_OFF,
+    CONF_AUX1_OPTION1: TMCCEngineAction.AUX1_OPTION1,
+    CONF_AUX1_OPTION2: TMCCEngineAction.AUX1_OPTION2,
+    CONF_AUX2_ON: TMCCEngineAction.AUX2_ON,
+    CONF_AUX2_OFF: TMCCEngineAction.AUX2_OFF,
+    CONF_AUX2_OPTION1: TMCCEngineAction.AUX2_OPTION1,
+    CONF_AUX2_OPTION2: TMCCEngineAction.AUX2_OPTION2,
+    CONF_LET_OFF: TMCCEngineAction.LET_OFF_SOUND,
+}
+
+HORN_SOUNDS = {
+    "horn1": TMCCEngineAction.BLOW_HORN1,
+    "horn2": TMCCEngineAction.BLOW_HORN2,
+}
+
+# Horn pattern segments are stored in units of TMCC_HORN_PATTERN_UNIT_MS
+HORN_PATTERN_UNIT_MS = 20
+HORN_SEGMENT_MAX = cv.TimePeriod(milliseconds=255 * HORN_PATTERN_UNIT_MS)
+
+TMCC1_MAX_SPEED = 31
+LEGACY_MAX_SPEED = 199
+TMCC1_MAX_TRAIN = 15
+# The assign command carries the train in 3 bits (TMCC1_MAX_ASSIGN_TRAIN)
+TMCC1_MAX_ASSIGN_TRAIN = 7
+
+
+def _validate_engine_max_speed(config):
+    if config[CONF_PROTOCOL] == "tmcc1" and config[CONF_MAX_SPEED] > TMCC1_MAX_SPEED:
+        raise cv.Invalid(
+            f"max_speed must be at most {TMCC1_MAX_SPEED} for TMCC1 engines "
+            f"(use protocol: legacy for up to {LEGACY_MAX_SPEED} speed steps)",
+            [CONF_MAX_SPEED],
+        )
+    return config
+
+
+# Options of one engine on the wire, shared by engines, trains and cab rosters
+ENGINE_PROTOCOL_SCHEMA = cv.Schema(
     {
-        cv.GenerateID(): cv.declare_id(TMCCEngine),
-        cv.Optional(CONF_ADDRESS, default=1): cv.int_range(min=0, max=127),
-        cv.Optional(CONF_MAX_SPEED, default=18): cv.int_range(min=1, max=31),
+        # Legacy (0xF8/0xF9) frames require an LCS SER2/WiFi module at the command base
+        cv.Optional(CONF_PROTOCOL, default="tmcc1"): cv.enum(PROTOCOLS, lower=True),
+        cv.Optional(CONF_MAX_SPEED, default=18): cv.int_range(
+            min=1, max=LEGACY_MAX_SPEED
+        ),
+    }
+)
+
+# Entities shared by engines, trains and the cab
+ENGINE_ENTITIES_SCHEMA = cv.Schema(
+    {
+        # Momentum in speed steps per second; 0 sends the new speed at once
+        cv.Optional(CONF_ACCELERATION, default=0): cv.int_range(min=0, max=1000),
+        cv.Optional(CONF_DECELERATION, default=0): cv.int_range(min=0, max=1000),
         cv.Optional(CONF_SPEED): cv.maybe_simple_value(
             number.number_schema(TMCCEngineSpeed),
             key=CONF_NAME,
@@ -59,48 +261,476 @@ ENGINE_SCHEMA = cv.Schema(
             key=CONF_NAME,
         ),
         cv.Optional(CONF_HORN): cv.maybe_simple_value(
-            button.button_schema(TMCCEngineHorn),
-            key=CONF_NAME,
-        ),
-        cv.Optional(CONF_BELL): cv.maybe_simple_value(
-            button.button_schema(TMCCEngineBell),
+            button.button_schema(TMCCEngineActionButton).extend(
+                {
+                    cv.Optional(CONF_DURATION, default="100ms"): cv.All(
+                        cv.positive_time_period_milliseconds,
+                        cv.Range(max=cv.TimePeriod(seconds=10)),
+                    ),
+                }
+            ),
             key=CONF_NAME,
         ),
-        cv.Optional(CONF_FRONT_COUPLER): cv.maybe_simple_value(
-            button.button_schema(TMCCEngineFrontCoupler),
+        **{
+            cv.Optional(key): cv.maybe_simple_value(
+                button.button_schema(TMCCEngineActionButton),
+                key=CONF_NAME,
+            )
+            for key in ACTION_BUTTONS
+            if key != CONF_HORN
+        },
+        cv.Optional(CONF_STOP): cv.maybe_simple_value(
+            button.button_schema(TMCCEngineStop),
             key=CONF_NAME,
         ),
-        cv.Optional(CONF_REAR_COUPLER): cv.maybe_simple_value(
-            button.button_schema(TMCCEngineRearCoupler),
-            key=CONF_NAME,
+        # Buttons that play a horn pattern on this engine
+        cv.Optional(CONF_HORN_SIGNALS): cv.ensure_list(
+            button.button_schema(TMCCHornPatternButton).extend(
+                {
+                    cv.Required(CONF_PATTERN_ID): cv.use_id(TMCCHornPattern),
+                }
+            )
         ),
-        cv.Optional(CONF_BOOST): cv.maybe_simple_value(
-            button.button_schema(TMCCEngineBoost),
-            key=CONF_NAME,
+    }
+)
+
+# Options shared by engines and trains
+ENGINE_BASE_SCHEMA = ENGINE_PROTOCOL_SCHEMA.extend(ENGINE_ENTITIES_SCHEMA)
+
+# Engine configuration schema
+ENGINE_SCHEMA = cv.All(
+    ENGINE_BASE_SCHEMA.extend(
+        {
+            cv.GenerateID(): cv.declare_id(TMCCEngine),
+            cv.Optional(CONF_ADDRESS, default=1): cv.int_range(min=0, max=127),
+        }
+    ),
+    _validate_engine_max_speed,
+)
+
+
+def _validate_train(config):
+    if config[CONF_PROTOCOL] == "tmcc1" and config[CONF_ADDRESS] > TMCC1_MAX_TRAIN:
+        raise cv.Invalid(
+            f"TMCC1 train addresses go up to {TMCC1_MAX_TRAIN}", [CONF_ADDRESS]
+        )
+    if config[CONF_UNITS] and config[CONF_ADDRESS] > TMCC1_MAX_ASSIGN_TRAIN:
+        # Trains 8-11 would encode as the momentum and set-address commands
+        raise cv.Invalid(
+            f"units can only be assigned to trains 1-{TMCC1_MAX_ASSIGN_TRAIN}; "
+            "build higher trains on the command base",
+            [CONF_UNITS],
+        )
+    return config
+
+
+# Train (lash-up) configuration schema: engine options plus its units
+TRAIN_SCHEMA = cv.All(
+    ENGINE_BASE_SCHEMA.extend(
+        {
+            cv.GenerateID(): cv.declare_id(TMCCTrain),
+            cv.Required(CONF_ADDRESS): cv.int_range(min=1, max=99),
+            cv.Optional(CONF_UNITS, default=[]): cv.ensure_list(
+                cv.Schema(
+                    {
+                        cv.Required(CONF_ENGINE_ID): cv.use_id(TMCCEngine),
+                        cv.Optional(CONF_REVERSED, default=False): cv.boolean,
+                    }
+                )
+            ),
+            cv.Optional(CONF_ASSIGN_ON_BOOT, default=False): cv.boolean,
+            cv.Optional(CONF_ASSIGN): cv.maybe_simple_value(
+                button.button_schema(TMCCTrainAssign),
+                key=CONF_NAME,
+            ),
+        }
+    ),
+    _validate_engine_max_speed,
+    _validate_train,
+)
+
+
+def _validate_horn_signal(value):
+    value = cv.string_strict(value).upper().replace(" ", "")
+    if not value or set(value) - {"L", "S"}:
+        raise cv.Invalid(
+            "signal must be a sequence of L (long) and S (short) blasts, e.g. 'L L S L'"
+        )
+    if len(value) > 64:
+        raise cv.Invalid("signal can have at most 64 blasts")
+    return value
+
+
+_HORN_SEGMENT = cv.All(
+    cv.positive_time_period_milliseconds,
+    cv.Range(min=cv.TimePeriod(milliseconds=HORN_PATTERN_UNIT_MS), max=HORN_SEGMENT_MAX),
+)
+
+# Horn pattern schema: a signal of long and short blasts, compiled into a
+# flash table of on/off segments
+HORN_PATTERN_SCHEMA = cv.Schema(
+    {
+        cv.Required(CONF_ID): cv.declare_id(TMCCHornPattern),
+        cv.GenerateID(CONF_SEGMENTS_ID): cv.declare_id(cg.uint8),
+        cv.Required(CONF_SIGNAL): _validate_horn_signal,
+        cv.Optional(CONF_HORN, default="horn1"): cv.enum(HORN_SOUNDS, lower=True),
+        cv.Optional(CONF_LONG, default="1s"): _HORN_SEGMENT,
+        cv.Optional(CONF_SHORT, default="300ms"): _HORN_SEGMENT,
+        cv.Optional(CONF_GAP, default="300ms"): _HORN_SEGMENT,
+    }
+)
+
+
+# Switch (turnout) schema: ON = thrown out, OFF = through
+SWITCH_SCHEMA = switch.switch_schema(TMCCSwitch).extend(
+    {
+        cv.Required(CONF_ADDRESS): cv.int_range(min=0, max=127),
+    }
+)
+
+# Accessory schema: ON = AUX1 on, OFF = AUX1 off
+ACCESSORY_SCHEMA = switch.switch_schema(TMCCAccessory).extend(
+    {
+        cv.Required(CONF_ADDRESS): cv.int_range(min=0, max=127),
+    }
+)
+
+ROUTE_POSITIONS = {
+    "through": False,
+    "out": True,
+}
+
+
+def _validate_route(config):
+    if CONF_ADDRESS not in config and not config[CONF_SWITCHES]:
+        raise cv.Invalid("A route needs an address, a list of switches, or both")
+    return config
+
+
+# Route schema: a route stored in the command base and/or a paced batch of switch throws
+ROUTE_SCHEMA = cv.All(
+    button.button_schema(TMCCRoute).extend(
+        {
+            cv.Optional(CONF_ADDRESS): cv.int_range(min=0, max=31),
+            cv.Optional(CONF_SWITCHES, default=[]): cv.ensure_list(
+                cv.Schema(
+                    {
+                        cv.Required(CONF_SWITCH_ID): cv.use_id(TMCCSwitch),
+                        cv.Optional(CONF_POSITION, default="out"): cv.enum(
+                            ROUTE_POSITIONS, lower=True
+                        ),
+                    }
+                )
+            ),
+            cv.Optional(
+                CONF_PACE, default="200ms"
+            ): cv.positive_time_period_milliseconds,
+        }
+    ),
+    _validate_route,
+)
+
+
+def _validate_sequence_step(config):
+    commands = [key for key in (CONF_ACTION, CONF_SPEED) if key in config]
+    if len(commands) > 1:
+        raise cv.Invalid("A step can have an action or a speed, not both")
+    if commands and CONF_ENGINE_ID not in config:
+        raise cv.Invalid(f"engine_id is required for {commands[0]}", [commands[0]])
+    if not commands and CONF_ENGINE_ID in config:
+        raise cv.Invalid("A step with engine_id needs an action or a speed")
+    return config
+
+
+# Sequence schema: a button that runs scripted steps. A step sends an engine
+# or train action, sets a speed (through momentum), or just waits.
+SEQUENCE_SCHEMA = button.button_schema(TMCCSequence).extend(
+    {
+        cv.Required(CONF_STEPS): cv.ensure_list(
+            cv.All(
+                cv.Schema(
+                    {
+                        cv.Optional(CONF_ENGINE_ID): cv.use_id(TMCCEngine),
+                        cv.Optional(CONF_ACTION): cv.enum(ENGINE_ACTIONS, lower=True),
+                        cv.Optional(CONF_SPEED): cv.int_range(
+                            min=0, max=LEGACY_MAX_SPEED
+                        ),
+                        cv.Optional(CONF_REPEAT, default=1): cv.int_range(
+                            min=1, max=30
+                        ),
+                        cv.Optional(
+                            CONF_DELAY, default="0ms"
+                        ): cv.positive_time_period_milliseconds,
+                    }
+                ),
+                _validate_sequence_step,
+            )
         ),
-        cv.Optional(CONF_BRAKE): cv.maybe_simple_value(
-            button.button_schema(TMCCEngineBrake),
-            key=CONF_NAME,
+    }
+)
+
+
+def _unique_addresses(label):
+    def validator(configs):
+        seen = set()
+        for item_config in configs:
+            address = item_config[CONF_ADDRESS]
+            if address in seen:
+                raise cv.Invalid(f"{label} address {address} is configured more than once")
+            seen.add(address)
+        return configs
+
+    return validator
+
+
+def _unique_engine_addresses(config):
+    engines = list(config.get(CONF_ENGINES, []))
+    if CONF_ENGINE in config:
+        engines.append(config[CONF_ENGINE])
+    seen = set()
+    for engine_config in engines:
+        address = engine_config[CONF_ADDRESS]
+        if address in seen:
+            raise cv.Invalid(f"Engine address {address} is configured more than once")
+        seen.add(address)
+    return config
+
+
+# Cab roster entry: an engine the cab can drive, stored in flash
+CAB_ROSTER_SCHEMA = cv.All(
+    ENGINE_PROTOCOL_SCHEMA.extend(
+        {
+            cv.Required(CONF_NAME): cv.string_strict,
+            cv.Required(CONF_ADDRESS): cv.int_range(min=0, max=127),
+        }
+    ),
+    _validate_engine_max_speed,
+)
+
+
+def _unique_roster_names(roster):
+    seen = set()
+    for entry in roster:
+        if entry[CONF_NAME] in seen:
+            raise cv.Invalid(f"Roster name '{entry[CONF_NAME]}' is used more than once")
+        seen.add(entry[CONF_NAME])
+    return roster
+
+
+# Cab schema: one set of entities and a select picking the engine they drive
+CAB_SCHEMA = ENGINE_ENTITIES_SCHEMA.extend(
+    {
+        cv.GenerateID(): cv.declare_id(TMCCCab),
+        cv.GenerateID(CONF_ROSTER_ID): cv.declare_id(TMCCCabEntry),
+        cv.Required(CONF_ROSTER): cv.All(
+            cv.ensure_list(CAB_ROSTER_SCHEMA),
+            cv.Length(min=1, max=128),
+            _unique_addresses("Roster"),
+            _unique_roster_names,
         ),
-        cv.Optional(CONF_STOP): cv.maybe_simple_value(
-            button.button_schema(TMCCEngineStop),
+        cv.Required(CONF_SELECT): cv.maybe_simple_value(
+            select.select_schema(TMCCCabSelect),
             key=CONF_NAME,
         ),
     }
 )
 
-# Main component configuration schema
-CONFIG_SCHEMA = cv.Schema(
+
+# Transports other than an ESPHome UART (`uart_id`)
+TRANSPORT_SCHEMA = cv.typed_schema(
     {
-        cv.GenerateID(): cv.declare_id(TMCCBus),
-        cv.Required(CONF_UART_ID): cv.use_id(uart.UARTComponent),
-        cv.Optional(CONF_ENGINE): ENGINE_SCHEMA,
-        cv.Optional(CONF_TEST_BUTTON): cv.maybe_simple_value(
-            button.button_schema(TMCCTestButton),
-            key=CONF_NAME,
+        # ESP-IDF UART driver: TX completion from the driver instead of polling
+        "idf_uart": cv.All(
+            cv.Schema(
+                {
+                    cv.GenerateID(): cv.declare_id(TMCCIDFUARTTransport),
+                    cv.Optional(CONF_UART_NUM, default=1): cv.int_range(min=0, max=2),
+                    cv.Required(CONF_TX_PIN): pins.internal_gpio_output_pin_number,
+                    cv.Optional(CONF_RX_PIN): pins.internal_gpio_input_pin_number,
+                    cv.Optional(CONF_BAUD_RATE, default=9600): cv.int_range(min=1),
+                    cv.Optional(CONF_INVERTED, default=False): cv.boolean,
+                }
+            ),
+            cv.only_on_esp32,
         ),
-    }
-).extend(cv.COMPONENT_SCHEMA)
+        # In-memory echo, for running without hardware
+        "loopback": cv.Schema(
+            {
+                cv.GenerateID(): cv.declare_id(TMCCLoopbackTransport),
+            }
+        ),
+        # TCP client to a simulated command base
+        "tcp": cv.Schema(
+            {
+                cv.GenerateID(): cv.declare_id(TMCCSocketTransport),
+                cv.Required(CONF_ADDRESS): cv.ipaddress,
+                cv.Optional(CONF_PORT, default=5001): cv.port,
+            }
+        ),
+    },
+    lower=True,
+)
+
+
+# Main component configuration schema
+CONFIG_SCHEMA = cv.All(
+    cv.Schema(
+        {
+            cv.GenerateID(): cv.declare_id(TMCCBus),
+            cv.Optional(CONF_UART_ID): cv.use_id(uart.UARTComponent),
+            cv.GenerateID(CONF_TRANSPORT_ID): cv.declare_id(TMCCUARTTransport),
+            cv.Optional(CONF_TRANSPORT): TRANSPORT_SCHEMA,
+            cv.Optional(CONF_QUEUE_SIZE, default=16): cv.int_range(min=4, max=256),
+            cv.Optional(CONF_DROP_POLICY, default="drop_oldest"): cv.enum(
+                DROP_POLICIES, lower=True
+            ),
+            cv.Optional(
+                CONF_STREAM_INTERVAL, default="0ms"
+            ): cv.positive_time_period_milliseconds,
+            cv.Optional(CONF_FRAME_GAP, default="0ms"): cv.All(
+                cv.positive_time_period_milliseconds,
+                cv.Range(max=cv.TimePeriod(milliseconds=1000)),
+            ),
+            cv.Optional(CONF_BURST_LIMIT, default=0): cv.int_range(min=0, max=255),
+            cv.Optional(CONF_BURST_PAUSE, default="0ms"): cv.All(
+                cv.positive_time_period_milliseconds,
+                cv.Range(max=cv.TimePeriod(milliseconds=1000)),
+            ),
+            cv.Optional(CONF_ADAPTIVE_PACING, default=False): cv.boolean,
+            cv.Optional(CONF_MAX_FRAME_GAP, default="50ms"): cv.All(
+                cv.positive_time_period_milliseconds,
+                cv.Range(max=cv.TimePeriod(milliseconds=1000)),
+            ),
+            cv.Optional(CONF_HALT_REPETITIONS, default=10): cv.int_range(min=1, max=30),
+            cv.Optional(CONF_SUPPRESS_DUPLICATES, default=True): cv.boolean,
+            cv.Optional(CONF_TRACE_SIZE, default=64): cv.int_range(min=0, max=1024),
+            cv.Optional(CONF_FRAME_LOG, default=False): cv.boolean,
+            cv.Optional(CONF_HORN_PATTERNS): cv.ensure_list(HORN_PATTERN_SCHEMA),
+            cv.Optional(CONF_ENGINE): ENGINE_SCHEMA,
+            cv.Optional(CONF_ENGINES): cv.ensure_list(ENGINE_SCHEMA),
+            cv.Optional(CONF_CAB): CAB_SCHEMA,
+            cv.Optional(CONF_TRAINS): cv.All(
+                cv.ensure_list(TRAIN_SCHEMA), _unique_addresses("Train")
+            ),
+            cv.Optional(CONF_SEQUENCES): cv.ensure_list(SEQUENCE_SCHEMA),
+            cv.Optional(CONF_SWITCHES): cv.All(
+                cv.ensure_list(SWITCH_SCHEMA), _unique_addresses("Switch")
+            ),
+            cv.Optional(CONF_ACCESSORIES): cv.All(
+                cv.ensure_list(ACCESSORY_SCHEMA), _unique_addresses("Accessory")
+            ),
+            cv.Optional(CONF_ROUTES): cv.ensure_list(ROUTE_SCHEMA),
+            cv.Optional(CONF_BRIDGE): cv.Schema(
+                {
+                    cv.GenerateID(): cv.declare_id(TMCCBridge),
+                    cv.Optional(CONF_PORT, default=5000): cv.port,
+                }
+            ).extend(cv.COMPONENT_SCHEMA),
+            # Background re-assertion of engine speed and direction
+            cv.Optional(CONF_REFRESH): cv.Schema(
+                {
+                    cv.GenerateID(): cv.declare_id(TMCCRefresh),
+                    cv.Optional(CONF_BUDGET, default="2%"): cv.All(
+                        cv.percentage, cv.Range(min=0.001, max=0.5)
+                    ),
+                }
+            ).extend(cv.COMPONENT_SCHEMA),
+            # Hardware emergency stop: halts from an interrupt, not the main loop
+            cv.Optional(CONF_ESTOP): cv.Schema(
+                {
+                    cv.GenerateID(): cv.declare_id(TMCCEStop),
+                    cv.Required(CONF_PIN): pins.internal_gpio_input_pin_schema,
+                    cv.Optional(
+                        CONF_DEBOUNCE, default="50ms"
+                    ): cv.positive_time_period_milliseconds,
+                    cv.Optional(CONF_LATENCY): sensor.sensor_schema(
+                        unit_of_measurement=UNIT_MILLISECOND,
+                        accuracy_decimals=2,
+                        state_class=STATE_CLASS_MEASUREMENT,
+                        entity_category=ENTITY_CATEGORY_DIAGNOSTIC,
+                    ),
+                }
+            ).extend(cv.COMPONENT_SCHEMA),
+            # Session recorder with timed replay
+            cv.Optional(CONF_RECORDER): cv.Schema(
+                {
+                    cv.GenerateID(): cv.declare_id(TMCCRecorder),
+                    cv.Optional(CONF_SIZE, default=4096): cv.int_range(
+                        min=64, max=65536
+                    ),
+                    cv.Optional(CONF_RECORD_SWITCH): cv.maybe_simple_value(
+                        switch.switch_schema(TMCCRecordSwitch),
+                        key=CONF_NAME,
+                    ),
+                    cv.Optional(CONF_REPLAY_SWITCH): cv.maybe_simple_value(
+                        switch.switch_schema(TMCCReplaySwitch),
+                        key=CONF_NAME,
+                    ),
+                    cv.Optional(CONF_DUMP_BUTTON): cv.maybe_simple_value(
+                        button.button_schema(
+                            TMCCRecordingDumpButton,
+                            entity_category=ENTITY_CATEGORY_DIAGNOSTIC,
+                        ),
+                        key=CONF_NAME,
+                    ),
+                }
+            ).extend(cv.COMPONENT_SCHEMA),
+            cv.Optional(CONF_TEST_BUTTON): cv.maybe_simple_value(
+                button.button_schema(TMCCTestButton),
+                key=CONF_NAME,
+            ),
+            cv.Optional(CONF_TRACE_BUTTON): cv.maybe_simple_value(
+                button.button_schema(
+                    TMCCTraceButton, entity_category=ENTITY_CATEGORY_DIAGNOSTIC
+                ),
+                key=CONF_NAME,
+            ),
+            # Performance sensors, published every update_interval
+            cv.Optional(CONF_FRAMES_SENT): sensor.sensor_schema(
+                accuracy_decimals=0,
+                state_class=STATE_CLASS_TOTAL_INCREASING,
+                entity_category=ENTITY_CATEGORY_DIAGNOSTIC,
+            ),
+            cv.Optional(CONF_BYTES_SENT): sensor.sensor_schema(
+                unit_of_measurement="B",
+                accuracy_decimals=0,
+                state_class=STATE_CLASS_TOTAL_INCREASING,
+                entity_category=ENTITY_CATEGORY_DIAGNOSTIC,
+            ),
+            cv.Optional(CONF_BUSY_TIME): sensor.sensor_schema(
+                unit_of_measurement=UNIT_MILLISECOND,
+                accuracy_decimals=0,
+                state_class=STATE_CLASS_MEASUREMENT,
+                entity_category=ENTITY_CATEGORY_DIAGNOSTIC,
+            ),
+            cv.Optional(CONF_BUS_UTILIZATION): sensor.sensor_schema(
+                unit_of_measurement=UNIT_PERCENT,
+                accuracy_decimals=1,
+                state_class=STATE_CLASS_MEASUREMENT,
+                entity_category=ENTITY_CATEGORY_DIAGNOSTIC,
+            ),
+            cv.Optional(CONF_QUEUE_HIGH_WATER): sensor.sensor_schema(
+                accuracy_decimals=0,
+                state_class=STATE_CLASS_MEASUREMENT,
+                entity_category=ENTITY_CATEGORY_DIAGNOSTIC,
+            ),
+            cv.Optional(CONF_LATENCY_P50): sensor.sensor_schema(
+                unit_of_measurement=UNIT_MILLISECOND,
+                accuracy_decimals=1,
+                state_class=STATE_CLASS_MEASUREMENT,
+                entity_category=ENTITY_CATEGORY_DIAGNOSTIC,
+            ),
+            cv.Optional(CONF_LATENCY_P99): sensor.sensor_schema(
+                unit_of_measurement=UNIT_MILLISECOND,
+                accuracy_decimals=1,
+                state_class=STATE_CLASS_MEASUREMENT,
+                entity_category=ENTITY_CATEGORY_DIAGNOSTIC,
+            ),
+        }
+    ).extend(cv.polling_component_schema("60s")),
+    cv.has_exactly_one_key(CONF_UART_ID, CONF_TRANSPORT),
+    _unique_engine_addresses,
+)
 
 
 async def to_code(config):
@@ -108,9 +738,42 @@ async def to_code(config):
     bus = cg.new_Pvariable(config[CONF_ID])
     await cg.register_component(bus, config)
 
-    # Get UART and attach to bus
-    uart_component = await cg.get_variable(config[CONF_UART_ID])
-    cg.add(bus.set_uart(uart_component))
+    # Attach the transport frames go through
+    cg.add(bus.set_transport(await _transport_to_code(config)))
+
+    # Configure TX queue
+    cg.add(bus.set_queue_size(config[CONF_QUEUE_SIZE]))
+    cg.add(bus.set_drop_policy(config[CONF_DROP_POLICY]))
+    cg.add(bus.set_stream_interval(config[CONF_STREAM_INTERVAL]))
+
+    # Pacing towards the command base
+    cg.add(bus.set_frame_gap(config[CONF_FRAME_GAP]))
+    cg.add(bus.set_burst_limit(config[CONF_BURST_LIMIT]))
+    cg.add(bus.set_burst_pause(config[CONF_BURST_PAUSE]))
+    cg.add(
+        bus.set_adaptive_pacing(config[CONF_ADAPTIVE_PACING], config[CONF_MAX_FRAME_GAP])
+    )
+    cg.add(bus.set_halt_repetitions(config[CONF_HALT_REPETITIONS]))
+    cg.add(bus.set_suppress_duplicates(config[CONF_SUPPRESS_DUPLICATES]))
+
+    # Binary trace ring; per-frame text logs are compiled in only on request
+    cg.add(bus.set_trace_size(config[CONF_TRACE_SIZE]))
+    if config[CONF_FRAME_LOG]:
+        cg.add_define("USE_TMCC_FRAME_LOG")
+
+    # Create performance sensors if configured
+    for key, setter in (
+        (CONF_FRAMES_SENT, bus.set_frames_sent_sensor),
+        (CONF_BYTES_SENT, bus.set_bytes_sent_sensor),
+        (CONF_BUSY_TIME, bus.set_busy_time_sensor),
+        (CONF_BUS_UTILIZATION, bus.set_utilization_sensor),
+        (CONF_QUEUE_HIGH_WATER, bus.set_queue_high_water_sensor),
+        (CONF_LATENCY_P50, bus.set_latency_p50_sensor),
+        (CONF_LATENCY_P99, bus.set_latency_p99_sensor),
+    ):
+        if key in config:
+            sens = await sensor.new_sensor(config[key])
+            cg.add(setter(sens))
 
     # Create test button if configured
     if CONF_TEST_BUTTON in config:
@@ -119,84 +782,308 @@ async def to_code(config):
         await cg.register_component(test_button_entity, test_button_config)
         cg.add(test_button_entity.set_bus(bus))
 
-    # Handle engine configuration
+    # Create trace button if configured
+    if CONF_TRACE_BUTTON in config:
+        trace_button_config = config[CONF_TRACE_BUTTON]
+        trace_button_entity = await button.new_button(trace_button_config)
+        await cg.register_component(trace_button_entity, trace_button_config)
+        cg.add(trace_button_entity.set_bus(bus))
+
+    # Horn patterns come first so engine buttons can reference them
+    for pattern_config in config.get(CONF_HORN_PATTERNS, []):
+        await _horn_pattern_to_code(pattern_config)
+
+    # Handle engine configuration. `engine:` is kept for single-engine
+    # configs; `engines:` adds any number more, all sharing this bus.
+    engine_configs = list(config.get(CONF_ENGINES, []))
     if CONF_ENGINE in config:
-        engine_config = config[CONF_ENGINE]
-
-        # Create and register the TMCCEngine instance
-        engine = cg.new_Pvariable(engine_config[CONF_ID])
-        await cg.register_component(engine, engine_config)
-
-        # Configure engine
-        cg.add(engine.set_bus(bus))
-        cg.add(engine.set_address(engine_config[CONF_ADDRESS]))
-        cg.add(engine.set_max_speed(engine_config[CONF_MAX_SPEED]))
-
-        # Create speed number entity
-        if CONF_SPEED in engine_config:
-            speed_config = engine_config[CONF_SPEED]
-            speed_entity = await number.new_number(
-                speed_config,
-                min_value=0,
-                max_value=engine_config[CONF_MAX_SPEED],
-                step=1,
+        engine_configs.insert(0, config[CONF_ENGINE])
+    engines = []
+    for engine_config in engine_configs:
+        engines.append(await _engine_to_code(bus, engine_config))
+
+    # Cab: one entity set for a roster kept in flash
+    if CONF_CAB in config:
+        await _cab_to_code(bus, config[CONF_CAB])
+
+    # Trains come after engines so their units can be referenced
+    for train_config in config.get(CONF_TRAINS, []):
+        train = await _engine_to_code(bus, train_config)
+        for unit_config in train_config[CONF_UNITS]:
+            unit = await cg.get_variable(unit_config[CONF_ENGINE_ID])
+            cg.add(train.add_unit(unit, unit_config[CONF_REVERSED]))
+        cg.add(train.set_assign_on_boot(train_config[CONF_ASSIGN_ON_BOOT]))
+        if CONF_ASSIGN in train_config:
+            assign_config = train_config[CONF_ASSIGN]
+            assign_entity = await button.new_button(assign_config)
+            await cg.register_component(assign_entity, assign_config)
+            cg.add(assign_entity.set_train(train))
+
+    # Sequences; action steps send from the engine's frame table when they run
+    for sequence_config in config.get(CONF_SEQUENCES, []):
+        sequence = await button.new_button(sequence_config)
+        await cg.register_component(sequence, sequence_config)
+        cg.add(sequence.set_bus(bus))
+        for step_config in sequence_config[CONF_STEPS]:
+            delay = step_config[CONF_DELAY]
+            if CONF_ACTION in step_config:
+                engine = await cg.get_variable(step_config[CONF_ENGINE_ID])
+                cg.add(
+                    sequence.add_action_step(
+                        engine, step_config[CONF_ACTION], step_config[CONF_REPEAT], delay
+                    )
+                )
+            elif CONF_SPEED in step_config:
+                engine = await cg.get_variable(step_config[CONF_ENGINE_ID])
+                cg.add(sequence.add_speed_step(engine, step_config[CONF_SPEED], delay))
+            else:
+                cg.add(sequence.add_delay_step(delay))
+
+    # Raw TCP bridge for PC software
+    if CONF_BRIDGE in config:
+        bridge_config = config[CONF_BRIDGE]
+        cg.add_define("USE_TMCC_BRIDGE")
+        bridge = cg.new_Pvariable(bridge_config[CONF_ID])
+        await cg.register_component(bridge, bridge_config)
+        cg.add(bridge.set_bus(bus))
+        cg.add(bridge.set_port(bridge_config[CONF_PORT]))
+
+    # Round-robin refresh of every engine's speed and direction
+    if CONF_REFRESH in config:
+        refresh_config = config[CONF_REFRESH]
+        refresh = cg.new_Pvariable(refresh_config[CONF_ID])
+        await cg.register_component(refresh, refresh_config)
+        cg.add(refresh.set_bus(bus))
+        cg.add(refresh.set_budget(refresh_config[CONF_BUDGET]))
+        for engine in engines:
+            cg.add(refresh.add_engine(engine))
+
+    # GPIO emergency stop
+    if CONF_ESTOP in config:
+        estop_config = config[CONF_ESTOP]
+        estop = cg.new_Pvariable(estop_config[CONF_ID])
+        await cg.register_component(estop, estop_config)
+        cg.add(estop.set_bus(bus))
+        pin = await cg.gpio_pin_expression(estop_config[CONF_PIN])
+        cg.add(estop.set_pin(pin))
+        cg.add(estop.set_debounce(estop_config[CONF_DEBOUNCE]))
+        if CONF_LATENCY in estop_config:
+            sens = await sensor.new_sensor(estop_config[CONF_LATENCY])
+            cg.add(estop.set_latency_sensor(sens))
+
+    # Session recorder and replay
+    if CONF_RECORDER in config:
+        recorder_config = config[CONF_RECORDER]
+        recorder = cg.new_Pvariable(recorder_config[CONF_ID])
+        await cg.register_component(recorder, recorder_config)
+        cg.add(recorder.set_bus(bus))
+        cg.add(recorder.set_size(recorder_config[CONF_SIZE]))
+        if CONF_RECORD_SWITCH in recorder_config:
+            record_switch = await switch.new_switch(
+                recorder_config[CONF_RECORD_SWITCH]
+            )
+            cg.add(record_switch.set_recorder(recorder))
+            cg.add(recorder.set_record_switch(record_switch))
+        if CONF_REPLAY_SWITCH in recorder_config:
+            replay_switch = await switch.new_switch(
+                recorder_config[CONF_REPLAY_SWITCH]
             )
-            await cg.register_component(speed_entity, speed_config)
-            cg.add(speed_entity.set_engine(engine))
-
-        # Create direction switch entity
-        if CONF_DIRECTION in engine_config:
-            direction_config = engine_config[CONF_DIRECTION]
-            direction_entity = await switch.new_switch(direction_config)
-            await cg.register_component(direction_entity, direction_config)
-            cg.add(direction_entity.set_engine(engine))
-
-        # Create horn button entity
-        if CONF_HORN in engine_config:
-            horn_config = engine_config[CONF_HORN]
-            horn_entity = await button.new_button(horn_config)
-            await cg.register_component(horn_entity, horn_config)
-            cg.add(horn_entity.set_engine(engine))
-
-        # Create bell button entity
-        if CONF_BELL in engine_config:
-            bell_config = engine_config[CONF_BELL]
-            bell_entity = await button.new_button(bell_config)
-            await cg.register_component(bell_entity, bell_config)
-            cg.add(bell_entity.set_engine(engine))
-
-        # Create front coupler button entity
-        if CONF_FRONT_COUPLER in engine_config:
-            front_coupler_config = engine_config[CONF_FRONT_COUPLER]
-            front_coupler_entity = await button.new_button(front_coupler_config)
-            await cg.register_component(front_coupler_entity, front_coupler_config)
-            cg.add(front_coupler_entity.set_engine(engine))
-
-        # Create rear coupler button entity
-        if CONF_REAR_COUPLER in engine_config:
-            rear_coupler_config = engine_config[CONF_REAR_COUPLER]
-            rear_coupler_entity = await button.new_button(rear_coupler_config)
-            await cg.register_component(rear_coupler_entity, rear_coupler_config)
-            cg.add(rear_coupler_entity.set_engine(engine))
-
-        # Create boost button entity
-        if CONF_BOOST in engine_config:
-            boost_config = engine_config[CONF_BOOST]
-            boost_entity = await button.new_button(boost_config)
-            await cg.register_component(boost_entity, boost_config)
-            cg.add(boost_entity.set_engine(engine))
-
-        # Create brake button entity
-        if CONF_BRAKE in engine_config:
-            brake_config = engine_config[CONF_BRAKE]
-            brake_entity = await button.new_button(brake_config)
-            await cg.register_component(brake_entity, brake_config)
-            cg.add(brake_entity.set_engine(engine))
-
-        # Create stop button entity (system halt)
-        if CONF_STOP in engine_config:
-            stop_config = engine_config[CONF_STOP]
-            stop_entity = await button.new_button(stop_config)
-            await cg.register_component(stop_entity, stop_config)
-            cg.add(stop_entity.set_engine(engine))
+            cg.add(replay_switch.set_recorder(recorder))
+            cg.add(recorder.set_replay_switch(replay_switch))
+        if CONF_DUMP_BUTTON in recorder_config:
+            dump_button = await button.new_button(recorder_config[CONF_DUMP_BUTTON])
+            cg.add(dump_button.set_recorder(recorder))
+
+    # Switches, accessories and routes
+    for switch_config in config.get(CONF_SWITCHES, []):
+        switch_entity = await switch.new_switch(switch_config)
+        await cg.register_component(switch_entity, switch_config)
+        cg.add(switch_entity.set_bus(bus))
+        cg.add(switch_entity.set_address(switch_config[CONF_ADDRESS]))
+
+    for accessory_config in config.get(CONF_ACCESSORIES, []):
+        accessory_entity = await switch.new_switch(accessory_config)
+        await cg.register_component(accessory_entity, accessory_config)
+        cg.add(accessory_entity.set_bus(bus))
+        cg.add(accessory_entity.set_address(accessory_config[CONF_ADDRESS]))
+
+    for route_config in config.get(CONF_ROUTES, []):
+        route_entity = await button.new_button(route_config)
+        await cg.register_component(route_entity, route_config)
+        cg.add(route_entity.set_bus(bus))
+        if CONF_ADDRESS in route_config:
+            cg.add(route_entity.set_address(route_config[CONF_ADDRESS]))
+        cg.add(route_entity.set_pace(route_config[CONF_PACE]))
+        for step_config in route_config[CONF_SWITCHES]:
+            turnout = await cg.get_variable(step_config[CONF_SWITCH_ID])
+            cg.add(route_entity.add_step(turnout, step_config[CONF_POSITION]))
+
+
+def _horn_segments_ms(pattern_config):
+    durations = {"L": pattern_config[CONF_LONG], "S": pattern_config[CONF_SHORT]}
+    segments = []
+    for blast in pattern_config[CONF_SIGNAL]:
+        if segments:
+            segments.append(pattern_config[CONF_GAP])
+        segments.append(durations[blast])
+    return segments
+
+
+async def _horn_pattern_to_code(pattern_config):
+    units = [
+        max(1, round(segment.total_milliseconds / HORN_PATTERN_UNIT_MS))
+        for segment in _horn_segments_ms(pattern_config)
+    ]
+    segments = cg.static_const_array(pattern_config[CONF_SEGMENTS_ID], units)
+    return cg.new_Pvariable(
+        pattern_config[CONF_ID], segments, len(units), pattern_config[CONF_HORN]
+    )
+
+
+@automation.register_action(
+    "tmcc.play_horn_pattern",
+    TMCCHornPatternAction,
+    cv.Schema(
+        {
+            cv.Required(CONF_ENGINE_ID): cv.use_id(TMCCEngine),
+            cv.Required(CONF_PATTERN_ID): cv.use_id(TMCCHornPattern),
+        }
+    ),
+)
+async def play_horn_pattern_to_code(config, action_id, template_arg, args):
+    engine = await cg.get_variable(config[CONF_ENGINE_ID])
+    pattern = await cg.get_variable(config[CONF_PATTERN_ID])
+    return cg.new_Pvariable(action_id, template_arg, engine, pattern)
+
+
+HORN_ACTION_SCHEMA = cv.Schema(
+    {
+        cv.Required(CONF_ENGINE_ID): cv.use_id(TMCCEngine),
+    }
+)
+
+
+@automation.register_action("tmcc.start_horn", TMCCStartHornAction, HORN_ACTION_SCHEMA)
+@automation.register_action("tmcc.stop_horn", TMCCStopHornAction, HORN_ACTION_SCHEMA)
+async def horn_hold_to_code(config, action_id, template_arg, args):
+    engine = await cg.get_variable(config[CONF_ENGINE_ID])
+    return cg.new_Pvariable(action_id, template_arg, engine)
+
+
+async def _transport_to_code(config):
+    if CONF_UART_ID in config:
+        cg.add_define("USE_TMCC_UART_TRANSPORT")
+        transport = cg.new_Pvariable(config[CONF_TRANSPORT_ID])
+        uart_component = await cg.get_variable(config[CONF_UART_ID])
+        cg.add(transport.set_uart(uart_component))
+        return transport
+
+    transport_config = config[CONF_TRANSPORT]
+    transport = cg.new_Pvariable(transport_config[CONF_ID])
+    if transport_config[CONF_TYPE] == "idf_uart":
+        cg.add_define("USE_TMCC_IDF_UART_TRANSPORT")
+        cg.add(transport.set_uart_num(transport_config[CONF_UART_NUM]))
+        cg.add(transport.set_tx_pin(transport_config[CONF_TX_PIN]))
+        cg.add(transport.set_rx_pin(transport_config.get(CONF_RX_PIN, -1)))
+        cg.add(transport.set_baud_rate(transport_config[CONF_BAUD_RATE]))
+        cg.add(transport.set_inverted(transport_config[CONF_INVERTED]))
+    elif transport_config[CONF_TYPE] == "tcp":
+        cg.add_define("USE_TMCC_SOCKET_TRANSPORT")
+        cg.add(transport.set_address(str(transport_config[CONF_ADDRESS])))
+        cg.add(transport.set_port(transport_config[CONF_PORT]))
+    return transport
+
+
+async def _cab_to_code(bus, cab_config):
+    cab = cg.new_Pvariable(cab_config[CONF_ID])
+    await cg.register_component(cab, cab_config)
+    cg.add(cab.set_bus(bus))
+
+    roster_config = cab_config[CONF_ROSTER]
+    roster = cg.static_const_array(
+        cab_config[CONF_ROSTER_ID],
+        [
+            cg.ArrayInitializer(
+                entry[CONF_NAME],
+                entry[CONF_ADDRESS],
+                entry[CONF_MAX_SPEED],
+                entry[CONF_PROTOCOL],
+            )
+            for entry in roster_config
+        ],
+    )
+    cg.add(cab.set_roster(roster, len(roster_config)))
+
+    select_entity = await select.new_select(
+        cab_config[CONF_SELECT],
+        options=[entry[CONF_NAME] for entry in roster_config],
+    )
+    cg.add(select_entity.set_cab(cab))
+    cg.add(cab.set_select(select_entity))
+
+    # The speed slider covers the fastest engine; slower ones clamp to their own max
+    max_speed = max(entry[CONF_MAX_SPEED] for entry in roster_config)
+    await _engine_entities_to_code(cab, cab_config, max_speed)
+
+
+async def _engine_to_code(bus, engine_config):
+    # Create and register the TMCCEngine instance
+    engine = cg.new_Pvariable(engine_config[CONF_ID])
+    await cg.register_component(engine, engine_config)
+
+    # Configure engine
+    cg.add(engine.set_bus(bus))
+    cg.add(engine.set_address(engine_config[CONF_ADDRESS]))
+    cg.add(engine.set_protocol(engine_config[CONF_PROTOCOL]))
+    cg.add(engine.set_max_speed(engine_config[CONF_MAX_SPEED]))
+    await _engine_entities_to_code(engine, engine_config, engine_config[CONF_MAX_SPEED])
+    return engine
+
+
+async def _engine_entities_to_code(engine, engine_config, max_speed):
+    cg.add(engine.set_acceleration(engine_config[CONF_ACCELERATION]))
+    cg.add(engine.set_deceleration(engine_config[CONF_DECELERATION]))
+
+    # Create speed number entity
+    if CONF_SPEED in engine_config:
+        speed_config = engine_config[CONF_SPEED]
+        speed_entity = await number.new_number(
+            speed_config,
+            min_value=0,
+            max_value=max_speed,
+            step=1,
+        )
+        await cg.register_component(speed_entity, speed_config)
+        cg.add(speed_entity.set_engine(engine))
+        cg.add(engine.set_speed_number(speed_entity))
+
+    # Create direction switch entity
+    if CONF_DIRECTION in engine_config:
+        direction_config = engine_config[CONF_DIRECTION]
+        direction_entity = await switch.new_switch(direction_config)
+        await cg.register_component(direction_entity, direction_config)
+        cg.add(direction_entity.set_engine(engine))
+        cg.add(engine.set_direction_switch(direction_entity))
+
+    # Create action buttons; the horn sounds for its configured duration
+    if CONF_HORN in engine_config:
+        cg.add(engine.set_horn_duration(engine_config[CONF_HORN][CONF_DURATION]))
+    for key, action in ACTION_BUTTONS.items():
+        if key in engine_config:
+            action_entity = await button.new_button(
+                engine_config[key], cg.TemplateArguments(action)
+            )
+            cg.add(action_entity.set_engine(engine))
+
+    # Create stop button entity (system halt)
+    if CONF_STOP in engine_config:
+        stop_config = engine_config[CONF_STOP]
+        stop_entity = await button.new_button(stop_config)
+        cg.add(stop_entity.set_engine(engine))
 
+    # Create horn signal buttons
+    for signal_config in engine_config.get(CONF_HORN_SIGNALS, []):
+        signal_entity = await button.new_button(signal_config)
+        pattern = await cg.get_variable(signal_config[CONF_PATTERN_ID])
+        cg.add(signal_entity.set_engine(engine))
+        cg.add(signal_entity.set_pattern(pattern))
@@ -1,36 +1,382 @@
 #include "tmcc.h"
+
+#include <algorithm>
+#include <new>
+#include <vector>
+
 #include "esphome/core/log.h"
 #include "esphome/core/helpers.h"
-#include "freertos/FreeRTOS.h"
-#include "freertos/task.h"
+#include "esphome/core/hal.h"
 
 namespace tmcc {
 
 static const char *const TAG = "tmcc";
 
+// Writer task parameters. The task spends nearly all of its time blocked,
+// either waiting for work or inside the transport flush.
+static const uint32_t WRITER_TASK_STACK_SIZE = 4096;
+static const UBaseType_t WRITER_TASK_PRIORITY = 5;
+
+// Receive task parameters. Received frames wait in rx_queue_ until the next
+// loop(). Transports that cannot wait_readable() are polled; that idle
+// wait is about one frame time at 9600 baud.
+static const size_t RX_READ_SIZE = 32;
+static const uint32_t RX_TASK_STACK_SIZE = 3072;
+static const UBaseType_t RX_TASK_PRIORITY = 4;
+static const UBaseType_t RX_QUEUE_LENGTH = 16;
+static const uint32_t RX_IDLE_MS = 3;
+// Longest the receive task sleeps in wait_readable() between reads
+static const uint32_t RX_WAIT_MS = 100;
+
+// Limit to 30 repetitions max - used for horn duration control
+static const uint8_t MAX_REPETITIONS = 30;
+
 void TMCCBus::setup() {
   ESP_LOGCONFIG(TAG, "Setting up TMCC Bus...");
-  if (this->uart_ == nullptr) {
-    ESP_LOGE(TAG, "UART not configured!");
+  if (this->transport_ == nullptr) {
+    ESP_LOGE(TAG, "Transport not configured!");
+    this->mark_failed();
+    return;
+  }
+  if (!this->transport_->begin()) {
+    ESP_LOGE(TAG, "Could not start the %s transport", this->transport_->get_name());
+    this->mark_failed();
+    return;
+  }
+
+  if (!this->tx_queue_.init(this->queue_size_)) {
+    ESP_LOGE(TAG, "Failed to allocate TX queue (%u entries)", this->queue_size_);
+    this->mark_failed();
+    return;
+  }
+
+  this->rate_.configure(this->frame_gap_ms_, this->max_frame_gap_ms_, this->adaptive_pacing_);
+
+  if (this->trace_size_ > 0 && !this->trace_buffer_.init(this->trace_size_)) {
+    // Not fatal: the bus works without its trace
+    ESP_LOGW(TAG, "Failed to allocate trace buffer (%u records)", this->trace_size_);
+  }
+
+  this->queue_lock_ = xSemaphoreCreateMutex();
+  this->write_lock_ = xSemaphoreCreateMutex();
+  if (this->queue_lock_ == nullptr || this->write_lock_ == nullptr) {
+    ESP_LOGE(TAG, "Failed to create TX locks");
+    this->mark_failed();
+    return;
+  }
+
+  if (xTaskCreate(TMCCBus::writer_task_, "tmcc_tx", WRITER_TASK_STACK_SIZE, this, WRITER_TASK_PRIORITY,
+                  &this->writer_task_handle_) != pdPASS) {
+    ESP_LOGE(TAG, "Failed to start TX writer task");
+    this->writer_task_handle_ = nullptr;
+    this->mark_failed();
+    return;
+  }
+
+  this->rx_queue_ = xQueueCreate(RX_QUEUE_LENGTH, sizeof(TMCCFrame));
+  if (this->rx_queue_ == nullptr ||
+      xTaskCreate(TMCCBus::rx_task_, "tmcc_rx", RX_TASK_STACK_SIZE, this, RX_TASK_PRIORITY,
+                  &this->rx_task_handle_) != pdPASS) {
+    // Sending still works; only state feedback from the command base is lost
+    ESP_LOGE(TAG, "Failed to start RX task");
+    this->rx_task_handle_ = nullptr;
+    this->rate_.configure(this->frame_gap_ms_, this->max_frame_gap_ms_, false);
+  }
+
+  this->last_update_us_ = esphome::micros();
+
+#ifdef USE_API
+  this->register_service(&TMCCBus::on_send_words_service_, "tmcc_send_words", {"words"});
+  this->register_service(&TMCCBus::on_send_batch_service_, "tmcc_send_batch",
+                         {"types", "addresses", "classes", "data"});
+  this->register_service(&TMCCBus::dump_trace, "tmcc_dump_trace");
+#endif
+}
+
+void TMCCBus::loop() {
+  if (this->emergency_halt_pending_.exchange(false)) {
+    ESP_LOGW(TAG, "E-STOP - Stopping all trains!");
+    this->halt_callback_.call();
+  }
+
+  if (this->rx_queue_ == nullptr) {
+    return;
+  }
+  TMCCFrame frame;
+  while (xQueueReceive(this->rx_queue_, &frame, 0) == pdTRUE) {
+    this->frames_received_++;
+    TMCC_LOG_FRAME(TAG, "RX: header=0x%02X word=0x%04X", frame.header, frame.word);
+    xSemaphoreTake(this->queue_lock_, portMAX_DELAY);
+    this->record_trace_(TMCCTraceSource::RX, frame.header, frame.word, 1);
+    if (frame.header == TMCC1_HEADER) {
+      // Pacing only tracks TMCC1 frames (see the writer task)
+      this->rate_.on_received(frame.word);
+    }
+    bool echo = this->echo_filter_.is_echo(frame.header, frame.word, esphome::millis());
+    xSemaphoreGive(this->queue_lock_);
+    if (!echo) {
+      this->frame_callback_.call(frame.header, frame.word);
+    }
+  }
+
+  if (this->adaptive_pacing_) {
+    xSemaphoreTake(this->queue_lock_, portMAX_DELAY);
+    bool changed = this->rate_.update(esphome::millis());
+    uint32_t gap_ms = this->rate_.get_gap_ms();
+    bool adaptive = this->rate_.is_adaptive();
+    xSemaphoreGive(this->queue_lock_);
+    if (changed && adaptive) {
+      ESP_LOGD(TAG, "Frame gap now %u ms", gap_ms);
+    } else if (changed) {
+      ESP_LOGW(TAG, "No echo from the command base, adaptive pacing disabled");
+      this->adaptive_pacing_ = false;
+    }
+  }
+}
+
+void TMCCBus::update() {
+  if (this->queue_lock_ == nullptr) {
+    return;
+  }
+
+  // Snapshot and reset the per-interval values in one short critical section
+  uint32_t samples[TMCC_LATENCY_SAMPLE_COUNT];
+  xSemaphoreTake(this->queue_lock_, portMAX_DELAY);
+  uint32_t now_us = esphome::micros();
+  uint32_t busy_us = this->busy_us_;
+  uint32_t frames_sent = this->frames_sent_;
+  size_t high_water = this->queue_high_water_;
+  size_t sample_count = std::min<size_t>(this->latency_sample_count_, TMCC_LATENCY_SAMPLE_COUNT);
+  std::copy(this->latency_samples_, this->latency_samples_ + sample_count, samples);
+  this->queue_high_water_ = this->tx_queue_.size();
+  this->latency_sample_count_ = 0;
+  xSemaphoreGive(this->queue_lock_);
+
+  uint32_t busy_delta_us = busy_us - this->last_busy_us_;
+  uint32_t elapsed_us = now_us - this->last_update_us_;
+  this->last_busy_us_ = busy_us;
+  this->last_update_us_ = now_us;
+
+  if (this->frames_sent_sensor_ != nullptr) {
+    this->frames_sent_sensor_->publish_state(frames_sent);
+  }
+  if (this->bytes_sent_sensor_ != nullptr) {
+    this->bytes_sent_sensor_->publish_state(this->bytes_sent_);
+  }
+  if (this->busy_time_sensor_ != nullptr) {
+    this->busy_time_sensor_->publish_state(busy_delta_us / 1000.0f);
+  }
+  if (this->utilization_sensor_ != nullptr && elapsed_us > 0) {
+    this->utilization_sensor_->publish_state(std::min(100.0f, 100.0f * busy_delta_us / elapsed_us));
+  }
+  if (this->queue_high_water_sensor_ != nullptr) {
+    this->queue_high_water_sensor_->publish_state(high_water);
+  }
+
+  // Percentiles over this interval's latest samples. Idle intervals leave the
+  // last published value in place.
+  if (sample_count == 0) {
+    return;
+  }
+  std::sort(samples, samples + sample_count);
+  if (this->latency_p50_sensor_ != nullptr) {
+    this->latency_p50_sensor_->publish_state(samples[(sample_count - 1) / 2] / 1000.0f);
+  }
+  if (this->latency_p99_sensor_ != nullptr) {
+    this->latency_p99_sensor_->publish_state(samples[(sample_count - 1) * 99 / 100] / 1000.0f);
   }
 }
 
 void TMCCBus::dump_config() {
   ESP_LOGCONFIG(TAG, "TMCC Bus:");
-  if (this->uart_ != nullptr) {
-    ESP_LOGCONFIG(TAG, "  UART configured");
+  if (this->transport_ != nullptr) {
+    ESP_LOGCONFIG(TAG, "  Transport: %s", this->transport_->get_name());
   } else {
-    ESP_LOGCONFIG(TAG, "  UART not configured!");
+    ESP_LOGCONFIG(TAG, "  Transport not configured!");
+  }
+  ESP_LOGCONFIG(TAG, "  TX Queue Size: %u", this->queue_size_);
+  ESP_LOGCONFIG(TAG, "  Drop Policy: %s",
+                this->drop_policy_ == TMCCDropPolicy::DROP_OLDEST ? "drop oldest" : "drop newest");
+  ESP_LOGCONFIG(TAG, "  Stream Interval: %u ms", this->stream_interval_ms_);
+  ESP_LOGCONFIG(TAG, "  Frame Gap: %u ms%s", this->frame_gap_ms_, this->adaptive_pacing_ ? " (adaptive)" : "");
+  if (this->adaptive_pacing_) {
+    ESP_LOGCONFIG(TAG, "  Max Frame Gap: %u ms", this->max_frame_gap_ms_);
   }
+  if (this->burst_limit_ > 0) {
+    ESP_LOGCONFIG(TAG, "  Burst: %u frames, then %u ms pause", this->burst_limit_, this->burst_pause_ms_);
+  }
+  ESP_LOGCONFIG(TAG, "  Halt Repetitions: %u", this->halt_repetitions_);
+  ESP_LOGCONFIG(TAG, "  Suppress Duplicates: %s", this->suppress_duplicates_ ? "yes" : "no");
+  ESP_LOGCONFIG(TAG, "  Trace Size: %zu records", this->trace_buffer_.capacity());
+  ESP_LOGCONFIG(TAG, "  Frames Sent: %u (%u bytes)", this->get_frames_sent(), this->get_bytes_sent());
+  ESP_LOGCONFIG(TAG, "  Frames Coalesced: %u", this->get_frames_coalesced());
+  ESP_LOGCONFIG(TAG, "  Frames Dropped: %u", this->get_frames_dropped());
+  ESP_LOGCONFIG(TAG, "  Frames Received: %u (%u echoes, %u lost, %u stray bytes)", this->frames_received_,
+                this->get_frames_echoed(), this->rx_overflows_.load(), this->rx_parser_.get_discarded_bytes());
+  ESP_LOGCONFIG(TAG, "  Halt Latency: last %u us, worst %u us", this->halt_latency_last_us_,
+                this->halt_latency_max_us_);
+  LOG_UPDATE_INTERVAL(this);
+  LOG_SENSOR("  ", "Frames Sent", this->frames_sent_sensor_);
+  LOG_SENSOR("  ", "Bytes Sent", this->bytes_sent_sensor_);
+  LOG_SENSOR("  ", "Busy Time", this->busy_time_sensor_);
+  LOG_SENSOR("  ", "Bus Utilization", this->utilization_sensor_);
+  LOG_SENSOR("  ", "Queue High-Water", this->queue_high_water_sensor_);
+  LOG_SENSOR("  ", "Latency p50", this->latency_p50_sensor_);
+  LOG_SENSOR("  ", "Latency p99", this->latency_p99_sensor_);
 }
 
 float TMCCBus::get_setup_priority() const {
-  // Run after UART is set up
+  // Run after the UART component is set up
   return esphome::setup_priority::DATA;
 }
 
-void TMCCBus::set_uart(esphome::uart::UARTComponent *uart) {
-  this->uart_ = uart;
+void TMCCBus::set_transport(TMCCTransport *transport) {
+  this->transport_ = transport;
+}
+
+void TMCCBus::set_queue_size(uint16_t queue_size) {
+  this->queue_size_ = queue_size;
+}
+
+void TMCCBus::set_drop_policy(TMCCDropPolicy drop_policy) {
+  this->drop_policy_ = drop_policy;
+}
+
+void TMCCBus::set_stream_interval(uint16_t stream_interval_ms) {
+  this->stream_interval_ms_ = stream_interval_ms;
+}
+
+void TMCCBus::set_trace_size(uint16_t trace_size) {
+  this->trace_size_ = trace_size;
+}
+
+void TMCCBus::set_frame_gap(uint16_t frame_gap_ms) {
+  this->frame_gap_ms_ = frame_gap_ms;
+}
+
+void TMCCBus::set_burst_limit(uint8_t burst_limit) {
+  this->burst_limit_ = burst_limit;
+}
+
+void TMCCBus::set_burst_pause(uint16_t burst_pause_ms) {
+  this->burst_pause_ms_ = burst_pause_ms;
+}
+
+void TMCCBus::set_adaptive_pacing(bool adaptive, uint16_t max_frame_gap_ms) {
+  this->adaptive_pacing_ = adaptive;
+  this->max_frame_gap_ms_ = max_frame_gap_ms;
+}
+
+void TMCCBus::set_halt_repetitions(uint8_t halt_repetitions) {
+  this->halt_repetitions_ = halt_repetitions;
+}
+
+void TMCCBus::set_suppress_duplicates(bool suppress_duplicates) {
+  this->suppress_duplicates_ = suppress_duplicates;
+}
+
+bool TMCCBus::get_suppress_duplicates() const {
+  return this->suppress_duplicates_;
+}
+
+void TMCCBus::set_frames_sent_sensor(esphome::sensor::Sensor *sensor) {
+  this->frames_sent_sensor_ = sensor;
+}
+
+void TMCCBus::set_bytes_sent_sensor(esphome::sensor::Sensor *sensor) {
+  this->bytes_sent_sensor_ = sensor;
+}
+
+void TMCCBus::set_busy_time_sensor(esphome::sensor::Sensor *sensor) {
+  this->busy_time_sensor_ = sensor;
+}
+
+void TMCCBus::set_utilization_sensor(esphome::sensor::Sensor *sensor) {
+  this->utilization_sensor_ = sensor;
+}
+
+void TMCCBus::set_queue_high_water_sensor(esphome::sensor::Sensor *sensor) {
+  this->queue_high_water_sensor_ = sensor;
+}
+
+void TMCCBus::set_latency_p50_sensor(esphome::sensor::Sensor *sensor) {
+  this->latency_p50_sensor_ = sensor;
+}
+
+void TMCCBus::set_latency_p99_sensor(esphome::sensor::Sensor *sensor) {
+  this->latency_p99_sensor_ = sensor;
+}
+
+uint32_t TMCCBus::get_frames_dropped() const {
+  return this->frames_dropped_;
+}
+
+uint32_t TMCCBus::get_frames_coalesced() const {
+  return this->frames_coalesced_;
+}
+
+uint32_t TMCCBus::get_frames_sent() const {
+  return this->frames_sent_;
+}
+
+uint32_t TMCCBus::get_frames_received() const {
+  return this->frames_received_;
+}
+
+uint32_t TMCCBus::get_frames_echoed() {
+  if (this->queue_lock_ == nullptr) {
+    return 0;
+  }
+  xSemaphoreTake(this->queue_lock_, portMAX_DELAY);
+  uint32_t echoes = this->echo_filter_.get_echoes();
+  xSemaphoreGive(this->queue_lock_);
+  return echoes;
+}
+
+uint32_t TMCCBus::get_bytes_sent() const {
+  return this->bytes_sent_;
+}
+
+size_t TMCCBus::get_queue_free() {
+  if (this->queue_lock_ == nullptr) {
+    return 0;
+  }
+  xSemaphoreTake(this->queue_lock_, portMAX_DELAY);
+  size_t free_slots = this->tx_queue_.capacity() - this->tx_queue_.size();
+  xSemaphoreGive(this->queue_lock_);
+  return free_slots;
+}
+
+bool TMCCBus::is_tx_idle() {
+  return this->queue_lock_ != nullptr && this->get_queue_free() == this->tx_queue_.capacity();
+}
+
+void TMCCBus::add_on_frame_callback(std::function<void(uint8_t, uint16_t)> &&callback) {
+  this->frame_callback_.add(std::move(callback));
+}
+
+void TMCCBus::add_on_queued_callback(std::function<void(uint8_t, uint16_t)> &&callback) {
+  this->queued_callback_.add(std::move(callback));
+}
+
+void TMCCBus::add_on_halt_callback(std::function<void()> &&callback) {
+  this->halt_callback_.add(std::move(callback));
+}
+
+uint32_t TMCCBus::get_halt_latency_last_us() const {
+  return this->halt_latency_last_us_;
+}
+
+uint32_t TMCCBus::get_halt_latency_max_us() const {
+  return this->halt_latency_max_us_;
+}
+
+uint32_t TMCCBus::get_emergency_latency_us() const {
+  return this->emergency_latency_us_;
+}
+
+uint32_t TMCCBus::get_emergency_halt_count() const {
+  return this->emergency_halt_count_;
 }
 
 void TMCCBus::format_binary(uint8_t byte, char *buffer) {
@@ -40,105 +386,575 @@ void TMCCBus::format_binary(uint8_t byte, char *buffer) {
   buffer[8] = '\0';
 }
 
-void TMCCBus::send_tmcc1_frame(uint16_t word) {
-  ESP_LOGD(TAG, "send_tmcc1_frame: word=0x%04X (%u)", word, word);
+bool TMCCBus::send_frame(uint8_t header, uint16_t word) {
+  TMCCTxEntry entry{};
+  entry.header = header;
+  entry.word = word;
+  entry.repetitions = 1;
+  return this->enqueue_(entry);
+}
 
-  if (this->uart_ == nullptr) {
-    ESP_LOGE(TAG, "Cannot send TMCC1 frame: UART not configured");
+bool TMCCBus::send_tmcc1_frame(uint16_t word) {
+  TMCC_LOG_FRAME(TAG, "send_tmcc1_frame: word=0x%04X (%u)", word, word);
+  return this->send_frame(TMCC1_HEADER, word);
+}
+
+bool TMCCBus::send_frame_repeated(uint8_t header, uint16_t word, uint8_t repetitions) {
+  if (repetitions == 0) {
+    repetitions = 1;
+  }
+  TMCCTxEntry entry{};
+  entry.header = header;
+  entry.word = word;
+  entry.repetitions = (repetitions > MAX_REPETITIONS) ? MAX_REPETITIONS : repetitions;
+  return this->enqueue_(entry);
+}
+
+bool TMCCBus::send_tmcc1_frame_repeated(uint16_t word, uint8_t repetitions) {
+  return this->send_frame_repeated(TMCC1_HEADER, word, repetitions);
+}
+
+bool TMCCBus::send_tmcc2_frame(uint8_t header, uint16_t word) {
+  TMCC_LOG_FRAME(TAG, "send_tmcc2_frame: header=0x%02X word=0x%04X", header, word);
+  return this->send_frame(header, word);
+}
+
+bool TMCCBus::send_tmcc2_frames(const TMCCFrame *frames, size_t count) {
+  TMCC_LOG_FRAME(TAG, "send_tmcc2_frames: %zu frames", count);
+  if (this->writer_task_handle_ == nullptr) {
+    ESP_LOGE(TAG, "Cannot send Legacy frames: bus not ready");
+    return false;
+  }
+  if (count == 0 || count > TMCC2_PARAMETER_FRAME_COUNT) {
+    ESP_LOGE(TAG, "Cannot send %zu chained Legacy frames", count);
+    return false;
+  }
+
+  TMCCTxEntry entries[TMCC2_PARAMETER_FRAME_COUNT];
+  uint32_t now_us = esphome::micros();
+  for (size_t i = 0; i < count; i++) {
+    entries[i] = TMCCTxEntry{};
+    entries[i].header = frames[i].header;
+    entries[i].word = frames[i].word;
+    entries[i].repetitions = 1;
+    entries[i].priority = TMCCPriority::NORMAL;
+    entries[i].enqueued_us = now_us;
+  }
+
+  xSemaphoreTake(this->queue_lock_, portMAX_DELAY);
+  bool accepted = this->tx_queue_.push_chain(entries, count);
+  if (accepted) {
+    this->queue_high_water_ = std::max(this->queue_high_water_, this->tx_queue_.size());
+  } else {
+    this->frames_dropped_ += count;
+    this->record_trace_(TMCCTraceSource::DROP, entries[0].header, entries[0].word, 1);
+  }
+  xSemaphoreGive(this->queue_lock_);
+
+  if (!accepted) {
+    ESP_LOGW(TAG, "TX queue full, dropped %zu chained Legacy frames", count);
+    return false;
+  }
+  xTaskNotifyGive(this->writer_task_handle_);
+  for (size_t i = 0; i < count; i++) {
+    this->queued_callback_.call(frames[i].header, frames[i].word);
+  }
+  return true;
+}
+
+bool TMCCBus::start_tmcc1_stream(uint16_t word, uint32_t duration_ms) {
+  return this->start_stream(TMCC1_HEADER, word, duration_ms);
+}
+
+void TMCCBus::stop_tmcc1_stream(uint16_t word) {
+  this->stop_stream(TMCC1_HEADER, word);
+}
+
+bool TMCCBus::start_stream(uint8_t header, uint16_t word, uint32_t duration_ms) {
+  TMCC_LOG_FRAME(TAG, "start_stream: header=0x%02X word=0x%04X duration=%ums", header, word, duration_ms);
+  if (this->writer_task_handle_ == nullptr) {
+    ESP_LOGE(TAG, "Cannot start stream: bus not ready");
+    return false;
+  }
+
+  uint32_t now = esphome::millis();
+  xSemaphoreTake(this->queue_lock_, portMAX_DELAY);
+  bool extended = this->tx_queue_.update_stream(header, word, now + duration_ms);
+  xSemaphoreGive(this->queue_lock_);
+  if (extended) {
+    // Already streaming this word: just keep it going for longer
+    return true;
+  }
+
+  TMCCTxEntry entry{};
+  entry.header = header;
+  entry.word = word;
+  entry.repetitions = 1;
+  entry.flags = TMCC_TX_FLAG_STREAM;
+  entry.interval_ms = this->stream_interval_ms_;
+  entry.due_ms = now;
+  entry.until_ms = now + duration_ms;
+  return this->enqueue_(entry);
+}
+
+void TMCCBus::stop_stream(uint8_t header, uint16_t word) {
+  TMCC_LOG_FRAME(TAG, "stop_stream: header=0x%02X word=0x%04X", header, word);
+  if (this->writer_task_handle_ == nullptr) {
     return;
   }
+  // A stream ends when its deadline passes; moving the deadline to now lets
+  // the writer drop it at the next frame boundary
+  xSemaphoreTake(this->queue_lock_, portMAX_DELAY);
+  this->tx_queue_.update_stream(header, word, esphome::millis());
+  xSemaphoreGive(this->queue_lock_);
+  xTaskNotifyGive(this->writer_task_handle_);
+}
+
+// remove_if() predicates used to purge commands made stale by halt/brake.
+// Chained frames are never purged one by one: a parameter index can look
+// like a direction command, and half a chain would never finish.
+static bool is_queued_motion(const TMCCTxEntry &entry, uint32_t /*unused*/) {
+  return (entry.flags & TMCC_TX_FLAG_CHAINED) == 0 && tmcc_frame_is_motion(entry.header, entry.word);
+}
+
+static bool is_queued_motion_for_object(const TMCCTxEntry &entry, uint32_t object_key) {
+  return is_queued_motion(entry, 0) && tmcc_frame_object_key(entry.header, entry.word) == object_key;
+}
+
+// Whole chains are dropped by the TMCC1 frames in them, which Legacy
+// parameter chains never have: a batch that would restart trains after a halt
+static bool is_tmcc1_motion(const TMCCTxEntry &entry, uint32_t /*unused*/) {
+  return entry.header == TMCC1_HEADER && tmcc_frame_is_motion(entry.header, entry.word);
+}
+
+// Queue priority of a frame: halts first, then brakes, then everything else
+static TMCCPriority frame_priority(uint8_t header, uint16_t word) {
+  if (header == TMCC1_HEADER && word == TMCC1_SYSTEM_HALT_WORD) {
+    return TMCCPriority::HALT;
+  }
+  if (tmcc_frame_is_brake(header, word)) {
+    return TMCCPriority::HIGH;
+  }
+  return TMCCPriority::NORMAL;
+}
 
-  // Build the 3-byte frame: 0xFE + high byte + low byte
-  uint8_t frame[3];
-  frame[0] = TMCC1_HEADER;
-  frame[1] = static_cast<uint8_t>((word >> 8) & 0xFF);
-  frame[2] = static_cast<uint8_t>(word & 0xFF);
+bool TMCCBus::enqueue_(TMCCTxEntry &entry) {
+  if (this->writer_task_handle_ == nullptr) {
+    ESP_LOGE(TAG, "Cannot send TMCC1 frame: bus not ready");
+    return false;
+  }
 
-  ESP_LOGI(TAG, "TX: [0x%02X, 0x%02X, 0x%02X]", frame[0], frame[1], frame[2]);
+  size_t purged = 0;
+  xSemaphoreTake(this->queue_lock_, portMAX_DELAY);
+  bool accepted = this->enqueue_locked_(entry, &purged);
+  xSemaphoreGive(this->queue_lock_);
 
-  // Send all 3 bytes in a single write
-  this->uart_->write_array(frame, 3);
-  
-  // Flush UART to ensure transmission completes before returning
-  this->uart_->flush();
+  if (purged > 0) {
+    ESP_LOGD(TAG, "Purged %zu stale motion command(s)", purged);
+  }
+  if (!accepted) {
+    ESP_LOGW(TAG, "TX queue full, dropped word 0x%04X", entry.word);
+    return false;
+  }
+
+  xTaskNotifyGive(this->writer_task_handle_);
+  this->queued_callback_.call(entry.header, entry.word);
+  return true;
 }
 
-void TMCCBus::send_tmcc1_frame_repeated(uint16_t word, uint8_t repetitions) {
-  if (this->uart_ == nullptr) {
-    ESP_LOGE(TAG, "Cannot send TMCC1 frame: UART not configured");
+bool TMCCBus::enqueue_locked_(TMCCTxEntry &entry, size_t *purged) {
+  uint16_t word = entry.word;
+  entry.priority = frame_priority(entry.header, word);
+  entry.enqueued_us = esphome::micros();
+
+  if (entry.priority == TMCCPriority::NORMAL && tmcc_frame_is_absolute_speed(entry.header, word) &&
+      this->tx_queue_.coalesce(entry)) {
+    // An intermediate speed was still waiting; it is replaced, never sent
+    this->frames_coalesced_++;
+    return true;
+  }
+  if (entry.priority == TMCCPriority::HALT) {
+    // Everything is stopping: queued speed/direction changes would restart trains
+    *purged += this->tx_queue_.remove_if(is_queued_motion, 0);
+    *purged += this->tx_queue_.remove_chains_if(is_tmcc1_motion, 0);
+  } else if (entry.priority == TMCCPriority::HIGH) {
+    *purged += this->tx_queue_.remove_if(is_queued_motion_for_object, tmcc_frame_object_key(entry.header, word));
+  }
+
+  bool accepted = true;
+  if (this->tx_queue_.full()) {
+    this->frames_dropped_++;
+    // A halt is never refused: it displaces anything but another halt, a
+    // whole chain if need be. Brakes may displace normal traffic; normal
+    // traffic only displaces normal traffic, and only under drop-oldest.
+    if (entry.priority == TMCCPriority::HALT) {
+      if (!this->tx_queue_.evict_for_halt()) {
+        // Nothing but halts queued: they already stop every train
+        return true;
+      }
+    } else if (entry.priority == TMCCPriority::HIGH || this->drop_policy_ == TMCCDropPolicy::DROP_OLDEST) {
+      accepted = this->tx_queue_.evict_oldest(TMCCPriority::NORMAL);
+    } else {
+      accepted = false;
+    }
+  }
+  if (accepted) {
+    this->tx_queue_.push(entry);
+    this->queue_high_water_ = std::max(this->queue_high_water_, this->tx_queue_.size());
+  } else {
+    this->record_trace_(TMCCTraceSource::DROP, entry.header, word, entry.repetitions);
+  }
+  return accepted;
+}
+
+bool TMCCBus::send_batch(const TMCCFrame *frames, size_t count) {
+  if (this->writer_task_handle_ == nullptr) {
+    ESP_LOGE(TAG, "Cannot send batch: bus not ready");
+    return false;
+  }
+  if (count == 0) {
+    return true;
+  }
+
+  // Admit the whole batch or none of it. Purges only ever free slots, so
+  // checking for `count` free slots up front is enough.
+  xSemaphoreTake(this->queue_lock_, portMAX_DELAY);
+  size_t capacity = this->tx_queue_.capacity();
+  size_t free_slots = capacity - this->tx_queue_.size();
+  if (free_slots < count) {
+    this->frames_dropped_ += count;
+    this->record_trace_(TMCCTraceSource::DROP, frames[0].header, frames[0].word, 1);
+    xSemaphoreGive(this->queue_lock_);
+    if (count > capacity) {
+      ESP_LOGE(TAG, "Batch of %zu frames is larger than the TX queue (queue_size %zu), dropped it", count,
+               capacity);
+    } else {
+      ESP_LOGW(TAG, "TX queue has room for %zu of %zu batch frames, dropped the batch", free_slots, count);
+    }
+    return false;
+  }
+
+  // One chain, so no frame of the same or lower priority gets between the
+  // frames; a halt or brake still goes out at the next frame boundary. It
+  // is queued at the priority of its most urgent frame, and its halts and
+  // brakes purge queued motion like single frames do.
+  std::vector<TMCCTxEntry> entries(count);
+  TMCCPriority priority = TMCCPriority::NORMAL;
+  uint32_t now_us = esphome::micros();
+  size_t purged = 0;
+  for (size_t i = 0; i < count; i++) {
+    TMCCPriority frame = frame_priority(frames[i].header, frames[i].word);
+    priority = std::max(priority, frame);
+    if (frame == TMCCPriority::HALT) {
+      purged += this->tx_queue_.remove_if(is_queued_motion, 0);
+      purged += this->tx_queue_.remove_chains_if(is_tmcc1_motion, 0);
+    } else if (frame == TMCCPriority::HIGH) {
+      purged += this->tx_queue_.remove_if(is_queued_motion_for_object,
+                                          tmcc_frame_object_key(frames[i].header, frames[i].word));
+    }
+    entries[i].header = frames[i].header;
+    entries[i].word = frames[i].word;
+    entries[i].repetitions = 1;
+    entries[i].flags = TMCC_TX_FLAG_PREEMPTIBLE;
+    entries[i].enqueued_us = now_us;
+  }
+  for (TMCCTxEntry &entry : entries) {
+    entry.priority = priority;
+  }
+  this->tx_queue_.push_chain(entries.data(), count);
+  this->queue_high_water_ = std::max(this->queue_high_water_, this->tx_queue_.size());
+  xSemaphoreGive(this->queue_lock_);
+
+  if (purged > 0) {
+    ESP_LOGD(TAG, "Purged %zu stale motion command(s)", purged);
+  }
+  xTaskNotifyGive(this->writer_task_handle_);
+  for (size_t i = 0; i < count; i++) {
+    this->queued_callback_.call(frames[i].header, frames[i].word);
+  }
+  return true;
+}
+
+#ifdef USE_API
+void TMCCBus::on_send_words_service_(std::vector<int32_t> words) {
+  std::vector<TMCCFrame> frames;
+  frames.reserve(words.size());
+  for (size_t i = 0; i < words.size(); i++) {
+    if (words[i] < 0 || words[i] > 0xFFFF) {
+      ESP_LOGW(TAG, "send_words: word %zu (%d) is not a 16-bit value, batch rejected", i, words[i]);
+      return;
+    }
+    frames.push_back(TMCCFrame{TMCC1_HEADER, static_cast<uint16_t>(words[i])});
+  }
+  this->send_batch(frames.data(), frames.size());
+}
+
+void TMCCBus::on_send_batch_service_(std::vector<int32_t> types, std::vector<int32_t> addresses,
+                                     std::vector<int32_t> classes, std::vector<int32_t> data) {
+  size_t count = types.size();
+  if (addresses.size() != count || classes.size() != count || data.size() != count) {
+    ESP_LOGW(TAG, "send_batch: types, addresses, classes and data must have the same length");
     return;
   }
 
-  if (repetitions == 0) {
-    repetitions = 1;
+  // Validate and encode every tuple before anything is queued
+  std::vector<TMCCFrame> frames;
+  frames.reserve(count);
+  for (size_t i = 0; i < count; i++) {
+    if (types[i] < 0 || types[i] > static_cast<int32_t>(TMCCObjectType::ROUTE) || classes[i] < 0 ||
+        classes[i] > 3 || data[i] < 0 || data[i] > 0x1F || addresses[i] < 0 ||
+        addresses[i] > tmcc_max_address(static_cast<TMCCObjectType>(types[i]))) {
+      ESP_LOGW(TAG, "send_batch: entry %zu (%d, %d, %d, %d) is out of range, batch rejected", i, types[i],
+               addresses[i], classes[i], data[i]);
+      return;
+    }
+    frames.push_back(TMCCFrame{TMCC1_HEADER, tmcc_make_word(static_cast<TMCCObjectType>(types[i]),
+                                                            static_cast<uint8_t>(addresses[i]),
+                                                            static_cast<TMCCCommandClass>(classes[i]),
+                                                            static_cast<uint8_t>(data[i]))});
   }
+  this->send_batch(frames.data(), frames.size());
+}
+#endif
 
-  // Limit to 30 repetitions max (90 bytes) - used for horn duration control
-  uint8_t max_reps = (repetitions > 30) ? 30 : repetitions;
+void TMCCBus::writer_task_(void *arg) {
+  TMCCBus *bus = static_cast<TMCCBus *>(arg);
+  TMCCTxEntry frame;
+  uint8_t burst = 0;  // Frames sent since the writer was last idle or paused
 
-  // Build the 3-byte frame: 0xFE + high byte + low byte
-  uint8_t single_frame[3];
-  single_frame[0] = TMCC1_HEADER;
-  single_frame[1] = static_cast<uint8_t>((word >> 8) & 0xFF);
-  single_frame[2] = static_cast<uint8_t>(word & 0xFF);
+  // One frame per iteration, so a newly queued halt is picked up at the
+  // next frame boundary even in the middle of a repeated burst or stream
+  while (true) {
+    uint32_t wait_ms;
+    uint32_t gap_ms = 0;
+    xSemaphoreTake(bus->queue_lock_, portMAX_DELAY);
+    bool have_frame = bus->tx_queue_.take_frame(esphome::millis(), &frame, &wait_ms);
+    if (have_frame) {
+      bus->record_trace_(TMCCTraceSource::TX, frame.header, frame.word, frame.repetitions);
+      // Remembered before the write, so even an instant echo finds it
+      bus->echo_filter_.on_sent(frame.header, frame.word, esphome::millis());
+      bool stream = (frame.flags & TMCC_TX_FLAG_STREAM) != 0;
+      if (bus->recording_ != nullptr && ((frame.flags & TMCC_TX_FLAG_STARTED) == 0 || stream)) {
+        // One record per command; the writer regenerates repetitions on replay
+        bus->recording_->append(esphome::micros(), frame.header, frame.word, stream ? 1 : frame.repetitions,
+                                (frame.flags & TMCC_TX_FLAG_CHAIN_NEXT) != 0);
+      }
+      gap_ms = bus->rate_.get_gap_ms();
+    }
+    xSemaphoreGive(bus->queue_lock_);
+    if (have_frame) {
+      bus->transmit_frame_(frame);
+      if (frame.header == TMCC1_HEADER && bus->adaptive_pacing_) {
+        xSemaphoreTake(bus->queue_lock_, portMAX_DELAY);
+        bus->rate_.on_sent(frame.word, esphome::millis());
+        xSemaphoreGive(bus->queue_lock_);
+      }
 
-  ESP_LOGI(TAG, "TX repeated: [0x%02X, 0x%02X, 0x%02X] x%u", 
-           single_frame[0], single_frame[1], single_frame[2], max_reps);
+      // Give the command base time to put the frame on the track. Only this
+      // task waits; a halt queued meanwhile goes out right after the pause.
+      if (bus->burst_limit_ > 0 && ++burst >= bus->burst_limit_) {
+        burst = 0;
+        gap_ms = std::max<uint32_t>(gap_ms, bus->burst_pause_ms_);
+      }
+      if (gap_ms > 0) {
+        vTaskDelay(pdMS_TO_TICKS(gap_ms));
+      }
+      continue;
+    }
+    burst = 0;
 
-  // Build buffer with repeated frames
-  uint8_t buffer[90];  // 30 * 3 = 90 bytes max
-  for (uint8_t i = 0; i < max_reps; i++) {
-    buffer[i * 3] = single_frame[0];
-    buffer[i * 3 + 1] = single_frame[1];
-    buffer[i * 3 + 2] = single_frame[2];
+    // Sleep until enqueue_() signals new work or the next stream slot is due
+    ulTaskNotifyTake(pdTRUE, wait_ms == UINT32_MAX ? portMAX_DELAY : pdMS_TO_TICKS(wait_ms) + 1);
   }
-  
-  // Send all frames in a single write
-  this->uart_->write_array(buffer, max_reps * 3);
-  
-  // Flush UART to ensure transmission completes
-  this->uart_->flush();
+}
+
+void TMCCBus::rx_task_(void *arg) {
+  TMCCBus *bus = static_cast<TMCCBus *>(arg);
+  uint8_t buffer[RX_READ_SIZE];
+  TMCCFrame frame;
+
+  while (true) {
+    size_t count = bus->transport_->read(buffer, sizeof(buffer));
+    if (count == 0) {
+      if (!bus->transport_->wait_readable(RX_WAIT_MS)) {
+        vTaskDelay(pdMS_TO_TICKS(RX_IDLE_MS));
+      }
+      continue;
+    }
+    for (size_t i = 0; i < count; i++) {
+      if (bus->rx_parser_.feed(buffer[i], &frame) && xQueueSend(bus->rx_queue_, &frame, 0) != pdTRUE) {
+        bus->rx_overflows_++;
+      }
+    }
+  }
+}
+
+void TMCCBus::transmit_frame_(const TMCCTxEntry &frame) {
+  // Build the 3-byte frame: header + high byte + low byte
+  uint8_t data[TMCC_FRAME_SIZE];
+  data[0] = frame.header;
+  data[1] = static_cast<uint8_t>((frame.word >> 8) & 0xFF);
+  data[2] = static_cast<uint8_t>(frame.word & 0xFF);
+
+  bool first = (frame.flags & TMCC_TX_FLAG_STARTED) == 0;
+#ifdef USE_TMCC_FRAME_LOG
+  if (first) {
+    if ((frame.flags & TMCC_TX_FLAG_STREAM) != 0) {
+      ESP_LOGD(TAG, "TX stream: [0x%02X, 0x%02X, 0x%02X]", data[0], data[1], data[2]);
+    } else if (frame.repetitions > 1) {
+      ESP_LOGD(TAG, "TX repeated: [0x%02X, 0x%02X, 0x%02X] x%u", data[0], data[1], data[2], frame.repetitions);
+    } else {
+      ESP_LOGD(TAG, "TX: [0x%02X, 0x%02X, 0x%02X]", data[0], data[1], data[2]);
+    }
+  }
+#endif
+
+  // Write the frame and wait for the wire. This blocks only the writer task,
+  // never the ESPHome main loop.
+  xSemaphoreTake(this->write_lock_, portMAX_DELAY);
+  uint32_t start_us = esphome::micros();
+  this->transport_->write(data, sizeof(data));
+  this->transport_->flush();
+  uint32_t end_us = esphome::micros();
+  this->bytes_sent_ += sizeof(data);
+  xSemaphoreGive(this->write_lock_);
+
+  // Only the halt word itself: a batch holding a halt is queued at HALT too
+  if (first && frame.priority == TMCCPriority::HALT && frame.word == TMCC1_SYSTEM_HALT_WORD) {
+    if (this->emergency_latency_pending_.exchange(false)) {
+      // start_us is taken right before the first byte is handed to the transport
+      this->emergency_latency_us_ = start_us - this->emergency_pressed_us_;
+      this->emergency_halt_count_++;
+    }
+    uint32_t latency = end_us - frame.enqueued_us;
+    this->halt_latency_last_us_ = latency;
+    if (latency > this->halt_latency_max_us_) {
+      this->halt_latency_max_us_ = latency;
+    }
+  }
+
+  // A command is complete when its last repetition or last chained frame is
+  // on the wire. Streams have no single completion time and are not sampled.
+  bool last = (frame.flags & (TMCC_TX_FLAG_STREAM | TMCC_TX_FLAG_CHAIN_NEXT)) == 0 && frame.repetitions <= 1;
+  xSemaphoreTake(this->queue_lock_, portMAX_DELAY);
+  this->frames_sent_++;
+  this->busy_us_ += end_us - start_us;
+  if (last) {
+    this->latency_samples_[this->latency_sample_count_ % TMCC_LATENCY_SAMPLE_COUNT] = end_us - frame.enqueued_us;
+    this->latency_sample_count_++;
+  }
+  xSemaphoreGive(this->queue_lock_);
+}
+
+void TMCCBus::record_trace_(TMCCTraceSource source, uint8_t header, uint16_t word, uint8_t repetitions) {
+  TMCCTraceRecord record;
+  record.timestamp_us = esphome::micros();
+  record.word = word;
+  record.header = header;
+  record.repetitions = repetitions;
+  record.source = source;
+  this->trace_buffer_.record(record);
 }
 
 void TMCCBus::engine_action_tmcc1(uint8_t address, TMCCEngineAction action) {
-  ESP_LOGD(TAG, "engine_action_tmcc1: address=%u action=%u", address, static_cast<uint8_t>(action));
+  TMCC_LOG_FRAME(TAG, "engine_action_tmcc1: address=%u action=%u", address, static_cast<uint8_t>(action));
   uint16_t word = tmcc_engine_action_word(address, action);
   this->send_tmcc1_frame(word);
 }
 
 void TMCCBus::engine_action_repeated_tmcc1(uint8_t address, TMCCEngineAction action, uint8_t repetitions) {
-  ESP_LOGD(TAG, "engine_action_repeated_tmcc1: address=%u action=%u repetitions=%u", 
+  TMCC_LOG_FRAME(TAG, "engine_action_repeated_tmcc1: address=%u action=%u repetitions=%u", 
            address, static_cast<uint8_t>(action), repetitions);
   uint16_t word = tmcc_engine_action_word(address, action);
   this->send_tmcc1_frame_repeated(word, repetitions);
 }
 
+bool TMCCBus::engine_stream_tmcc1(uint8_t address, TMCCEngineAction action, uint32_t duration_ms) {
+  return this->start_tmcc1_stream(tmcc_engine_action_word(address, action), duration_ms);
+}
+
+void TMCCBus::engine_stream_stop_tmcc1(uint8_t address, TMCCEngineAction action) {
+  this->stop_tmcc1_stream(tmcc_engine_action_word(address, action));
+}
+
 void TMCCBus::engine_speed_absolute_tmcc1(uint8_t address, uint8_t speed) {
-  ESP_LOGD(TAG, "engine_speed_absolute_tmcc1: address=%u speed=%u", address, speed);
+  TMCC_LOG_FRAME(TAG, "engine_speed_absolute_tmcc1: address=%u speed=%u", address, speed);
   uint16_t word = tmcc_engine_speed_word(address, speed);
   this->send_tmcc1_frame(word);
 }
 
+void TMCCBus::engine_action_tmcc2(uint8_t address, TMCCEngineAction action) {
+  TMCC_LOG_FRAME(TAG, "engine_action_tmcc2: address=%u action=%u", address, static_cast<uint8_t>(action));
+  this->send_tmcc2_frame(TMCC2_ENGINE_HEADER, tmcc2_engine_action_word(address, action));
+}
+
+bool TMCCBus::engine_stream_tmcc2(uint8_t address, TMCCEngineAction action, uint32_t duration_ms) {
+  return this->start_stream(TMCC2_ENGINE_HEADER, tmcc2_engine_action_word(address, action), duration_ms);
+}
+
+void TMCCBus::engine_stream_stop_tmcc2(uint8_t address, TMCCEngineAction action) {
+  this->stop_stream(TMCC2_ENGINE_HEADER, tmcc2_engine_action_word(address, action));
+}
+
+void TMCCBus::engine_speed_absolute_tmcc2(uint8_t address, uint8_t speed) {
+  TMCC_LOG_FRAME(TAG, "engine_speed_absolute_tmcc2: address=%u speed=%u", address, speed);
+  this->send_tmcc2_frame(TMCC2_ENGINE_HEADER, tmcc2_engine_speed_word(address, speed));
+}
+
+void TMCCBus::engine_parameter_tmcc2(uint8_t address, TMCC2ParameterIndex index, uint8_t data) {
+  TMCC_LOG_FRAME(TAG, "engine_parameter_tmcc2: address=%u index=0x%02X data=0x%02X", address,
+                 static_cast<uint8_t>(index), data);
+  TMCCFrame frames[TMCC2_PARAMETER_FRAME_COUNT];
+  tmcc2_make_parameter_frames(TMCC2_ENGINE_HEADER, address, index, data, frames);
+  this->send_tmcc2_frames(frames, TMCC2_PARAMETER_FRAME_COUNT);
+}
+
 void TMCCBus::system_halt() {
   // System Halt command: 0xFFFF (all bits set)
   // This matches the Python code: bytes([0xFE, 0b11111111, 0b11111111])
   ESP_LOGW(TAG, "SYSTEM HALT - Stopping all trains!");
-  this->send_tmcc1_frame_repeated(0xFFFF, 10);  // Send multiple times for reliability
+  this->send_tmcc1_frame_repeated(TMCC1_SYSTEM_HALT_WORD, this->halt_repetitions_);  // Repeated for reliability
+  this->halt_callback_.call();
+}
+
+void TMCCBus::emergency_halt(uint32_t pressed_us) {
+  if (this->writer_task_handle_ == nullptr) {
+    return;
+  }
+  TMCCTxEntry entry{};
+  entry.header = TMCC1_HEADER;
+  entry.word = TMCC1_SYSTEM_HALT_WORD;
+  entry.repetitions = std::min<uint8_t>(std::max<uint8_t>(this->halt_repetitions_, 1), MAX_REPETITIONS);
+
+  // Same path as system_halt(), minus the logging: the halt jumps the queue,
+  // purges queued motion and goes out when the frame on the wire finishes
+  size_t purged = 0;
+  xSemaphoreTake(this->queue_lock_, portMAX_DELAY);
+  this->emergency_pressed_us_ = pressed_us;
+  this->emergency_latency_pending_ = true;
+  this->enqueue_locked_(entry, &purged);
+  xSemaphoreGive(this->queue_lock_);
+  xTaskNotifyGive(this->writer_task_handle_);
+
+  this->emergency_halt_pending_ = true;
 }
 
 void TMCCBus::send_test_pattern() {
   ESP_LOGW(TAG, "=== SENDING TEST PATTERN ===");
   
-  if (this->uart_ == nullptr) {
-    ESP_LOGE(TAG, "Cannot send test pattern: UART not configured");
+  if (this->write_lock_ == nullptr) {
+    ESP_LOGE(TAG, "Cannot send test pattern: bus not ready");
     return;
   }
   
   // First, send alternating bit patterns (good for oscilloscope)
   uint8_t test_bytes[] = {0x55, 0xAA, 0x00, 0xFF, 0x55, 0xAA};
   ESP_LOGW(TAG, "Sending test bytes: 0x55 0xAA 0x00 0xFF 0x55 0xAA");
-  this->uart_->write_array(test_bytes, sizeof(test_bytes));
-  this->uart_->flush();
+  xSemaphoreTake(this->write_lock_, portMAX_DELAY);
+  this->transport_->write(test_bytes, sizeof(test_bytes));
+  this->transport_->flush();
+  this->bytes_sent_ += sizeof(test_bytes);
+  xSemaphoreGive(this->write_lock_);
   
   // Small delay before TMCC command
   vTaskDelay(pdMS_TO_TICKS(50));
@@ -151,18 +967,62 @@ void TMCCBus::send_test_pattern() {
 }
 
 void TMCCBus::send_raw_bytes(const uint8_t *data, size_t len) {
-  if (this->uart_ == nullptr) {
-    ESP_LOGE(TAG, "Cannot send raw bytes: UART not configured");
+  if (this->write_lock_ == nullptr) {
+    ESP_LOGE(TAG, "Cannot send raw bytes: bus not ready");
     return;
   }
   
   ESP_LOGD(TAG, "Sending %zu raw bytes", len);
   
-  // Send all bytes in a single write - no delays between bytes
-  this->uart_->write_array(data, len);
+  // Send all bytes in a single write - no delays between bytes and no frame
+  // gap, since raw bytes bypass the TX queue and its pacing. The write lock
+  // keeps them from interleaving with a frame the writer task is sending.
+  xSemaphoreTake(this->write_lock_, portMAX_DELAY);
+  this->transport_->write(data, len);
+  this->bytes_sent_ += len;
+  xSemaphoreGive(this->write_lock_);
   
   ESP_LOGD(TAG, "Raw bytes sent");
 }
 
+void TMCCBus::set_recording(TMCCRecording *recording) {
+  if (this->queue_lock_ == nullptr) {
+    this->recording_ = recording;
+    return;
+  }
+  xSemaphoreTake(this->queue_lock_, portMAX_DELAY);
+  this->recording_ = recording;
+  xSemaphoreGive(this->queue_lock_);
+}
+
+void TMCCBus::dump_trace() {
+  if (this->queue_lock_ == nullptr || this->trace_buffer_.capacity() == 0) {
+    ESP_LOGW(TAG, "Trace is not enabled");
+    return;
+  }
+
+  // Copy the ring under the lock and format it afterwards, so logging never
+  // holds up the writer task
+  TMCCTraceRecord *records = new (std::nothrow) TMCCTraceRecord[this->trace_buffer_.capacity()];
+  if (records == nullptr) {
+    ESP_LOGE(TAG, "Not enough memory to dump the trace");
+    return;
+  }
+  xSemaphoreTake(this->queue_lock_, portMAX_DELAY);
+  size_t count = this->trace_buffer_.copy(0, records, this->trace_buffer_.capacity());
+  uint32_t total = this->trace_buffer_.get_total_recorded();
+  xSemaphoreGive(this->queue_lock_);
+
+  static const char *const SOURCE_NAMES[] = {"TX", "RX", "DROP"};
+  ESP_LOGI(TAG, "Trace: %zu of %u frames (times relative to the oldest)", count, total);
+  for (size_t i = 0; i < count; i++) {
+    const TMCCTraceRecord &record = records[i];
+    ESP_LOGI(TAG, "  %10u us %-4s [0x%02X, 0x%02X, 0x%02X] x%u", record.timestamp_us - records[0].timestamp_us,
+             SOURCE_NAMES[static_cast<uint8_t>(record.source)], record.header, record.word >> 8, record.word & 0xFF,
+             record.repetitions);
+  }
+  delete[] records;
+}
+
 }  // namespace tmcc
 
@@ -1,47 +1,301 @@
 #pragma once
 
+#include <atomic>
+#include <functional>
+
 #include "esphome/core/component.h"
-#include "esphome/components/uart/uart.h"
+#include "esphome/core/helpers.h"
+#include "esphome/components/sensor/sensor.h"
+#include "tmcc_echo.h"
+#include "tmcc_pacing.h"
+#include "tmcc_parser.h"
 #include "tmcc_protocol.h"
+#include "tmcc_queue.h"
+#include "tmcc_recording.h"
+#include "tmcc_trace.h"
+#include "tmcc_transport.h"
+#ifdef USE_API
+#include "esphome/components/api/custom_api_device.h"
+#endif
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+
+// Per-frame text logging. Formatting a line for every frame costs more CPU
+// than queueing it, so these logs are only compiled in with `frame_log: true`
+// (USE_TMCC_FRAME_LOG). The binary trace ring covers the default build.
+#ifdef USE_TMCC_FRAME_LOG
+#define TMCC_LOG_FRAME(tag, ...) ESP_LOGD(tag, __VA_ARGS__)
+#else
+#define TMCC_LOG_FRAME(tag, ...)
+#endif
 
 namespace tmcc {
 
+// Command latencies kept per update interval for the p50/p99 sensors
+static constexpr size_t TMCC_LATENCY_SAMPLE_COUNT = 64;
+
 /**
  * TMCCBus - Main component for TMCC serial communication.
  *
  * This component handles the low-level serial communication with a
- * Lionel TMCC/Legacy command base. It sends TMCC1 0xFE frames over UART.
+ * Lionel TMCC/Legacy command base. It sends TMCC1 0xFE frames through a
+ * TMCCTransport: an ESPHome UART, the ESP-IDF UART driver, a TCP
+ * connection to a simulator, or an in-memory loopback.
+ *
+ * Frames are never written from the ESPHome main loop. The send methods
+ * append to a bounded TX queue and return immediately; a dedicated
+ * FreeRTOS writer task drains the queue and blocks on the transport instead.
+ *
+ * The writer sends one frame at a time and picks the next frame by
+ * priority at every frame boundary. System Halt and brake frames therefore
+ * preempt queued or partially sent bursts, and purge the motion commands
+ * they make stale.
+ *
+ * Absolute speed commands are coalesced while they wait: a newer speed for
+ * the same engine overwrites the queued one instead of queueing behind it,
+ * as long as no other command for that engine was queued in between.
+ *
+ * Frames coming back from the command base (e.g. from a CAB-1 handheld),
+ * TMCC1 and Legacy alike, are parsed by a receive task and handed to frame callbacks on the main
+ * loop, so engines can keep their entities in sync with the layout.
+ *
+ * Legacy (TMCC2) frames go through the same queue. Their multi-word
+ * parameter commands are queued as a chain and always sent back to back.
+ *
+ * Wire statistics (frames, bytes, busy time, queue high-water mark and
+ * command latency) are counted by the writer task and published to the
+ * optional performance sensors every update_interval.
+ *
+ * Every frame sent, received or dropped is also recorded in a fixed-size
+ * binary trace ring, which dump_trace() prints on demand.
+ *
+ * With the native API enabled, the bus registers Home Assistant services
+ * to send a batch of frames in one call and to dump the trace.
  */
-class TMCCBus : public esphome::Component {
+class TMCCBus : public esphome::PollingComponent
+#ifdef USE_API
+    , public esphome::api::CustomAPIDevice
+#endif
+{
  public:
   TMCCBus() = default;
 
   // ESPHome component lifecycle
   void setup() override;
+  void loop() override;
+  void update() override;
   void dump_config() override;
   float get_setup_priority() const override;
 
-  // UART configuration
-  void set_uart(esphome::uart::UARTComponent *uart);
+  // Where frames go; see tmcc_transport.h
+  void set_transport(TMCCTransport *transport);
+
+  // TX queue configuration
+  void set_queue_size(uint16_t queue_size);
+  void set_drop_policy(TMCCDropPolicy drop_policy);
+  void set_stream_interval(uint16_t stream_interval_ms);
+  void set_trace_size(uint16_t trace_size);  // 0 disables the trace ring
+
+  // Pacing: gap after every frame, and a longer pause after `burst_limit`
+  // back-to-back frames (0 = no limit). Adaptive pacing tunes the gap
+  // between frame_gap and max_frame_gap from the command base echo.
+  void set_frame_gap(uint16_t frame_gap_ms);
+  void set_burst_limit(uint8_t burst_limit);
+  void set_burst_pause(uint16_t burst_pause_ms);
+  void set_adaptive_pacing(bool adaptive, uint16_t max_frame_gap_ms);
+  void set_halt_repetitions(uint8_t halt_repetitions);
+
+  // Skip speed and direction commands that would not change an engine's
+  // known state (on by default)
+  void set_suppress_duplicates(bool suppress_duplicates);
+  bool get_suppress_duplicates() const;
+
+  // Performance sensors (all optional)
+  void set_frames_sent_sensor(esphome::sensor::Sensor *sensor);
+  void set_bytes_sent_sensor(esphome::sensor::Sensor *sensor);
+  void set_busy_time_sensor(esphome::sensor::Sensor *sensor);
+  void set_utilization_sensor(esphome::sensor::Sensor *sensor);
+  void set_queue_high_water_sensor(esphome::sensor::Sensor *sensor);
+  void set_latency_p50_sensor(esphome::sensor::Sensor *sensor);
+  void set_latency_p99_sensor(esphome::sensor::Sensor *sensor);
+
+  // Enqueue one pre-encoded frame of either protocol (false if it was dropped)
+  bool send_frame(uint8_t header, uint16_t word);
+  bool send_frame_repeated(uint8_t header, uint16_t word, uint8_t repetitions);
+  // Enqueue `count` frames under one lock, all or nothing; false if they do
+  // not fit in the free slots. They are sent in order and back to back,
+  // except that a halt or brake queued meanwhile goes out between them.
+  bool send_batch(const TMCCFrame *frames, size_t count);
 
-  // TMCC1 frame sending
-  void send_tmcc1_frame(uint16_t word);
-  void send_tmcc1_frame_repeated(uint16_t word, uint8_t repetitions);
+  // TMCC1 frame sending (enqueue and return; false if the frame was dropped)
+  bool send_tmcc1_frame(uint16_t word);
+  bool send_tmcc1_frame_repeated(uint16_t word, uint8_t repetitions);
+
+  // Legacy frame sending (requires LCS SER2/WiFi between the ESP32 and the base).
+  // send_tmcc2_frames() queues a multi-frame command that is sent back to back.
+  bool send_tmcc2_frame(uint8_t header, uint16_t word);
+  bool send_tmcc2_frames(const TMCCFrame *frames, size_t count);
+
+  // Streams: repeat a frame once per slot until the duration elapses or
+  // the stream is stopped. Starting an active stream again extends it.
+  bool start_stream(uint8_t header, uint16_t word, uint32_t duration_ms);
+  void stop_stream(uint8_t header, uint16_t word);
+  bool start_tmcc1_stream(uint16_t word, uint32_t duration_ms);
+  void stop_tmcc1_stream(uint16_t word);
 
   // Engine commands
   void engine_action_tmcc1(uint8_t address, TMCCEngineAction action);
   void engine_action_repeated_tmcc1(uint8_t address, TMCCEngineAction action, uint8_t repetitions);
+  bool engine_stream_tmcc1(uint8_t address, TMCCEngineAction action, uint32_t duration_ms);
+  void engine_stream_stop_tmcc1(uint8_t address, TMCCEngineAction action);
   void engine_speed_absolute_tmcc1(uint8_t address, uint8_t speed);
 
+  // Legacy engine commands
+  void engine_action_tmcc2(uint8_t address, TMCCEngineAction action);
+  bool engine_stream_tmcc2(uint8_t address, TMCCEngineAction action, uint32_t duration_ms);
+  void engine_stream_stop_tmcc2(uint8_t address, TMCCEngineAction action);
+  void engine_speed_absolute_tmcc2(uint8_t address, uint8_t speed);
+  void engine_parameter_tmcc2(uint8_t address, TMCC2ParameterIndex index, uint8_t data);
+
   // System commands
   void system_halt();  // Emergency stop - halts all trains
+  // System halt from a hardware e-stop task. Safe to call from any task:
+  // it does not log, and the halt callbacks run on the next loop().
+  // `pressed_us` is the micros() time of the press, for the latency.
+  void emergency_halt(uint32_t pressed_us);
 
   // Diagnostic commands
   void send_test_pattern();
   void send_raw_bytes(const uint8_t *data, size_t len);
+  void dump_trace();  // Log the contents of the trace ring, oldest first
+  // Record every command the writer task sends into `recording` until this
+  // is called with nullptr. The recording must not be read while attached.
+  void set_recording(TMCCRecording *recording);
+
+  // RX: `callback` is called on the main loop with the header and word of
+  // every frame received, except echoes of frames this bus just sent.
+  // Legacy frames arrive too; check the header.
+  void add_on_frame_callback(std::function<void(uint8_t, uint16_t)> &&callback);
+  // TX: `callback` is called with the header and word of every frame the
+  // queue accepts from send_*(), in the caller's context before it returns
+  // (the main loop for every sender in this component). Entities use it to
+  // follow commands that reach the wire without going through them:
+  // sequences, batches, the bridge and replay. Not called for
+  // emergency_halt(), whose halt callbacks run on loop().
+  void add_on_queued_callback(std::function<void(uint8_t, uint16_t)> &&callback);
+  // `callback` is called by system_halt() and, on the next loop(), after
+  // emergency_halt(), so ramps and sequences stop with the trains
+  void add_on_halt_callback(std::function<void()> &&callback);
+
+  // Queue statistics
+  uint32_t get_frames_dropped() const;
+  uint32_t get_frames_coalesced() const;
+  uint32_t get_frames_sent() const;
+  uint32_t get_frames_received() const;
+  uint32_t get_frames_echoed();  // Received frames that were our own echo
+  uint32_t get_bytes_sent() const;
+  // Free TX queue slots, for producers that apply backpressure
+  size_t get_queue_free();
+  // True when nothing is waiting to be sent
+  bool is_tx_idle();
+
+  // Halt latency: from system_halt() to the first halt frame on the wire
+  uint32_t get_halt_latency_last_us() const;
+  uint32_t get_halt_latency_max_us() const;
+  // E-stop latency: from the press to the first halt byte on the wire. The
+  // count increases with every measurement.
+  uint32_t get_emergency_latency_us() const;
+  uint32_t get_emergency_halt_count() const;
 
  protected:
-  esphome::uart::UARTComponent *uart_{nullptr};
+  TMCCTransport *transport_{nullptr};
+
+  // Enqueue an entry for the writer task. Assigns its priority, purges stale
+  // motion commands for halt/brake, and applies the drop policy when full.
+  bool enqueue_(TMCCTxEntry &entry);
+  // The work of enqueue_() for a caller that holds queue_lock_. `purged`
+  // is increased by the number of stale motion commands removed.
+  bool enqueue_locked_(TMCCTxEntry &entry, size_t *purged);
+
+#ifdef USE_API
+  // Home Assistant services
+  void on_send_words_service_(std::vector<int32_t> words);
+  void on_send_batch_service_(std::vector<int32_t> types, std::vector<int32_t> addresses,
+                              std::vector<int32_t> classes, std::vector<int32_t> data);
+#endif
+
+  // Writer task: drains tx_queue_ one frame at a time and performs the blocking writes
+  static void writer_task_(void *arg);
+  void transmit_frame_(const TMCCTxEntry &frame);
+  // Add a frame to the trace ring; caller holds queue_lock_
+  void record_trace_(TMCCTraceSource source, uint8_t header, uint16_t word, uint8_t repetitions);
+
+  // Receive task: parses bytes from the command base and queues complete words for loop()
+  static void rx_task_(void *arg);
+
+  TMCCTxQueue tx_queue_;
+  uint16_t queue_size_{16};
+  TMCCDropPolicy drop_policy_{TMCCDropPolicy::DROP_OLDEST};
+  uint16_t stream_interval_ms_{0};  // 0 = stream frames back-to-back when the wire is free
+  uint16_t frame_gap_ms_{0};
+  uint8_t burst_limit_{0};
+  uint16_t burst_pause_ms_{0};
+  std::atomic<bool> adaptive_pacing_{false};  // Cleared by loop() while the writer task reads it
+  uint16_t max_frame_gap_ms_{50};
+  uint8_t halt_repetitions_{10};
+  bool suppress_duplicates_{true};
+  TMCCRateController rate_;          // Guarded by queue_lock_
+  TMCCEchoFilter echo_filter_;       // Guarded by queue_lock_
+  TMCCTraceBuffer trace_buffer_;     // Guarded by queue_lock_
+  TMCCRecording *recording_{nullptr};  // Guarded by queue_lock_
+  uint16_t trace_size_{64};
+  uint32_t frames_dropped_{0};
+  uint32_t frames_coalesced_{0};  // Speed words overwritten before reaching the wire
+  uint32_t frames_sent_{0};       // Frames written by the writer task (under queue_lock_)
+  uint32_t halt_latency_last_us_{0};
+  uint32_t halt_latency_max_us_{0};
+
+  // Hardware e-stop state, shared between the e-stop task, the writer task
+  // and loop()
+  std::atomic<bool> emergency_halt_pending_{false};   // Halt callbacks still to run on loop()
+  std::atomic<bool> emergency_latency_pending_{false};  // First halt frame not yet written
+  std::atomic<uint32_t> emergency_pressed_us_{0};
+  std::atomic<uint32_t> emergency_latency_us_{0};
+  std::atomic<uint32_t> emergency_halt_count_{0};
+
+  // Wire statistics. bytes_sent_ is updated under write_lock_. The writer
+  // task adds to busy_us_ and the latency samples under queue_lock_, and
+  // update() reads them and resets the per-interval values under it too.
+  uint32_t bytes_sent_{0};
+  uint32_t busy_us_{0};               // Time spent writing and flushing frames (wraps; used as deltas)
+  size_t queue_high_water_{0};        // Deepest queue since the last update()
+  uint32_t latency_samples_[TMCC_LATENCY_SAMPLE_COUNT];  // Ring of the latest command latencies (us)
+  uint32_t latency_sample_count_{0};  // Samples recorded since the last update()
+  uint32_t last_update_us_{0};
+  uint32_t last_busy_us_{0};
+
+  esphome::sensor::Sensor *frames_sent_sensor_{nullptr};
+  esphome::sensor::Sensor *bytes_sent_sensor_{nullptr};
+  esphome::sensor::Sensor *busy_time_sensor_{nullptr};
+  esphome::sensor::Sensor *utilization_sensor_{nullptr};
+  esphome::sensor::Sensor *queue_high_water_sensor_{nullptr};
+  esphome::sensor::Sensor *latency_p50_sensor_{nullptr};
+  esphome::sensor::Sensor *latency_p99_sensor_{nullptr};
+
+  SemaphoreHandle_t queue_lock_{nullptr};  // Guards tx_queue_ and its counters
+  SemaphoreHandle_t write_lock_{nullptr};  // Serialises transport writes (writer task vs raw/test writes)
+  TaskHandle_t writer_task_handle_{nullptr};
+
+  TMCCFrameParser rx_parser_;         // Owned by the receive task
+  QueueHandle_t rx_queue_{nullptr};   // Received frames, receive task -> main loop
+  TaskHandle_t rx_task_handle_{nullptr};
+  uint32_t frames_received_{0};
+  std::atomic<uint32_t> rx_overflows_{0};  // Frames lost because loop() fell behind
+  esphome::CallbackManager<void(uint8_t, uint16_t)> frame_callback_;
+  esphome::CallbackManager<void(uint8_t, uint16_t)> queued_callback_;
+  esphome::CallbackManager<void()> halt_callback_;
 
   // Helper to format byte as binary string for logging
   static void format_binary(uint8_t byte, char *buffer);
@@ -0,0 +1,38 @@
+#include "tmcc_accessory.h"
+#include "esphome/core/log.h"
+
+namespace tmcc {
+
+static const char *const TAG = "tmcc.accessory";
+
+void TMCCAccessory::dump_config() {
+  LOG_SWITCH("", "TMCC Accessory", this);
+  ESP_LOGCONFIG(TAG, "  Address: %u", this->address_);
+}
+
+void TMCCAccessory::set_bus(TMCCBus *bus) {
+  this->bus_ = bus;
+}
+
+void TMCCAccessory::set_address(uint8_t address) {
+  this->address_ = address & 0x7F;  // Mask to 7 bits
+}
+
+uint8_t TMCCAccessory::get_address() const {
+  return this->address_;
+}
+
+void TMCCAccessory::send_action(TMCCAccessoryAction action) {
+  if (this->bus_ == nullptr) {
+    return;
+  }
+  TMCC_LOG_FRAME(TAG, "action: address=%u action=%u", this->address_, static_cast<uint8_t>(action));
+  this->bus_->send_frame(TMCC1_HEADER, tmcc_accessory_word(this->address_, action));
+}
+
+void TMCCAccessory::write_state(bool state) {
+  this->send_action(state ? TMCCAccessoryAction::AUX1_ON : TMCCAccessoryAction::AUX1_OFF);
+  this->publish_state(state);
+}
+
+}  // namespace tmcc
@@ -0,0 +1,31 @@
+#pragma once
+
+#include "esphome/core/component.h"
+#include "esphome/components/switch/switch.h"
+#include "tmcc.h"
+
+namespace tmcc {
+
+/**
+ * TMCCAccessory - A TMCC accessory (ASC/AC output) as a Switch entity.
+ * ON sends AUX1 On, OFF sends AUX1 Off.
+ */
+class TMCCAccessory : public esphome::switch_::Switch, public esphome::Component {
+ public:
+  void dump_config() override;
+
+  void set_bus(TMCCBus *bus);
+  void set_address(uint8_t address);
+  uint8_t get_address() const;
+
+  // Send any accessory action, e.g. AUX2 for a second output
+  void send_action(TMCCAccessoryAction action);
+
+ protected:
+  void write_state(bool state) override;
+
+  TMCCBus *bus_{nullptr};
+  uint8_t address_{1};
+};
+
+}  // namespace tmcc
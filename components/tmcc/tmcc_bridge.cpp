@@ -0,0 +1,160 @@
+#include "tmcc_bridge.h"
+
+#ifdef USE_TMCC_BRIDGE
+
+#include <algorithm>
+
+#include "esphome/core/log.h"
+
+namespace tmcc {
+
+static const char *const TAG = "tmcc.bridge";
+
+void TMCCBridge::setup() {
+  if (this->bus_ == nullptr) {
+    ESP_LOGE(TAG, "TMCCBus not configured!");
+    this->mark_failed();
+    return;
+  }
+
+  this->server_ = esphome::socket::socket_ip(SOCK_STREAM, 0);
+  if (this->server_ == nullptr) {
+    ESP_LOGE(TAG, "Could not create socket");
+    this->mark_failed();
+    return;
+  }
+  int enable = 1;
+  this->server_->setsockopt(SOL_SOCKET, SO_REUSEADDR, &enable, sizeof(enable));
+  this->server_->setblocking(false);
+
+  struct sockaddr_storage server_addr;
+  socklen_t addr_len = esphome::socket::set_sockaddr_any(reinterpret_cast<struct sockaddr *>(&server_addr),
+                                                         sizeof(server_addr), this->port_);
+  if (this->server_->bind(reinterpret_cast<struct sockaddr *>(&server_addr), addr_len) != 0 ||
+      this->server_->listen(1) != 0) {
+    ESP_LOGE(TAG, "Could not listen on port %u: errno %d", this->port_, errno);
+    this->server_ = nullptr;
+    this->mark_failed();
+    return;
+  }
+
+  this->bus_->add_on_frame_callback([this](uint8_t header, uint16_t word) { this->forward_(header, word); });
+}
+
+void TMCCBridge::loop() {
+  if (this->server_ == nullptr) {
+    return;
+  }
+  this->accept_();
+  if (this->client_ != nullptr) {
+    this->read_();
+  }
+}
+
+void TMCCBridge::dump_config() {
+  ESP_LOGCONFIG(TAG, "TMCC Bridge:");
+  ESP_LOGCONFIG(TAG, "  Port: %u", this->port_);
+  ESP_LOGCONFIG(TAG, "  Frames: %u from client (%u not queued), %u to client (%u not forwarded)",
+                this->frames_from_client_, this->frames_not_queued_, this->frames_to_client_,
+                this->frames_not_forwarded_);
+  ESP_LOGCONFIG(TAG, "  Stray Bytes: %u", this->parser_.get_discarded_bytes());
+}
+
+float TMCCBridge::get_setup_priority() const {
+  return esphome::setup_priority::AFTER_WIFI;
+}
+
+void TMCCBridge::set_bus(TMCCBus *bus) {
+  this->bus_ = bus;
+}
+
+void TMCCBridge::set_port(uint16_t port) {
+  this->port_ = port;
+}
+
+void TMCCBridge::accept_() {
+  struct sockaddr_storage client_addr;
+  socklen_t addr_len = sizeof(client_addr);
+  auto client = this->server_->accept(reinterpret_cast<struct sockaddr *>(&client_addr), &addr_len);
+  if (client == nullptr) {
+    return;
+  }
+
+  // The newest client wins: a PC program that crashed and reconnected
+  // must not be locked out by its own dead connection.
+  if (this->client_ != nullptr) {
+    ESP_LOGW(TAG, "Replacing client %s", this->client_->getpeername().c_str());
+    this->close_client_();
+  }
+  client->setblocking(false);
+  int enable = 1;
+  client->setsockopt(IPPROTO_TCP, TCP_NODELAY, &enable, sizeof(enable));
+  this->client_ = std::move(client);
+  this->parser_.reset();
+  ESP_LOGI(TAG, "Client %s connected", this->client_->getpeername().c_str());
+}
+
+void TMCCBridge::read_() {
+  // Read only what the TX queue can take. A partial frame held by the
+  // parser still completes into at most `free` frames.
+  size_t free_slots = this->bus_->get_queue_free();
+  size_t len = std::min(TMCC_BRIDGE_READ_SIZE, free_slots * TMCC_FRAME_SIZE);
+  if (len == 0) {
+    return;
+  }
+
+  uint8_t buffer[TMCC_BRIDGE_READ_SIZE];
+  ssize_t received = this->client_->read(buffer, len);
+  if (received == 0) {
+    ESP_LOGI(TAG, "Client disconnected");
+    this->close_client_();
+    return;
+  }
+  if (received < 0) {
+    if (errno != EWOULDBLOCK && errno != EAGAIN) {
+      ESP_LOGW(TAG, "Client read failed: errno %d", errno);
+      this->close_client_();
+    }
+    return;
+  }
+
+  TMCCFrame frames[TMCC_BRIDGE_READ_SIZE / TMCC_FRAME_SIZE];
+  size_t count = 0;
+  for (ssize_t i = 0; i < received; i++) {
+    if (this->parser_.feed(buffer[i], &frames[count])) {
+      count++;
+    }
+  }
+  if (count == 0) {
+    return;
+  }
+  if (this->bus_->send_batch(frames, count)) {
+    this->frames_from_client_ += count;
+  } else {
+    // Another sender filled the free slots first, or the bus is not ready
+    this->frames_not_queued_ += count;
+    ESP_LOGW(TAG, "Dropped %zu frames from the client", count);
+  }
+}
+
+void TMCCBridge::close_client_() {
+  this->client_->close();
+  this->client_ = nullptr;
+}
+
+void TMCCBridge::forward_(uint8_t header, uint16_t word) {
+  if (this->client_ == nullptr) {
+    return;
+  }
+  const uint8_t frame[TMCC_FRAME_SIZE] = {header, static_cast<uint8_t>(word >> 8), static_cast<uint8_t>(word & 0xFF)};
+  // Never block loop() on a slow client; a frame it cannot take is dropped
+  if (this->client_->write(frame, sizeof(frame)) == static_cast<ssize_t>(sizeof(frame))) {
+    this->frames_to_client_++;
+  } else {
+    this->frames_not_forwarded_++;
+  }
+}
+
+}  // namespace tmcc
+
+#endif  // USE_TMCC_BRIDGE
@@ -0,0 +1,64 @@
+#pragma once
+
+#include "esphome/core/defines.h"
+
+#ifdef USE_TMCC_BRIDGE
+
+#include <memory>
+
+#include "esphome/core/component.h"
+#include "esphome/components/socket/socket.h"
+#include "tmcc.h"
+#include "tmcc_parser.h"
+
+namespace tmcc {
+
+// Bytes read from the client per loop(); 32 frames is ~100 ms of wire time
+static constexpr size_t TMCC_BRIDGE_READ_SIZE = 96;
+
+/**
+ * TMCCBridge - Raw TCP bridge to the command base, in the style of ser2net.
+ *
+ * One client at a time connects to the listening port and streams raw
+ * TMCC1 (0xFE) and Legacy (0xF8, 0xF9, 0xFB) frames. Bytes are re-framed
+ * with TMCCFrameParser, so a frame split across two reads is joined and
+ * stray bytes are dropped at frame boundaries.
+ * Complete frames are queued with TMCCBus::send_batch() and share the
+ * priority, coalescing and halt handling of every other sender. Frames
+ * received from the command base are written back to the client.
+ *
+ * The socket is non-blocking and serviced from loop(). The bridge reads
+ * no more frames than the TX queue has room for, so a fast client is held
+ * back by TCP flow control instead of having frames dropped.
+ */
+class TMCCBridge : public esphome::Component {
+ public:
+  void setup() override;
+  void loop() override;
+  void dump_config() override;
+  float get_setup_priority() const override;
+
+  void set_bus(TMCCBus *bus);
+  void set_port(uint16_t port);
+
+ protected:
+  void accept_();
+  void read_();
+  void close_client_();
+  // Bus frame callback: forward a received frame to the client
+  void forward_(uint8_t header, uint16_t word);
+
+  TMCCBus *bus_{nullptr};
+  uint16_t port_{5000};
+  std::unique_ptr<esphome::socket::Socket> server_;
+  std::unique_ptr<esphome::socket::Socket> client_;
+  TMCCFrameParser parser_;
+  uint32_t frames_from_client_{0};
+  uint32_t frames_not_queued_{0};     // The bus rejected their batch
+  uint32_t frames_to_client_{0};
+  uint32_t frames_not_forwarded_{0};  // Client could not take them
+};
+
+}  // namespace tmcc
+
+#endif  // USE_TMCC_BRIDGE
@@ -0,0 +1,187 @@
+#include "tmcc_cab.h"
+#include "esphome/core/log.h"
+
+#include <cstring>
+
+namespace tmcc {
+
+static const char *const TAG = "tmcc.cab";
+
+// ============================================================================
+// TMCCCab implementation
+// ============================================================================
+
+void TMCCCab::setup() {
+  if (this->roster_size_ == 0) {
+    ESP_LOGE(TAG, "Cab has an empty roster!");
+    this->mark_failed();
+    return;
+  }
+  // Nothing is known about any engine until it is commanded or seen on RX
+  this->states_.reset(new TMCCCabState[this->roster_size_]);
+  for (size_t i = 0; i < this->roster_size_; i++) {
+    this->states_[i] = TMCCCabState{0, STATE_FORWARD};
+  }
+  this->load_entry_(0);
+
+  TMCCEngine::setup();
+  if (this->bus_ != nullptr) {
+    this->bus_->add_on_frame_callback([this](uint8_t header, uint16_t word) {
+      if (header == TMCC1_HEADER) {
+        this->on_roster_frame_(word);
+      }
+    });
+    // The cab's own frames are for the active engine, which the roster skips
+    this->bus_->add_on_queued_callback([this](uint8_t header, uint16_t word) {
+      if (header == TMCC1_HEADER) {
+        this->on_roster_frame_(word);
+      }
+    });
+    this->bus_->add_on_halt_callback([this]() { this->on_roster_halt_(); });
+  }
+}
+
+void TMCCCab::dump_config() {
+  ESP_LOGCONFIG(TAG, "TMCC Cab:");
+  ESP_LOGCONFIG(TAG, "  Roster: %zu engines", this->roster_size_);
+  if (this->roster_size_ != 0) {
+    ESP_LOGCONFIG(TAG, "  Active: %s (address %u)", this->roster_[this->active_].name, this->address_);
+  }
+  ESP_LOGCONFIG(TAG, "  Acceleration: %u steps/s", this->acceleration_);
+  ESP_LOGCONFIG(TAG, "  Deceleration: %u steps/s", this->deceleration_);
+}
+
+void TMCCCab::set_roster(const TMCCCabEntry *roster, size_t size) {
+  this->roster_ = roster;
+  this->roster_size_ = size;
+}
+
+void TMCCCab::set_select(TMCCCabSelect *select) {
+  this->select_ = select;
+}
+
+void TMCCCab::select_engine(size_t index) {
+  if (this->states_ == nullptr || index >= this->roster_size_) {
+    return;
+  }
+  if (index != this->active_) {
+    this->save_state_();
+    this->load_entry_(index);
+    ESP_LOGD(TAG, "Cab now drives %s (address %u)", this->roster_[index].name, this->address_);
+  } else if (this->select_ != nullptr) {
+    this->select_->publish_state(this->roster_[index].name);
+  }
+}
+
+void TMCCCab::select_engine(const std::string &name) {
+  for (size_t i = 0; i < this->roster_size_; i++) {
+    if (std::strcmp(this->roster_[i].name, name.c_str()) == 0) {
+      this->select_engine(i);
+      return;
+    }
+  }
+  ESP_LOGW(TAG, "No engine named '%s' in the roster", name.c_str());
+}
+
+size_t TMCCCab::get_active_index() const {
+  return this->active_;
+}
+
+void TMCCCab::on_roster_frame_(uint16_t word) {
+  // The active engine is followed by TMCCEngine::on_frame_
+  TMCCDecodedWord decoded;
+  if (!tmcc_decode_word(word, &decoded) || decoded.type != TMCCObjectType::ENGINE ||
+      decoded.address == this->address_) {
+    return;
+  }
+  for (size_t i = 0; i < this->roster_size_; i++) {
+    const TMCCCabEntry &entry = this->roster_[i];
+    if (entry.address != decoded.address) {
+      continue;
+    }
+    TMCCCabState &state = this->states_[i];
+    if (decoded.cmd_class == TMCCCommandClass::ABSOLUTE_SPEED) {
+      // A TMCC1 speed step does not map onto the 200-step Legacy scale
+      if (entry.protocol == TMCCProtocol::TMCC1) {
+        state.speed = decoded.data;
+        state.flags |= STATE_SPEED_KNOWN;
+      }
+    } else if (decoded.cmd_class == TMCCCommandClass::ACTION) {
+      switch (static_cast<TMCCEngineAction>(decoded.data)) {
+        case TMCCEngineAction::FORWARD:
+          state.flags |= STATE_FORWARD | STATE_DIRECTION_KNOWN;
+          break;
+        case TMCCEngineAction::REVERSE:
+          state.flags = (state.flags & ~STATE_FORWARD) | STATE_DIRECTION_KNOWN;
+          break;
+        case TMCCEngineAction::TOGGLE_DIRECTION:
+          state.flags ^= STATE_FORWARD;
+          break;
+        default:
+          break;
+      }
+    }
+    return;
+  }
+}
+
+void TMCCCab::on_roster_halt_() {
+  for (size_t i = 0; i < this->roster_size_; i++) {
+    this->states_[i].speed = 0;
+    this->states_[i].flags |= STATE_SPEED_KNOWN;
+  }
+}
+
+void TMCCCab::save_state_() {
+  TMCCCabState &state = this->states_[this->active_];
+  state.speed = this->current_speed_;
+  state.flags = (this->forward_ ? STATE_FORWARD : 0) | (this->speed_known_ ? STATE_SPEED_KNOWN : 0) |
+                (this->direction_known_ ? STATE_DIRECTION_KNOWN : 0);
+}
+
+void TMCCCab::load_entry_(size_t index) {
+  const TMCCCabEntry &entry = this->roster_[index];
+  const TMCCCabState &state = this->states_[index];
+
+  // The old engine keeps whatever speed the ramp had reached. Its horn,
+  // held or playing a signal, is stopped while frames_ still address it.
+  this->stop_ramp_();
+  this->stop_horn();
+  this->stop_horn_pattern();
+  this->active_ = index;
+  this->set_protocol(entry.protocol);
+  this->set_address(entry.address);
+  this->set_max_speed(entry.max_speed);
+
+  this->current_speed_ = state.speed;
+  this->target_speed_ = state.speed;
+  this->forward_ = (state.flags & STATE_FORWARD) != 0;
+  this->speed_known_ = (state.flags & STATE_SPEED_KNOWN) != 0;
+  this->direction_known_ = (state.flags & STATE_DIRECTION_KNOWN) != 0;
+
+  if (this->speed_number_ != nullptr) {
+    this->speed_number_->publish_state(state.speed);
+  }
+  if (this->direction_switch_ != nullptr) {
+    this->direction_switch_->publish_state(this->forward_);
+  }
+  if (this->select_ != nullptr) {
+    this->select_->publish_state(entry.name);
+  }
+}
+
+// ============================================================================
+// TMCCCabSelect implementation
+// ============================================================================
+
+void TMCCCabSelect::set_cab(TMCCCab *cab) {
+  this->cab_ = cab;
+}
+
+void TMCCCabSelect::control(const std::string &value) {
+  if (this->cab_ != nullptr) {
+    this->cab_->select_engine(value);
+  }
+}
+
+}  // namespace tmcc
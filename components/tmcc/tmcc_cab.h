@@ -0,0 +1,91 @@
+#pragma once
+
+#include <memory>
+#include <string>
+
+#include "esphome/core/component.h"
+#include "esphome/components/select/select.h"
+#include "tmcc_engine.h"
+
+namespace tmcc {
+
+/**
+ * One engine in a cab's roster. Rosters are generated as static const
+ * arrays, so they live in flash.
+ */
+struct TMCCCabEntry {
+  const char *name;
+  uint8_t address;
+  uint8_t max_speed;
+  TMCCProtocol protocol;
+};
+
+/**
+ * Shadow state kept for every roster engine while another one is active.
+ */
+struct TMCCCabState {
+  uint8_t speed;
+  uint8_t flags;  // TMCCCab::STATE_* bits
+};
+
+class TMCCCabSelect;
+
+/**
+ * TMCCCab - One set of engine entities driving any engine of a roster.
+ *
+ * Like a CAB-1 handheld, the cab has a single speed, direction and button
+ * set and a select that picks the engine they drive. Selecting an engine
+ * retargets the cab at once: its frames are re-encoded for the new address
+ * and protocol, and the speed and direction it was last given (or last
+ * seen on RX) are published back to the entities. A running ramp stops
+ * where it is, and a held horn or horn signal stops, when the cab moves to
+ * another engine.
+ *
+ * Entities and components do not grow with the roster; each roster engine
+ * costs its flash entry and two bytes of shadow state.
+ */
+class TMCCCab : public TMCCEngine {
+ public:
+  static constexpr uint8_t STATE_FORWARD = 1 << 0;
+  static constexpr uint8_t STATE_SPEED_KNOWN = 1 << 1;
+  static constexpr uint8_t STATE_DIRECTION_KNOWN = 1 << 2;
+
+  void setup() override;
+  void dump_config() override;
+
+  void set_roster(const TMCCCabEntry *roster, size_t size);
+  void set_select(TMCCCabSelect *select);
+
+  // Drive another roster engine; unknown names are ignored
+  void select_engine(size_t index);
+  void select_engine(const std::string &name);
+  size_t get_active_index() const;
+
+ protected:
+  // Keep the shadow state of the engines that are not active
+  void on_roster_frame_(uint16_t word);
+  void on_roster_halt_();
+
+  void save_state_();
+  void load_entry_(size_t index);
+
+  const TMCCCabEntry *roster_{nullptr};
+  size_t roster_size_{0};
+  std::unique_ptr<TMCCCabState[]> states_;
+  size_t active_{0};
+  TMCCCabSelect *select_{nullptr};
+};
+
+/**
+ * Select that picks the cab's active engine. Not a Component.
+ */
+class TMCCCabSelect : public esphome::select::Select {
+ public:
+  void set_cab(TMCCCab *cab);
+
+ protected:
+  void control(const std::string &value) override;
+  TMCCCab *cab_{nullptr};
+};
+
+}  // namespace tmcc
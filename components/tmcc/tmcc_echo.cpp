@@ -0,0 +1,42 @@
+#include "tmcc_echo.h"
+
+namespace tmcc {
+
+void TMCCEchoFilter::on_sent(uint8_t header, uint16_t word, uint32_t now_ms) {
+  if (this->count_ == TMCC_ECHO_RING_SIZE) {
+    this->head_ = (this->head_ + 1) % TMCC_ECHO_RING_SIZE;
+    this->count_--;
+  }
+  size_t index = (this->head_ + this->count_) % TMCC_ECHO_RING_SIZE;
+  this->sent_[index] = Sent{now_ms, word, header, false};
+  this->count_++;
+}
+
+bool TMCCEchoFilter::is_echo(uint8_t header, uint16_t word, uint32_t now_ms) {
+  // Drop frames whose echo is overdue or already seen from the old end
+  while (this->count_ > 0) {
+    const Sent &oldest = this->sent_[this->head_];
+    if (!oldest.echoed && now_ms - oldest.sent_ms <= TMCC_ECHO_TIMEOUT_MS) {
+      break;
+    }
+    this->head_ = (this->head_ + 1) % TMCC_ECHO_RING_SIZE;
+    this->count_--;
+  }
+  // Repeated frames carry the same word, so match the oldest one still waiting
+  for (size_t i = 0; i < this->count_; i++) {
+    Sent &sent = this->sent_[(this->head_ + i) % TMCC_ECHO_RING_SIZE];
+    if (!sent.echoed && sent.header == header && sent.word == word &&
+        now_ms - sent.sent_ms <= TMCC_ECHO_TIMEOUT_MS) {
+      sent.echoed = true;
+      this->echoes_++;
+      return true;
+    }
+  }
+  return false;
+}
+
+uint32_t TMCCEchoFilter::get_echoes() const {
+  return this->echoes_;
+}
+
+}  // namespace tmcc
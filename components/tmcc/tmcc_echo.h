@@ -0,0 +1,53 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace tmcc {
+
+// Sent frames remembered while their echo may still come back
+static constexpr size_t TMCC_ECHO_RING_SIZE = 32;
+// A matching frame received later than this is taken for a new command
+static constexpr uint32_t TMCC_ECHO_TIMEOUT_MS = 500;
+
+/**
+ * TMCCEchoFilter - Recognises received frames that are our own echo.
+ *
+ * A command base that repeats what it puts on the track sends every frame
+ * we write straight back. Fed to the engines as if another controller had
+ * sent it, a stale echo would overwrite shadow state that has moved on
+ * (a ramp step echoed after the next step went out cancels the ramp).
+ * Each sent frame is remembered until a received frame with the same
+ * header and word consumes it, or the timeout passes. Once the ring is
+ * full the oldest frame is forgotten.
+ *
+ * Plain C++ with no locking; the owner serialises calls.
+ */
+class TMCCEchoFilter {
+ public:
+  TMCCEchoFilter() = default;
+
+  // A frame went out on the wire
+  void on_sent(uint8_t header, uint16_t word, uint32_t now_ms);
+  // A frame was received. Returns true if it echoes a frame sent within the
+  // timeout; that frame is then forgotten, so each send matches one echo.
+  bool is_echo(uint8_t header, uint16_t word, uint32_t now_ms);
+
+  // Received frames recognised as echoes
+  uint32_t get_echoes() const;
+
+ protected:
+  struct Sent {
+    uint32_t sent_ms;
+    uint16_t word;
+    uint8_t header;
+    bool echoed;
+  };
+
+  Sent sent_[TMCC_ECHO_RING_SIZE]{};
+  size_t head_{0};  // Oldest remembered frame
+  size_t count_{0};
+  uint32_t echoes_{0};
+};
+
+}  // namespace tmcc
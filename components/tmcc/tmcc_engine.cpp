@@ -5,6 +5,15 @@ namespace tmcc {
 
 static const char *const TAG = "tmcc.engine";
 
+// Longest a held horn may sound if stop_horn() never arrives
+static const uint32_t HORN_HOLD_LIMIT_MS = 10000;
+
+// Shortest time between ramp steps. Faster rates take bigger steps instead,
+// so a ramp never sends more than 20 speed frames per second.
+static const uint32_t RAMP_MIN_INTERVAL_MS = 50;
+static const char *const RAMP_INTERVAL_NAME = "ramp";
+static const char *const HORN_PATTERN_TIMEOUT_NAME = "horn_pattern";
+
 // ============================================================================
 // TMCCEngine implementation
 // ============================================================================
@@ -13,102 +22,425 @@ void TMCCEngine::setup() {
   ESP_LOGCONFIG(TAG, "Setting up TMCC Engine...");
   if (this->bus_ == nullptr) {
     ESP_LOGE(TAG, "TMCCBus not configured!");
+    return;
+  }
+  this->bus_->add_on_frame_callback([this](uint8_t header, uint16_t word) {
+    // Legacy frames use another word layout; tmcc_decode_word() reads TMCC1 only
+    if (header == TMCC1_HEADER) {
+      this->on_frame_(word);
+    }
+  });
+  this->bus_->add_on_queued_callback([this](uint8_t header, uint16_t word) {
+    // Our own frames updated the state before they were sent, and a queued
+    // halt reaches on_halt_() through the halt callback
+    if (header == TMCC1_HEADER && !this->sending_ && word != TMCC1_SYSTEM_HALT_WORD) {
+      this->on_frame_(word);
+    }
+  });
+  this->bus_->add_on_halt_callback([this]() { this->on_halt_(); });
+}
+
+void TMCCEngine::on_frame_(uint16_t word) {
+  if (word == TMCC1_SYSTEM_HALT_WORD) {
+    // System Halt stops every engine
+    this->on_halt_();
+    return;
+  }
+
+  TMCCDecodedWord decoded;
+  if (!tmcc_decode_word(word, &decoded) || decoded.type != this->object_type_ ||
+      decoded.address != this->address_) {
+    return;
+  }
+
+  if (decoded.cmd_class == TMCCCommandClass::ABSOLUTE_SPEED) {
+    if (this->protocol_ == TMCCProtocol::LEGACY) {
+      // A TMCC1 speed step does not map onto the 200-step Legacy scale
+      return;
+    }
+    TMCC_LOG_FRAME(TAG, "Seen speed: address=%u speed=%u", this->address_, decoded.data);
+    // Someone else set the speed; it overrides any ramp in progress
+    this->stop_ramp_();
+    this->current_speed_ = decoded.data;
+    this->target_speed_ = decoded.data;
+    this->speed_known_ = true;
+    if (this->speed_number_ != nullptr) {
+      this->speed_number_->publish_state(decoded.data);
+    }
+    return;
+  }
+
+  if (decoded.cmd_class != TMCCCommandClass::ACTION) {
+    return;
+  }
+  switch (static_cast<TMCCEngineAction>(decoded.data)) {
+    case TMCCEngineAction::FORWARD:
+      this->forward_ = true;
+      this->direction_known_ = true;
+      break;
+    case TMCCEngineAction::REVERSE:
+      this->forward_ = false;
+      this->direction_known_ = true;
+      break;
+    case TMCCEngineAction::TOGGLE_DIRECTION:
+      this->forward_ = !this->forward_;
+      break;
+    default:
+      return;
+  }
+  TMCC_LOG_FRAME(TAG, "Seen direction: address=%u forward=%s", this->address_, this->forward_ ? "true" : "false");
+  if (this->direction_switch_ != nullptr) {
+    this->direction_switch_->publish_state(this->forward_);
+  }
+}
+
+void TMCCEngine::on_halt_() {
+  this->stop_ramp_();
+  this->stop_horn_pattern();
+  this->current_speed_ = 0;
+  this->target_speed_ = 0;
+  this->speed_known_ = true;
+  if (this->speed_number_ != nullptr) {
+    this->speed_number_->publish_state(0);
   }
 }
 
 void TMCCEngine::dump_config() {
   ESP_LOGCONFIG(TAG, "TMCC Engine:");
   ESP_LOGCONFIG(TAG, "  Address: %u", this->address_);
+  ESP_LOGCONFIG(TAG, "  Protocol: %s", this->protocol_ == TMCCProtocol::LEGACY ? "Legacy" : "TMCC1");
   ESP_LOGCONFIG(TAG, "  Max Speed: %u", this->max_speed_);
+  ESP_LOGCONFIG(TAG, "  Horn Duration: %u ms", this->horn_duration_ms_);
+  ESP_LOGCONFIG(TAG, "  Acceleration: %u steps/s", this->acceleration_);
+  ESP_LOGCONFIG(TAG, "  Deceleration: %u steps/s", this->deceleration_);
 }
 
 float TMCCEngine::get_setup_priority() const {
   return esphome::setup_priority::DATA;
 }
 
+TMCCEngine::TMCCEngine() {
+  this->build_frames_();
+}
+
 void TMCCEngine::set_bus(TMCCBus *bus) {
   this->bus_ = bus;
 }
 
 void TMCCEngine::set_address(uint8_t address) {
   this->address_ = address & 0x7F;  // Mask to 7 bits
+  this->build_frames_();
 }
 
 void TMCCEngine::set_max_speed(uint8_t max_speed) {
-  if (max_speed > 31) {
-    max_speed = 31;
+  uint8_t limit = (this->protocol_ == TMCCProtocol::LEGACY) ? TMCC2_MAX_SPEED : 31;
+  if (max_speed > limit) {
+    max_speed = limit;
   }
   this->max_speed_ = max_speed;
 }
 
+void TMCCEngine::set_protocol(TMCCProtocol protocol) {
+  this->protocol_ = protocol;
+  this->build_frames_();
+}
+
+void TMCCEngine::set_horn_duration(uint32_t horn_duration_ms) {
+  this->horn_duration_ms_ = horn_duration_ms;
+}
+
+void TMCCEngine::set_acceleration(uint16_t acceleration) {
+  this->acceleration_ = acceleration;
+}
+
+void TMCCEngine::set_deceleration(uint16_t deceleration) {
+  this->deceleration_ = deceleration;
+}
+
+void TMCCEngine::set_speed_number(TMCCEngineSpeed *speed_number) {
+  this->speed_number_ = speed_number;
+}
+
+void TMCCEngine::set_direction_switch(TMCCEngineDirection *direction_switch) {
+  this->direction_switch_ = direction_switch;
+}
+
 void TMCCEngine::set_speed(uint8_t speed) {
   if (speed > this->max_speed_) {
     speed = this->max_speed_;
   }
+  this->target_speed_ = speed;
+  if (this->speed_number_ != nullptr) {
+    this->speed_number_->publish_state(speed);
+  }
+  if (speed == this->current_speed_ && this->speed_known_ && this->suppress_duplicates_()) {
+    this->stop_ramp_();
+    return;
+  }
+
+  // There is nothing to ramp from while the engine's speed is unknown
+  uint16_t rate = (speed > this->current_speed_) ? this->acceleration_ : this->deceleration_;
+  if (rate == 0 || !this->speed_known_ || this->bus_ == nullptr) {
+    this->stop_ramp_();
+    this->send_speed_(speed);
+    return;
+  }
+  // A new target mid-ramp just moves the goal; the running ramp follows it
+  if (rate != this->ramp_rate_) {
+    this->start_ramp_(rate);
+  }
+}
+
+void TMCCEngine::start_ramp_(uint16_t rate) {
+  // Step size and period that give `rate` steps per second without
+  // stepping more often than RAMP_MIN_INTERVAL_MS
+  uint32_t step = (rate * RAMP_MIN_INTERVAL_MS + 999) / 1000;
+  this->ramp_step_size_ = static_cast<uint8_t>(step > 255 ? 255 : step);
+  this->ramp_rate_ = rate;
+  this->ramp_step_();
+  if (this->ramp_rate_ != 0) {
+    this->set_interval(RAMP_INTERVAL_NAME, this->ramp_step_size_ * 1000 / rate, [this]() { this->ramp_step_(); });
+  }
+}
+
+void TMCCEngine::ramp_step_() {
+  uint8_t speed = this->current_speed_;
+  if (this->target_speed_ > speed) {
+    speed = (this->target_speed_ - speed > this->ramp_step_size_) ? speed + this->ramp_step_size_ : this->target_speed_;
+  } else {
+    speed = (speed - this->target_speed_ > this->ramp_step_size_) ? speed - this->ramp_step_size_ : this->target_speed_;
+  }
+  this->send_speed_(speed);
+  if (speed == this->target_speed_) {
+    this->stop_ramp_();
+  }
+}
+
+void TMCCEngine::stop_ramp_() {
+  if (this->ramp_rate_ != 0) {
+    this->cancel_interval(RAMP_INTERVAL_NAME);
+    this->ramp_rate_ = 0;
+  }
+}
+
+void TMCCEngine::send_speed_(uint8_t speed) {
   this->current_speed_ = speed;
+  this->speed_known_ = true;
   if (this->bus_ != nullptr) {
-    this->bus_->engine_speed_absolute_tmcc1(this->address_, speed);
+    // speed <= max_speed_, which set_max_speed() keeps within the protocol's range
+    this->send_frame_(this->frames_.speed_base | speed);
   }
 }
 
 void TMCCEngine::set_direction_forward() {
-  this->forward_ = true;
-  if (this->bus_ != nullptr) {
-    this->bus_->engine_action_tmcc1(this->address_, TMCCEngineAction::FORWARD);
-  }
+  this->set_direction_(true);
 }
 
 void TMCCEngine::set_direction_reverse() {
-  this->forward_ = false;
+  this->set_direction_(false);
+}
+
+void TMCCEngine::set_direction_(bool forward) {
+  if (forward == this->forward_ && this->direction_known_ && this->suppress_duplicates_()) {
+    return;
+  }
+  this->forward_ = forward;
+  this->direction_known_ = true;
   if (this->bus_ != nullptr) {
-    this->bus_->engine_action_tmcc1(this->address_, TMCCEngineAction::REVERSE);
+    this->send_action_(forward ? TMCCEngineAction::FORWARD : TMCCEngineAction::REVERSE);
+  }
+}
+
+bool TMCCEngine::suppress_duplicates_() const {
+  return this->bus_ != nullptr && this->bus_->get_suppress_duplicates();
+}
+
+bool TMCCEngine::refresh_speed() {
+  if (this->bus_ == nullptr || !this->speed_known_ || this->ramp_rate_ != 0) {
+    return false;
+  }
+  return this->send_frame_(this->frames_.speed_base | this->current_speed_);
+}
+
+bool TMCCEngine::refresh_direction() {
+  if (this->bus_ == nullptr || !this->direction_known_) {
+    return false;
   }
+  this->send_action_(this->forward_ ? TMCCEngineAction::FORWARD : TMCCEngineAction::REVERSE);
+  return true;
 }
 
 void TMCCEngine::blow_horn() {
-  ESP_LOGI(TAG, "blow_horn: address=%u", this->address_);
+  TMCC_LOG_FRAME(TAG, "blow_horn: address=%u duration=%ums", this->address_, this->horn_duration_ms_);
 
   if (this->bus_ != nullptr) {
-    // Send horn command 30 times - repetitions control the DURATION of the horn sound
-    this->bus_->engine_action_repeated_tmcc1(this->address_, TMCCEngineAction::BLOW_HORN1, 30);
+    // The horn sounds for as long as frames keep arriving, so stream one
+    // frame per slot for the duration; other engines interleave in between
+    this->stream_action_(TMCCEngineAction::BLOW_HORN1, this->horn_duration_ms_);
   } else {
     ESP_LOGE(TAG, "bus_ is nullptr! Cannot send horn command");
   }
 }
 
+void TMCCEngine::start_horn() {
+  TMCC_LOG_FRAME(TAG, "start_horn: address=%u", this->address_);
+  if (this->bus_ != nullptr) {
+    this->stream_action_(TMCCEngineAction::BLOW_HORN1, HORN_HOLD_LIMIT_MS);
+  }
+}
+
+void TMCCEngine::stop_horn() {
+  TMCC_LOG_FRAME(TAG, "stop_horn: address=%u", this->address_);
+  if (this->bus_ != nullptr) {
+    this->bus_->stop_stream(this->frames_.header,
+                            this->frames_.action_words[static_cast<uint8_t>(TMCCEngineAction::BLOW_HORN1)]);
+  }
+}
+
+void TMCCEngine::play_horn_pattern(const TMCCHornPattern *pattern) {
+  this->stop_horn_pattern();
+  if (this->bus_ == nullptr || pattern == nullptr || pattern->get_count() == 0) {
+    return;
+  }
+  TMCC_LOG_FRAME(TAG, "play_horn_pattern: address=%u segments=%u", this->address_, pattern->get_count());
+  this->horn_pattern_ = pattern;
+  this->horn_segment_ = 0;
+  this->play_horn_segment_();
+}
+
+void TMCCEngine::stop_horn_pattern() {
+  const TMCCHornPattern *pattern = this->horn_pattern_;
+  if (pattern == nullptr) {
+    return;
+  }
+  this->cancel_timeout(HORN_PATTERN_TIMEOUT_NAME);
+  this->horn_pattern_ = nullptr;
+  if (this->bus_ != nullptr) {
+    this->bus_->stop_stream(this->frames_.header,
+                            this->frames_.action_words[static_cast<uint8_t>(pattern->get_horn())]);
+  }
+}
+
+void TMCCEngine::play_horn_segment_() {
+  const TMCCHornPattern *pattern = this->horn_pattern_;
+  uint32_t on_ms = pattern->get_segment_ms(this->horn_segment_);
+  uint32_t off_ms = pattern->get_segment_ms(this->horn_segment_ + 1);
+  this->horn_segment_ += 2;
+
+  // The bus streams the blast by itself; the wire is free again in the gap
+  this->stream_action_(pattern->get_horn(), on_ms);
+  if (this->horn_segment_ >= pattern->get_count()) {
+    // Kept until the last blast ends, so stop_horn_pattern() can cut it short
+    this->set_timeout(HORN_PATTERN_TIMEOUT_NAME, on_ms, [this]() { this->horn_pattern_ = nullptr; });
+    return;
+  }
+  this->set_timeout(HORN_PATTERN_TIMEOUT_NAME, on_ms + off_ms, [this]() { this->play_horn_segment_(); });
+}
+
 void TMCCEngine::ring_bell() {
-  ESP_LOGI(TAG, "ring_bell: address=%u", this->address_);
+  TMCC_LOG_FRAME(TAG, "ring_bell: address=%u", this->address_);
 
   if (this->bus_ != nullptr) {
     // Bell is a toggle (on/off) - only needs to be sent once
-    this->bus_->engine_action_tmcc1(this->address_, TMCCEngineAction::RING_BELL);
+    this->send_action_(TMCCEngineAction::RING_BELL);
   }
 }
 
 void TMCCEngine::open_front_coupler() {
   if (this->bus_ != nullptr) {
-    this->bus_->engine_action_tmcc1(this->address_, TMCCEngineAction::FRONT_COUPLER);
+    this->send_action_(TMCCEngineAction::FRONT_COUPLER);
   }
 }
 
 void TMCCEngine::open_rear_coupler() {
   if (this->bus_ != nullptr) {
-    this->bus_->engine_action_tmcc1(this->address_, TMCCEngineAction::REAR_COUPLER);
+    this->send_action_(TMCCEngineAction::REAR_COUPLER);
   }
 }
 
 void TMCCEngine::boost() {
+  // The engine speeds up on board by an amount we cannot know
+  this->speed_known_ = false;
   if (this->bus_ != nullptr) {
-    this->bus_->engine_action_tmcc1(this->address_, TMCCEngineAction::BOOST);
+    this->send_action_(TMCCEngineAction::BOOST);
   }
 }
 
 void TMCCEngine::brake() {
+  // Braking takes over from momentum
+  this->stop_ramp_();
+  this->target_speed_ = this->current_speed_;
+  this->speed_known_ = false;
+  if (this->bus_ != nullptr) {
+    this->send_action_(TMCCEngineAction::BRAKE);
+  }
+}
+
+void TMCCEngine::run_action(TMCCEngineAction action) {
+  switch (action) {
+    case TMCCEngineAction::FORWARD:
+      this->set_direction_forward();
+      break;
+    case TMCCEngineAction::REVERSE:
+      this->set_direction_reverse();
+      break;
+    case TMCCEngineAction::TOGGLE_DIRECTION:
+      this->forward_ = !this->forward_;
+      if (this->direction_switch_ != nullptr) {
+        this->direction_switch_->publish_state(this->forward_);
+      }
+      if (this->bus_ != nullptr) {
+        this->send_action_(action);
+      }
+      break;
+    case TMCCEngineAction::BOOST:
+      this->boost();
+      break;
+    case TMCCEngineAction::BRAKE:
+      this->brake();
+      break;
+    case TMCCEngineAction::BLOW_HORN1:
+      this->blow_horn();
+      break;
+    default:
+      // Couplers, bell, AUX and sound effects carry no shadow state
+      if (this->bus_ != nullptr) {
+        this->send_action_(action);
+      }
+      break;
+  }
+}
+
+void TMCCEngine::set_parameter(TMCC2ParameterIndex index, uint8_t data) {
+  if (this->protocol_ != TMCCProtocol::LEGACY) {
+    ESP_LOGW(TAG, "set_parameter: engine %u is not a Legacy engine", this->address_);
+    return;
+  }
   if (this->bus_ != nullptr) {
-    this->bus_->engine_action_tmcc1(this->address_, TMCCEngineAction::BRAKE);
+    this->bus_->engine_parameter_tmcc2(this->address_, index, data);
   }
 }
 
+void TMCCEngine::send_action_(TMCCEngineAction action) {
+  this->send_frame_(this->frames_.action_words[static_cast<uint8_t>(action)]);
+}
+
+bool TMCCEngine::send_frame_(uint16_t word) {
+  this->sending_ = true;
+  bool accepted = this->bus_->send_frame(this->frames_.header, word);
+  this->sending_ = false;
+  return accepted;
+}
+
+void TMCCEngine::stream_action_(TMCCEngineAction action, uint32_t duration_ms) {
+  this->bus_->start_stream(this->frames_.header, this->frames_.action_words[static_cast<uint8_t>(action)],
+                           duration_ms);
+}
+
+void TMCCEngine::build_frames_() {
+  tmcc_build_frame_table(this->object_type_, this->address_, this->protocol_, &this->frames_);
+}
+
 void TMCCEngine::stop() {
   ESP_LOGW(TAG, "STOP: Sending system halt command");
   if (this->bus_ != nullptr) {
@@ -124,10 +456,22 @@ uint8_t TMCCEngine::get_max_speed() const {
   return this->max_speed_;
 }
 
+TMCCProtocol TMCCEngine::get_protocol() const {
+  return this->protocol_;
+}
+
 uint8_t TMCCEngine::get_current_speed() const {
   return this->current_speed_;
 }
 
+uint8_t TMCCEngine::get_target_speed() const {
+  return this->target_speed_;
+}
+
+const TMCCEngineFrameTable &TMCCEngine::get_frames() const {
+  return this->frames_;
+}
+
 bool TMCCEngine::is_forward() const {
   return this->forward_;
 }
@@ -142,11 +486,7 @@ void TMCCEngineSpeed::set_engine(TMCCEngine *engine) {
 
 void TMCCEngineSpeed::setup() {
   if (this->engine_ != nullptr) {
-    // Set initial traits
-    this->traits.set_min_value(0);
-    this->traits.set_max_value(this->engine_->get_max_speed());
-    this->traits.set_step(1);
-    // Publish initial state
+    // Traits come from codegen: the engine's max speed, or the highest in a cab's roster
     this->publish_state(0);
   }
 }
@@ -161,9 +501,8 @@ void TMCCEngineSpeed::dump_config() {
 
 void TMCCEngineSpeed::control(float value) {
   if (this->engine_ != nullptr) {
-    uint8_t speed = static_cast<uint8_t>(value);
-    this->engine_->set_speed(speed);
-    this->publish_state(value);
+    // The engine publishes the (clamped) target speed back to this entity
+    this->engine_->set_speed(static_cast<uint8_t>(value));
   }
 }
 
@@ -199,153 +538,37 @@ void TMCCEngineDirection::write_state(bool state) {
 }
 
 // ============================================================================
-// TMCCEngineHorn implementation
+// TMCCEngineStop implementation
 // ============================================================================
 
-void TMCCEngineHorn::set_engine(TMCCEngine *engine) {
+void TMCCEngineStop::set_engine(TMCCEngine *engine) {
   this->engine_ = engine;
 }
 
-void TMCCEngineHorn::dump_config() {
-  LOG_BUTTON("", "TMCC Engine Horn", this);
-  if (this->engine_ != nullptr) {
-    ESP_LOGCONFIG(TAG, "  Engine Address: %u", this->engine_->get_address());
-  }
-}
-
-void TMCCEngineHorn::press_action() {
-  ESP_LOGI(TAG, "Horn button pressed");
+void TMCCEngineStop::press_action() {
+  ESP_LOGW(TAG, "STOP button pressed - halting all trains!");
   if (this->engine_ != nullptr) {
-    this->engine_->blow_horn();
+    this->engine_->stop();
   } else {
-    ESP_LOGE(TAG, "engine_ is nullptr! Cannot blow horn");
-  }
-}
-
-// ============================================================================
-// TMCCEngineBell implementation
-// ============================================================================
-
-void TMCCEngineBell::set_engine(TMCCEngine *engine) {
-  this->engine_ = engine;
-}
-
-void TMCCEngineBell::dump_config() {
-  LOG_BUTTON("", "TMCC Engine Bell", this);
-  if (this->engine_ != nullptr) {
-    ESP_LOGCONFIG(TAG, "  Engine Address: %u", this->engine_->get_address());
-  }
-}
-
-void TMCCEngineBell::press_action() {
-  if (this->engine_ != nullptr) {
-    this->engine_->ring_bell();
-  }
-}
-
-// ============================================================================
-// TMCCEngineFrontCoupler implementation
-// ============================================================================
-
-void TMCCEngineFrontCoupler::set_engine(TMCCEngine *engine) {
-  this->engine_ = engine;
-}
-
-void TMCCEngineFrontCoupler::dump_config() {
-  LOG_BUTTON("", "TMCC Engine Front Coupler", this);
-  if (this->engine_ != nullptr) {
-    ESP_LOGCONFIG(TAG, "  Engine Address: %u", this->engine_->get_address());
-  }
-}
-
-void TMCCEngineFrontCoupler::press_action() {
-  if (this->engine_ != nullptr) {
-    this->engine_->open_front_coupler();
-  }
-}
-
-// ============================================================================
-// TMCCEngineRearCoupler implementation
-// ============================================================================
-
-void TMCCEngineRearCoupler::set_engine(TMCCEngine *engine) {
-  this->engine_ = engine;
-}
-
-void TMCCEngineRearCoupler::dump_config() {
-  LOG_BUTTON("", "TMCC Engine Rear Coupler", this);
-  if (this->engine_ != nullptr) {
-    ESP_LOGCONFIG(TAG, "  Engine Address: %u", this->engine_->get_address());
-  }
-}
-
-void TMCCEngineRearCoupler::press_action() {
-  if (this->engine_ != nullptr) {
-    this->engine_->open_rear_coupler();
-  }
-}
-
-// ============================================================================
-// TMCCEngineBoost implementation
-// ============================================================================
-
-void TMCCEngineBoost::set_engine(TMCCEngine *engine) {
-  this->engine_ = engine;
-}
-
-void TMCCEngineBoost::dump_config() {
-  LOG_BUTTON("", "TMCC Engine Boost", this);
-  if (this->engine_ != nullptr) {
-    ESP_LOGCONFIG(TAG, "  Engine Address: %u", this->engine_->get_address());
-  }
-}
-
-void TMCCEngineBoost::press_action() {
-  if (this->engine_ != nullptr) {
-    this->engine_->boost();
-  }
-}
-
-// ============================================================================
-// TMCCEngineBrake implementation
-// ============================================================================
-
-void TMCCEngineBrake::set_engine(TMCCEngine *engine) {
-  this->engine_ = engine;
-}
-
-void TMCCEngineBrake::dump_config() {
-  LOG_BUTTON("", "TMCC Engine Brake", this);
-  if (this->engine_ != nullptr) {
-    ESP_LOGCONFIG(TAG, "  Engine Address: %u", this->engine_->get_address());
-  }
-}
-
-void TMCCEngineBrake::press_action() {
-  if (this->engine_ != nullptr) {
-    this->engine_->brake();
+    ESP_LOGE(TAG, "engine_ is nullptr! Cannot send stop command");
   }
 }
 
 // ============================================================================
-// TMCCEngineStop implementation
+// TMCCHornPatternButton implementation
 // ============================================================================
 
-void TMCCEngineStop::set_engine(TMCCEngine *engine) {
+void TMCCHornPatternButton::set_engine(TMCCEngine *engine) {
   this->engine_ = engine;
 }
 
-void TMCCEngineStop::dump_config() {
-  LOG_BUTTON("", "TMCC Engine Stop", this);
-  ESP_LOGCONFIG(TAG, "  Sends System Halt command to stop all trains");
+void TMCCHornPatternButton::set_pattern(const TMCCHornPattern *pattern) {
+  this->pattern_ = pattern;
 }
 
-void TMCCEngineStop::press_action() {
-  ESP_LOGW(TAG, "STOP button pressed - halting all trains!");
+void TMCCHornPatternButton::press_action() {
   if (this->engine_ != nullptr) {
-    this->engine_->stop();
-  } else {
-    ESP_LOGE(TAG, "engine_ is nullptr! Cannot send stop command");
+    this->engine_->play_horn_pattern(this->pattern_);
   }
 }
 
@@ -371,5 +594,21 @@ void TMCCTestButton::press_action() {
   }
 }
 
+void TMCCTraceButton::set_bus(TMCCBus *bus) {
+  this->bus_ = bus;
+}
+
+void TMCCTraceButton::dump_config() {
+  LOG_BUTTON("", "TMCC Trace Button", this);
+}
+
+void TMCCTraceButton::press_action() {
+  if (this->bus_ != nullptr) {
+    this->bus_->dump_trace();
+  } else {
+    ESP_LOGE(TAG, "Cannot dump trace: bus not configured");
+  }
+}
+
 }  // namespace tmcc
 
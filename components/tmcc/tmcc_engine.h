@@ -1,10 +1,12 @@
 #pragma once
 
+#include "esphome/core/automation.h"
 #include "esphome/core/component.h"
 #include "esphome/components/number/number.h"
 #include "esphome/components/switch/switch.h"
 #include "esphome/components/button/button.h"
 #include "tmcc.h"
+#include "tmcc_horn.h"
 
 namespace tmcc {
 
@@ -41,12 +43,12 @@ class TMCCEngineDirection : public esphome::switch_::Switch, public esphome::Com
 };
 
 /**
- * Horn button for TMCC engine.
+ * Stop button - sends TMCC System Halt command to stop all trains.
+ * A plain entity rather than a Component, like TMCCEngineActionButton.
  */
-class TMCCEngineHorn : public esphome::button::Button, public esphome::Component {
+class TMCCEngineStop : public esphome::button::Button {
  public:
   void set_engine(TMCCEngine *engine);
-  void dump_config() override;
 
  protected:
   void press_action() override;
@@ -54,140 +56,215 @@ class TMCCEngineHorn : public esphome::button::Button, public esphome::Component
 };
 
 /**
- * Bell button for TMCC engine.
+ * Diagnostic test button - sends test pattern for UART debugging.
  */
-class TMCCEngineBell : public esphome::button::Button, public esphome::Component {
+class TMCCTestButton : public esphome::button::Button, public esphome::Component {
  public:
-  void set_engine(TMCCEngine *engine);
+  void set_bus(TMCCBus *bus);
   void dump_config() override;
 
  protected:
   void press_action() override;
-  TMCCEngine *engine_{nullptr};
+  TMCCBus *bus_{nullptr};
 };
 
 /**
- * Front coupler button for TMCC engine.
+ * Diagnostic trace button - logs the bus trace ring.
  */
-class TMCCEngineFrontCoupler : public esphome::button::Button, public esphome::Component {
+class TMCCTraceButton : public esphome::button::Button, public esphome::Component {
  public:
-  void set_engine(TMCCEngine *engine);
+  void set_bus(TMCCBus *bus);
   void dump_config() override;
 
  protected:
   void press_action() override;
-  TMCCEngine *engine_{nullptr};
+  TMCCBus *bus_{nullptr};
 };
 
 /**
- * Rear coupler button for TMCC engine.
+ * TMCCEngine - Main engine controller component.
+ *
+ * This component holds the engine configuration and provides
+ * the interface for child entities to send commands. It also follows
+ * frames received from the command base, so speed and direction changed
+ * by another controller are published to the speed and direction entities.
+ *
+ * Speed and direction are shadowed: once the engine's state is known (sent
+ * by us or seen on RX), a request that would not change it sends nothing.
+ * Brake and boost change the speed on board, so they make it unknown again.
  */
-class TMCCEngineRearCoupler : public esphome::button::Button, public esphome::Component {
+class TMCCEngine : public esphome::Component {
  public:
-  void set_engine(TMCCEngine *engine);
+  TMCCEngine();
+
+  void setup() override;
   void dump_config() override;
+  float get_setup_priority() const override;
 
- protected:
-  void press_action() override;
-  TMCCEngine *engine_{nullptr};
-};
+  // Configuration setters
+  void set_bus(TMCCBus *bus);
+  void set_address(uint8_t address);
+  void set_max_speed(uint8_t max_speed);  // Call after set_protocol(): TMCC1 allows 31, Legacy 199
+  void set_protocol(TMCCProtocol protocol);
+  void set_horn_duration(uint32_t horn_duration_ms);
+  void set_acceleration(uint16_t acceleration);  // Speed steps per second, 0 = jump straight to the target
+  void set_deceleration(uint16_t deceleration);  // Speed steps per second, 0 = jump straight to the target
+  void set_speed_number(TMCCEngineSpeed *speed_number);
+  void set_direction_switch(TMCCEngineDirection *direction_switch);
 
-/**
- * Boost button for TMCC engine.
- */
-class TMCCEngineBoost : public esphome::button::Button, public esphome::Component {
- public:
-  void set_engine(TMCCEngine *engine);
-  void dump_config() override;
+  // Command methods (called by child entities)
+  void set_speed(uint8_t speed);  // Ramps to `speed` when acceleration/deceleration are set
+  void set_direction_forward();
+  void set_direction_reverse();
+  void blow_horn();    // Sound the horn for the configured duration
+  void start_horn();   // Hold the horn until stop_horn() (capped for safety)
+  void stop_horn();
+  // Play a horn signal; replaces any signal this engine is already playing
+  void play_horn_pattern(const TMCCHornPattern *pattern);
+  void stop_horn_pattern();
+  void ring_bell();
+  void open_front_coupler();
+  void open_rear_coupler();
+  void boost();
+  void brake();
+  void stop();  // System halt - stops all trains
+  void run_action(TMCCEngineAction action);  // Any action, through the methods above where one exists
+  void set_parameter(TMCC2ParameterIndex index, uint8_t data);  // Legacy engines only
+
+  // Getters
+  uint8_t get_address() const;
+  uint8_t get_max_speed() const;
+  TMCCProtocol get_protocol() const;
+  uint8_t get_current_speed() const;  // Last speed sent, which lags the target while ramping
+  uint8_t get_target_speed() const;
+  const TMCCEngineFrameTable &get_frames() const;  // Pre-encoded frames, for sequences
+  bool is_forward() const;
+
+  // Re-send the known speed or direction (see TMCCRefresh). Return false,
+  // sending nothing, while the state is unknown or a ramp is running.
+  bool refresh_speed();
+  bool refresh_direction();
 
  protected:
-  void press_action() override;
-  TMCCEngine *engine_{nullptr};
+  // Update shadow state from a word this engine did not send: received
+  // from the command base (the bus filters out echoes of our own frames),
+  // or queued on the bus by another sender
+  void on_frame_(uint16_t word);
+  // Cancel momentum and show speed 0 after a System Halt
+  void on_halt_();
+
+  // Send an action or stream it for a duration, in this engine's protocol
+  void send_action_(TMCCEngineAction action);
+  // Queue one of this engine's own frames; sending_ is set meanwhile
+  bool send_frame_(uint16_t word);
+  void stream_action_(TMCCEngineAction action, uint32_t duration_ms);
+
+  // Re-encode frames_ after the address or protocol changed
+  void build_frames_();
+
+  // Momentum: step current_speed_ towards target_speed_ from an interval
+  void start_ramp_(uint16_t rate);
+  void ramp_step_();
+  void stop_ramp_();
+  void send_speed_(uint8_t speed);
+  // Stream the next sounding segment of horn_pattern_ and time the one after
+  void play_horn_segment_();
+  void set_direction_(bool forward);
+  bool suppress_duplicates_() const;
+
+  TMCCBus *bus_{nullptr};
+  TMCCEngineSpeed *speed_number_{nullptr};
+  TMCCEngineDirection *direction_switch_{nullptr};
+  TMCCObjectType object_type_{TMCCObjectType::ENGINE};  // TRAIN for a TMCCTrain
+  uint8_t address_{1};
+  TMCCProtocol protocol_{TMCCProtocol::TMCC1};
+  TMCCEngineFrameTable frames_{};  // Every action and speed frame for this engine, pre-encoded
+  uint8_t max_speed_{18};
+  uint32_t horn_duration_ms_{100};
+  const TMCCHornPattern *horn_pattern_{nullptr};  // Signal being played, nullptr when idle
+  uint8_t horn_segment_{0};                       // Next segment of horn_pattern_
+  uint16_t acceleration_{0};
+  uint16_t deceleration_{0};
+  uint16_t ramp_rate_{0};     // Rate of the running ramp, 0 when idle
+  uint8_t ramp_step_size_{1};
+  uint8_t target_speed_{0};
+  uint8_t current_speed_{0};
+  bool forward_{true};
+  bool speed_known_{false};      // current_speed_ matches the engine
+  bool direction_known_{false};  // forward_ matches the engine
+  bool sending_{false};          // Inside send_frame_(): queued frames are our own
 };
 
 /**
- * Brake button for TMCC engine.
+ * Button for one engine action, fixed at compile time.
+ *
+ * Not a Component: it has no setup, loop or dump_config, so buttons add
+ * nothing to App's component lists however many engines there are.
  */
-class TMCCEngineBrake : public esphome::button::Button, public esphome::Component {
+template<TMCCEngineAction Action> class TMCCEngineActionButton : public esphome::button::Button {
  public:
-  void set_engine(TMCCEngine *engine);
-  void dump_config() override;
+  void set_engine(TMCCEngine *engine) { this->engine_ = engine; }
 
  protected:
-  void press_action() override;
+  void press_action() override {
+    if (this->engine_ != nullptr) {
+      this->engine_->run_action(Action);
+    }
+  }
+
   TMCCEngine *engine_{nullptr};
 };
 
 /**
- * Stop button - sends TMCC System Halt command to stop all trains.
+ * Button that plays a horn signal on one engine. Not a Component.
  */
-class TMCCEngineStop : public esphome::button::Button, public esphome::Component {
+class TMCCHornPatternButton : public esphome::button::Button {
  public:
   void set_engine(TMCCEngine *engine);
-  void dump_config() override;
+  void set_pattern(const TMCCHornPattern *pattern);
 
  protected:
   void press_action() override;
   TMCCEngine *engine_{nullptr};
+  const TMCCHornPattern *pattern_{nullptr};
 };
 
 /**
- * Diagnostic test button - sends test pattern for UART debugging.
+ * Automation action `tmcc.play_horn_pattern`.
  */
-class TMCCTestButton : public esphome::button::Button, public esphome::Component {
+template<typename... Ts> class TMCCHornPatternAction : public esphome::Action<Ts...> {
  public:
-  void set_bus(TMCCBus *bus);
-  void dump_config() override;
+  TMCCHornPatternAction(TMCCEngine *engine, const TMCCHornPattern *pattern) : engine_(engine), pattern_(pattern) {}
+
+  void play(Ts... x) override { this->engine_->play_horn_pattern(this->pattern_); }
 
  protected:
-  void press_action() override;
-  TMCCBus *bus_{nullptr};
+  TMCCEngine *engine_;
+  const TMCCHornPattern *pattern_;
 };
 
 /**
- * TMCCEngine - Main engine controller component.
- *
- * This component holds the engine configuration and provides
- * the interface for child entities to send commands.
+ * Automation actions `tmcc.start_horn` and `tmcc.stop_horn`: hold the horn
+ * for as long as a physical button is pressed.
  */
-class TMCCEngine : public esphome::Component {
+template<typename... Ts> class TMCCStartHornAction : public esphome::Action<Ts...> {
  public:
-  TMCCEngine() = default;
+  explicit TMCCStartHornAction(TMCCEngine *engine) : engine_(engine) {}
 
-  void setup() override;
-  void dump_config() override;
-  float get_setup_priority() const override;
+  void play(Ts... x) override { this->engine_->start_horn(); }
 
-  // Configuration setters
-  void set_bus(TMCCBus *bus);
-  void set_address(uint8_t address);
-  void set_max_speed(uint8_t max_speed);
+ protected:
+  TMCCEngine *engine_;
+};
 
-  // Command methods (called by child entities)
-  void set_speed(uint8_t speed);
-  void set_direction_forward();
-  void set_direction_reverse();
-  void blow_horn();
-  void ring_bell();
-  void open_front_coupler();
-  void open_rear_coupler();
-  void boost();
-  void brake();
-  void stop();  // System halt - stops all trains
+template<typename... Ts> class TMCCStopHornAction : public esphome::Action<Ts...> {
+ public:
+  explicit TMCCStopHornAction(TMCCEngine *engine) : engine_(engine) {}
 
-  // Getters
-  uint8_t get_address() const;
-  uint8_t get_max_speed() const;
-  uint8_t get_current_speed() const;
-  bool is_forward() const;
+  void play(Ts... x) override { this->engine_->stop_horn(); }
 
  protected:
-  TMCCBus *bus_{nullptr};
-  uint8_t address_{1};
-  uint8_t max_speed_{18};
-  uint8_t current_speed_{0};
-  bool forward_{true};
+  TMCCEngine *engine_;
 };
 
 }  // namespace tmcc
-
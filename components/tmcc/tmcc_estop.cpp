@@ -0,0 +1,94 @@
+#include "tmcc_estop.h"
+#include "esphome/core/log.h"
+
+namespace tmcc {
+
+static const char *const TAG = "tmcc.estop";
+
+// Above the writer task (5), so a press is handled before anything else
+// the bus does, and below the Wi-Fi and timer tasks
+static const uint32_t ESTOP_TASK_STACK_SIZE = 2048;
+static const UBaseType_t ESTOP_TASK_PRIORITY = 10;
+
+void TMCCEStop::setup() {
+  if (this->bus_ == nullptr || this->pin_ == nullptr) {
+    ESP_LOGE(TAG, "TMCCBus or pin not configured!");
+    this->mark_failed();
+    return;
+  }
+
+  if (xTaskCreate(TMCCEStop::task_, "tmcc_estop", ESTOP_TASK_STACK_SIZE, this, ESTOP_TASK_PRIORITY,
+                  &this->task_handle_) != pdPASS) {
+    ESP_LOGE(TAG, "Failed to start e-stop task");
+    this->task_handle_ = nullptr;
+    this->mark_failed();
+    return;
+  }
+
+  this->pin_->setup();
+  this->isr_pin_ = this->pin_->to_isr();
+  // The rising edge of the active level; the pin's `inverted` swaps edges
+  this->pin_->attach_interrupt(TMCCEStop::gpio_intr_, this, esphome::gpio::INTERRUPT_RISING_EDGE);
+}
+
+void TMCCEStop::loop() {
+  uint32_t measured = this->bus_->get_emergency_halt_count();
+  if (measured == this->latency_seen_) {
+    return;
+  }
+  this->latency_seen_ = measured;
+  uint32_t latency_us = this->bus_->get_emergency_latency_us();
+  ESP_LOGW(TAG, "E-stop pressed - halt on the wire after %u us", latency_us);
+  if (this->latency_sensor_ != nullptr) {
+    this->latency_sensor_->publish_state(latency_us / 1000.0f);
+  }
+}
+
+void TMCCEStop::dump_config() {
+  ESP_LOGCONFIG(TAG, "TMCC E-Stop:");
+  LOG_PIN("  Pin: ", this->pin_);
+  ESP_LOGCONFIG(TAG, "  Debounce: %u ms", this->debounce_us_ / 1000);
+  ESP_LOGCONFIG(TAG, "  Presses: %u", this->presses_);
+  LOG_SENSOR("  ", "Latency", this->latency_sensor_);
+}
+
+void TMCCEStop::set_bus(TMCCBus *bus) {
+  this->bus_ = bus;
+}
+
+void TMCCEStop::set_pin(esphome::InternalGPIOPin *pin) {
+  this->pin_ = pin;
+}
+
+void TMCCEStop::set_debounce(uint32_t debounce_ms) {
+  this->debounce_us_ = debounce_ms * 1000;
+}
+
+void TMCCEStop::set_latency_sensor(esphome::sensor::Sensor *sensor) {
+  this->latency_sensor_ = sensor;
+}
+
+void IRAM_ATTR TMCCEStop::gpio_intr_(TMCCEStop *arg) {
+  uint32_t now = esphome::micros();
+  if (arg->pressed_once_ && now - arg->pressed_us_ < arg->debounce_us_) {
+    // Contact bounce of a press that is already being handled
+    return;
+  }
+  arg->pressed_us_ = now;
+  arg->pressed_once_ = true;
+
+  BaseType_t woken = pdFALSE;
+  vTaskNotifyGiveFromISR(arg->task_handle_, &woken);
+  portYIELD_FROM_ISR(woken);
+}
+
+void TMCCEStop::task_(void *arg) {
+  TMCCEStop *estop = static_cast<TMCCEStop *>(arg);
+  while (true) {
+    ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+    estop->bus_->emergency_halt(estop->pressed_us_);
+    estop->presses_++;
+  }
+}
+
+}  // namespace tmcc
@@ -0,0 +1,55 @@
+#pragma once
+
+#include "esphome/core/component.h"
+#include "esphome/core/hal.h"
+#include "esphome/components/sensor/sensor.h"
+#include "tmcc.h"
+
+namespace tmcc {
+
+/**
+ * TMCCEStop - Hardware emergency-stop input.
+ *
+ * A press on the GPIO halts the layout without going through Wi-Fi, Home
+ * Assistant or the main loop. The interrupt handler timestamps the edge
+ * and wakes a dedicated task that runs above the writer task; that task
+ * queues the System Halt with TMCCBus::emergency_halt(), which puts it
+ * ahead of everything queued, so it goes out at the next frame boundary
+ * even in the middle of a burst. Ramps, sequences and entities follow on
+ * the next loop().
+ *
+ * Debouncing uses the interrupt timestamps: the first edge halts at once
+ * and further edges are ignored for the debounce time. The time from the
+ * edge to the first halt byte is published as a diagnostic sensor.
+ */
+class TMCCEStop : public esphome::Component {
+ public:
+  void setup() override;
+  void loop() override;
+  void dump_config() override;
+
+  void set_bus(TMCCBus *bus);
+  void set_pin(esphome::InternalGPIOPin *pin);
+  void set_debounce(uint32_t debounce_ms);
+  void set_latency_sensor(esphome::sensor::Sensor *sensor);
+
+ protected:
+  static void gpio_intr_(TMCCEStop *arg);
+  static void task_(void *arg);
+
+  TMCCBus *bus_{nullptr};
+  esphome::InternalGPIOPin *pin_{nullptr};
+  esphome::ISRInternalGPIOPin isr_pin_;
+  uint32_t debounce_us_{50000};
+  esphome::sensor::Sensor *latency_sensor_{nullptr};
+  TaskHandle_t task_handle_{nullptr};
+
+  // Written by the interrupt handler, read by the task
+  volatile uint32_t pressed_us_{0};
+  volatile bool pressed_once_{false};
+
+  uint32_t presses_{0};               // Halts sent; written by the task
+  uint32_t latency_seen_{0};          // Last bus measurement published
+};
+
+}  // namespace tmcc
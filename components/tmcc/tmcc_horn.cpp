@@ -0,0 +1,28 @@
+#include "tmcc_horn.h"
+
+namespace tmcc {
+
+TMCCHornPattern::TMCCHornPattern(const uint8_t *segments, uint8_t count, TMCCEngineAction horn)
+    : segments_(segments), count_(count), horn_(horn) {}
+
+uint8_t TMCCHornPattern::get_count() const {
+  return this->count_;
+}
+
+uint32_t TMCCHornPattern::get_segment_ms(uint8_t index) const {
+  return index < this->count_ ? this->segments_[index] * TMCC_HORN_PATTERN_UNIT_MS : 0;
+}
+
+TMCCEngineAction TMCCHornPattern::get_horn() const {
+  return this->horn_;
+}
+
+uint32_t TMCCHornPattern::get_duration_ms() const {
+  uint32_t total = 0;
+  for (uint8_t i = 0; i < this->count_; i++) {
+    total += this->get_segment_ms(i);
+  }
+  return total;
+}
+
+}  // namespace tmcc
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "tmcc_protocol.h"
+
+namespace tmcc {
+
+// Horn pattern segments are stored in units of this many milliseconds, so
+// one byte covers up to 5.1 s
+static constexpr uint32_t TMCC_HORN_PATTERN_UNIT_MS = 20;
+
+/**
+ * TMCCHornPattern - A horn or whistle signal as an on/off timing table.
+ *
+ * Segments alternate sounding and silent, starting and ending with a
+ * sounding one: on, off, on, ..., on. Each is one byte in units of
+ * TMCC_HORN_PATTERN_UNIT_MS. Tables are generated from the YAML signal
+ * (e.g. "L L S L" for a grade crossing) as static const arrays, so they
+ * live in flash. TMCCEngine::play_horn_pattern() plays them.
+ *
+ * Plain C++ with no ESPHome or FreeRTOS dependencies.
+ */
+class TMCCHornPattern {
+ public:
+  TMCCHornPattern(const uint8_t *segments, uint8_t count, TMCCEngineAction horn);
+
+  uint8_t get_count() const;
+  uint32_t get_segment_ms(uint8_t index) const;
+  TMCCEngineAction get_horn() const;  // BLOW_HORN1 or BLOW_HORN2
+  uint32_t get_duration_ms() const;   // Whole signal, first blast to end of last
+
+ protected:
+  const uint8_t *segments_;
+  uint8_t count_;
+  TMCCEngineAction horn_;
+};
+
+}  // namespace tmcc
@@ -0,0 +1,103 @@
+#include "tmcc_pacing.h"
+
+namespace tmcc {
+
+void TMCCRateController::configure(uint32_t min_gap_ms, uint32_t max_gap_ms, bool adaptive) {
+  this->min_gap_ms_ = min_gap_ms;
+  this->max_gap_ms_ = max_gap_ms < min_gap_ms ? min_gap_ms : max_gap_ms;
+  this->gap_ms_ = min_gap_ms;
+  this->adaptive_ = adaptive;
+  this->head_ = 0;
+  this->count_ = 0;
+  this->window_frames_ = 0;
+  this->window_lost_ = 0;
+}
+
+uint32_t TMCCRateController::get_gap_ms() const {
+  return this->gap_ms_;
+}
+
+bool TMCCRateController::is_adaptive() const {
+  return this->adaptive_;
+}
+
+void TMCCRateController::on_sent(uint16_t word, uint32_t now_ms) {
+  if (!this->adaptive_) {
+    return;
+  }
+  if (this->count_ == TMCC_PACING_PENDING_SIZE) {
+    this->retire_oldest_();
+  }
+  size_t index = (this->head_ + this->count_) % TMCC_PACING_PENDING_SIZE;
+  this->pending_[index] = Pending{word, now_ms, false};
+  this->count_++;
+}
+
+void TMCCRateController::on_received(uint16_t word) {
+  // Repeated frames carry the same word, so match the oldest one still waiting
+  for (size_t i = 0; i < this->count_; i++) {
+    Pending &pending = this->pending_[(this->head_ + i) % TMCC_PACING_PENDING_SIZE];
+    if (!pending.echoed && pending.word == word) {
+      pending.echoed = true;
+      return;
+    }
+  }
+}
+
+bool TMCCRateController::update(uint32_t now_ms) {
+  bool changed = false;
+  while (this->count_ > 0) {
+    const Pending &oldest = this->pending_[this->head_];
+    if (!oldest.echoed && now_ms - oldest.sent_ms < TMCC_PACING_ECHO_TIMEOUT_MS) {
+      break;
+    }
+    changed |= this->retire_oldest_();
+  }
+  return changed;
+}
+
+uint32_t TMCCRateController::get_echoed() const {
+  return this->echoed_;
+}
+
+uint32_t TMCCRateController::get_lost() const {
+  return this->lost_;
+}
+
+bool TMCCRateController::retire_oldest_() {
+  const Pending &oldest = this->pending_[this->head_];
+  if (oldest.echoed) {
+    this->echoed_++;
+  } else {
+    this->lost_++;
+    this->window_lost_++;
+  }
+  this->head_ = (this->head_ + 1) % TMCC_PACING_PENDING_SIZE;
+  this->count_--;
+
+  if (++this->window_frames_ < TMCC_PACING_WINDOW) {
+    return false;
+  }
+
+  uint32_t previous_gap = this->gap_ms_;
+  if (this->echoed_ == 0) {
+    // Nothing has ever come back: the base does not echo
+    this->adaptive_ = false;
+    this->gap_ms_ = this->min_gap_ms_;
+    this->count_ = 0;
+    this->window_frames_ = 0;
+    this->window_lost_ = 0;
+    return true;
+  }
+  if (this->window_lost_ * 20 > this->window_frames_) {
+    uint32_t gap = this->gap_ms_ == 0 ? 1 : this->gap_ms_ * 2;
+    this->gap_ms_ = gap > this->max_gap_ms_ ? this->max_gap_ms_ : gap;
+  } else if (this->window_lost_ == 0 && this->gap_ms_ > this->min_gap_ms_) {
+    this->gap_ms_--;
+  }
+  this->window_frames_ = 0;
+  this->window_lost_ = 0;
+  return this->gap_ms_ != previous_gap;
+}
+
+}  // namespace tmcc
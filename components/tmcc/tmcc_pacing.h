@@ -0,0 +1,76 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace tmcc {
+
+// Sent frames tracked while waiting for their echo
+static constexpr size_t TMCC_PACING_PENDING_SIZE = 32;
+// A frame not echoed within this time counts as lost
+static constexpr uint32_t TMCC_PACING_ECHO_TIMEOUT_MS = 250;
+// Frames per measurement window; the gap is adjusted once per window
+static constexpr uint16_t TMCC_PACING_WINDOW = 32;
+
+/**
+ * TMCCRateController - Adaptive inter-frame gap from the command base echo.
+ *
+ * A command base that repeats what it puts on the track lets the sender
+ * see which frames got through. Each sent TMCC1 frame is remembered until
+ * its word comes back on RX or the echo timeout passes. After every window
+ * of frames the gap is doubled if more than 1 in 20 was lost, and shortened
+ * by 1 ms after a window without loss, never below the configured gap or
+ * above the maximum. The rate settles near the fastest the base keeps up with.
+ *
+ * If a whole window passes without a single echo the base does not echo
+ * at all: adaptive mode switches itself off and the configured gap is kept.
+ *
+ * Plain C++ with no locking; the owner serialises calls.
+ */
+class TMCCRateController {
+ public:
+  TMCCRateController() = default;
+
+  void configure(uint32_t min_gap_ms, uint32_t max_gap_ms, bool adaptive);
+
+  // Current gap to leave after each frame
+  uint32_t get_gap_ms() const;
+  bool is_adaptive() const;
+
+  // A TMCC1 frame went out on the wire
+  void on_sent(uint16_t word, uint32_t now_ms);
+  // A TMCC1 word was received from the command base
+  void on_received(uint16_t word);
+  // Expire unanswered frames and close finished windows. Returns true when
+  // the gap changed or adaptive mode switched itself off.
+  bool update(uint32_t now_ms);
+
+  uint32_t get_echoed() const;
+  uint32_t get_lost() const;
+
+ protected:
+  struct Pending {
+    uint16_t word;
+    uint32_t sent_ms;
+    bool echoed;
+  };
+
+  // Retire the oldest pending frame into the current window
+  bool retire_oldest_();
+
+  uint32_t min_gap_ms_{0};
+  uint32_t max_gap_ms_{0};
+  uint32_t gap_ms_{0};
+  bool adaptive_{false};
+
+  Pending pending_[TMCC_PACING_PENDING_SIZE]{};
+  size_t head_{0};   // Oldest pending frame
+  size_t count_{0};
+
+  uint16_t window_frames_{0};
+  uint16_t window_lost_{0};
+  uint32_t echoed_{0};
+  uint32_t lost_{0};
+};
+
+}  // namespace tmcc
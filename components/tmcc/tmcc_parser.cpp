@@ -0,0 +1,45 @@
+#include "tmcc_parser.h"
+
+namespace tmcc {
+
+static bool is_header(uint8_t byte) {
+  return byte == TMCC1_HEADER || byte == TMCC2_ENGINE_HEADER || byte == TMCC2_TRAIN_HEADER ||
+         byte == TMCC2_MULTIWORD_HEADER;
+}
+
+bool TMCCFrameParser::feed(uint8_t byte, TMCCFrame *frame) {
+  switch (this->state_) {
+    case State::WAIT_HEADER:
+      if (is_header(byte)) {
+        this->header_ = byte;
+        this->state_ = State::WAIT_HIGH;
+      } else {
+        this->discarded_bytes_++;
+      }
+      return false;
+
+    case State::WAIT_HIGH:
+      // Header values are valid data bytes (e.g. accessory words, Legacy
+      // addresses), so they are only headers when the parser waits for one
+      this->high_ = byte;
+      this->state_ = State::WAIT_LOW;
+      return false;
+
+    case State::WAIT_LOW:
+      frame->header = this->header_;
+      frame->word = (static_cast<uint16_t>(this->high_) << 8) | byte;
+      this->state_ = State::WAIT_HEADER;
+      return true;
+  }
+  return false;
+}
+
+void TMCCFrameParser::reset() {
+  this->state_ = State::WAIT_HEADER;
+}
+
+uint32_t TMCCFrameParser::get_discarded_bytes() const {
+  return this->discarded_bytes_;
+}
+
+}  // namespace tmcc
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <cstdint>
+
+#include "tmcc_protocol.h"
+
+namespace tmcc {
+
+/**
+ * TMCCFrameParser - Incremental parser for TMCC1 and Legacy frames.
+ *
+ * Bytes are fed one at a time as they arrive from the command base. The
+ * parser allocates nothing and keeps only the partial frame, so it can run
+ * directly in the UART receive task. Every frame is a header (0xFE, 0xF8,
+ * 0xF9 or 0xFB) and two data bytes; header values inside the data are
+ * data. Bytes outside a frame are discarded until the next header, which
+ * resynchronises the parser after noise or a frame cut short by a reset.
+ */
+class TMCCFrameParser {
+ public:
+  TMCCFrameParser() = default;
+
+  // Feed one received byte. Returns true when it completes a frame, which is
+  // then stored in `frame`.
+  bool feed(uint8_t byte, TMCCFrame *frame);
+
+  // Forget any partial frame
+  void reset();
+
+  // Number of bytes discarded while waiting for a header
+  uint32_t get_discarded_bytes() const;
+
+ protected:
+  enum class State : uint8_t {
+    WAIT_HEADER,
+    WAIT_HIGH,
+    WAIT_LOW,
+  };
+
+  State state_{State::WAIT_HEADER};
+  uint8_t header_{0};
+  uint8_t high_{0};
+  uint32_t discarded_bytes_{0};
+};
+
+}  // namespace tmcc
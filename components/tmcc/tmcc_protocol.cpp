@@ -2,83 +2,245 @@
 
 namespace tmcc {
 
-uint16_t tmcc_make_word(TMCCObjectType type, uint8_t address, TMCCCommandClass cmd_class, uint8_t data) {
-  uint16_t word = 0;
-
-  // Mask address to 7 bits and data to 5 bits
-  address &= 0x7F;
-  data &= 0x1F;
-
-  switch (type) {
-    case TMCCObjectType::ENGINE:
-      // Engine: 0 0 A A A A A A A C C D D D D D
-      // Bits 15-14: 00
-      // Bits 13-7: address (7 bits)
-      // Bits 6-5: command class (2 bits)
-      // Bits 4-0: data (5 bits)
-      word = (static_cast<uint16_t>(address) << 7) |
-             (static_cast<uint16_t>(cmd_class) << 5) |
-             static_cast<uint16_t>(data);
-      break;
+// ============================================================================
+// Compile-time proof of the word layouts documented in tmcc_protocol.h.
+// Each row packs recognisable field values and compares the result with the
+// bit diagram written out by hand.
+// ============================================================================
 
-    case TMCCObjectType::SWITCH:
-      // Switch: 0 1 A A A A A A A C C D D D D D
-      // Bit 14: 1
-      word = (1 << 14) |
-             (static_cast<uint16_t>(address) << 7) |
-             (static_cast<uint16_t>(cmd_class) << 5) |
-             static_cast<uint16_t>(data);
-      break;
+// Engine: 0 0 A A A A A A A C C D D D D D
+static_assert(tmcc_make_word(TMCCObjectType::ENGINE, 0b1010101, TMCCCommandClass::ABSOLUTE_SPEED, 0b10101) ==
+                  0b0010101011110101,
+              "engine word layout");
+// Switch: 0 1 A A A A A A A C C D D D D D
+static_assert(tmcc_make_word(TMCCObjectType::SWITCH, 0b1111111, TMCCCommandClass::ACTION, 0b00000) ==
+                  0b0111111110000000,
+              "switch word layout");
+// Accessory: 1 0 A A A A A A A C C D D D D D
+static_assert(tmcc_make_word(TMCCObjectType::ACCESSORY, 0b0000001, TMCCCommandClass::EXTENDED, 0b11111) ==
+                  0b1000000010111111,
+              "accessory word layout");
+// Train: 1 1 0 0 1 A A A A C C D D D D D (4-bit address)
+static_assert(tmcc_make_word(TMCCObjectType::TRAIN, 0b1001, TMCCCommandClass::RELATIVE_SPEED, 0b00101) ==
+                  0b1100110011000101,
+              "train word layout");
+static_assert(tmcc_make_word(TMCCObjectType::TRAIN, 0b11111, TMCCCommandClass::ACTION, 0) ==
+                  tmcc_make_word(TMCCObjectType::TRAIN, 0b01111, TMCCCommandClass::ACTION, 0),
+              "train address is masked to 4 bits");
+// Route: 1 1 0 1 A A A A A C C D D D D D (5-bit address)
+static_assert(tmcc_make_word(TMCCObjectType::ROUTE, 0b10001, TMCCCommandClass::ACTION, 0b11111) ==
+                  0b1101100010011111,
+              "route word layout");
+// Out-of-range fields never spill into neighbouring fields
+static_assert(tmcc_make_word(TMCCObjectType::ENGINE, 0xFF, TMCCCommandClass::ACTION, 0xFF) == 0b0011111110011111,
+              "address and data are masked");
 
-    case TMCCObjectType::ACCESSORY:
-      // Accessory: 1 0 A A A A A A A C C D D D D D
-      // Bit 15: 1
-      word = (1 << 15) |
-             (static_cast<uint16_t>(address) << 7) |
-             (static_cast<uint16_t>(cmd_class) << 5) |
-             static_cast<uint16_t>(data);
-      break;
+// Engine helpers, checked against known frames (FE 00 9C = engine 1 horn)
+static_assert(tmcc_engine_action_word(1, TMCCEngineAction::BLOW_HORN1) == 0x009C, "engine 1 horn");
+static_assert(tmcc_engine_action_word(1, TMCCEngineAction::FORWARD) == 0x0080, "engine 1 forward");
+static_assert(tmcc_engine_speed_word(1, 18) == 0x00F2, "engine 1 speed 18");
+static_assert(tmcc_engine_speed_word(1, 200) == tmcc_engine_speed_word(1, 31), "speed clamps to 31");
 
-    case TMCCObjectType::TRAIN:
-      // Train: 1 1 0 0 1 A A A A C C D D D D D
-      // Bits 15-14: 11, Bits 13-11: 001
-      // Address is only 4 bits for trains
-      word = (0b11001 << 11) |
-             (static_cast<uint16_t>(address & 0x0F) << 7) |
-             (static_cast<uint16_t>(cmd_class) << 5) |
-             static_cast<uint16_t>(data);
-      break;
+// Train (lash-up) helpers
+static_assert(tmcc_train_speed_word(2, 10) == 0xC96A, "train 2 speed 10");
+static_assert(tmcc_engine_assign_train_word(1, 2) == 0x00A2, "engine 1 to train 2");
+static_assert(tmcc_engine_unit_word(1, TMCCTrainUnit::REAR, true) == 0x00B7, "engine 1 rear unit, reversed");
+
+// No train value, in range or not, turns the assign word into another
+// extended command
+constexpr bool tmcc_assign_words_are_unambiguous() {
+  constexpr TMCCExtendedCommand OTHERS[] = {TMCCExtendedCommand::MOMENTUM_LOW, TMCCExtendedCommand::MOMENTUM_MEDIUM,
+                                            TMCCExtendedCommand::MOMENTUM_HIGH, TMCCExtendedCommand::SET_ADDRESS};
+  for (unsigned train = 0; train <= 0xFF; train++) {
+    for (TMCCExtendedCommand other : OTHERS) {
+      if (tmcc_engine_assign_train_word(1, train) ==
+          tmcc_make_word(TMCCObjectType::ENGINE, 1, TMCCCommandClass::EXTENDED, static_cast<uint8_t>(other))) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+static_assert(tmcc_assign_words_are_unambiguous(), "assign word collides with another extended command");
 
-    case TMCCObjectType::ROUTE:
-      // Route: 1 1 0 1 A A A A A C C D D D D D
-      // Bits 15-14: 11, Bits 13-12: 01
-      // Address is only 5 bits for routes
-      word = (0b1101 << 12) |
-             (static_cast<uint16_t>(address & 0x1F) << 7) |
-             (static_cast<uint16_t>(cmd_class) << 5) |
-             static_cast<uint16_t>(data);
+// Switch, accessory and route helpers
+static_assert(tmcc_switch_word(3, TMCCSwitchAction::THROW_THROUGH) == 0x4180, "switch 3 through");
+static_assert(tmcc_switch_word(3, TMCCSwitchAction::THROW_OUT) == 0x419F, "switch 3 out");
+static_assert(tmcc_accessory_word(5, TMCCAccessoryAction::AUX1_ON) == 0x828B, "accessory 5 aux1 on");
+static_assert(tmcc_route_word(2, TMCCRouteAction::THROW) == 0xD11F, "route 2 throw");
+
+// Legacy engine: A A A A A A A C D D D D D D D D
+static_assert(tmcc2_engine_speed_word(0b1010101, 199) == 0b1010101011000111, "legacy speed word layout");
+static_assert(tmcc2_engine_speed_word(1, 255) == tmcc2_engine_speed_word(1, TMCC2_MAX_SPEED),
+              "legacy speed clamps to 199");
+static_assert(tmcc2_engine_action_word(1, TMCCEngineAction::BLOW_HORN1) == 0b0000001100011100,
+              "legacy action word layout");
+
+// Type prefixes used to recognise engine and train words
+static constexpr uint16_t ENGINE_TYPE_MASK = 0xC000;  // Bits 15-14
+static constexpr uint16_t ENGINE_TYPE_BITS = 0x0000;  // 0 0
+static constexpr uint16_t TRAIN_TYPE_MASK = 0xF800;   // Bits 15-11
+static constexpr uint16_t TRAIN_TYPE_BITS = 0xC800;   // 1 1 0 0 1
+static constexpr uint16_t ROUTE_TYPE_MASK = 0xF000;   // Bits 15-12
+static constexpr uint16_t ROUTE_TYPE_BITS = 0xD000;   // 1 1 0 1
+
+
+static bool is_engine_or_train_word(uint16_t word) {
+  if (word == TMCC1_SYSTEM_HALT_WORD) {
+    return false;
+  }
+  return (word & ENGINE_TYPE_MASK) == ENGINE_TYPE_BITS || (word & TRAIN_TYPE_MASK) == TRAIN_TYPE_BITS;
+}
+
+bool tmcc_decode_word(uint16_t word, TMCCDecodedWord *decoded) {
+  if (word == TMCC1_SYSTEM_HALT_WORD) {
+    return false;
+  }
+
+  switch (word >> 14) {
+    case 0b00:
+      decoded->type = TMCCObjectType::ENGINE;
+      decoded->address = (word >> 7) & 0x7F;
+      break;
+    case 0b01:
+      decoded->type = TMCCObjectType::SWITCH;
+      decoded->address = (word >> 7) & 0x7F;
+      break;
+    case 0b10:
+      decoded->type = TMCCObjectType::ACCESSORY;
+      decoded->address = (word >> 7) & 0x7F;
+      break;
+    default:
+      if ((word & TRAIN_TYPE_MASK) == TRAIN_TYPE_BITS) {
+        // Train: 1 1 0 0 1 A A A A C C D D D D D
+        decoded->type = TMCCObjectType::TRAIN;
+        decoded->address = (word >> 7) & 0x0F;
+      } else if ((word & ROUTE_TYPE_MASK) == ROUTE_TYPE_BITS) {
+        // Route: 1 1 0 1 A A A A A C C D D D D D
+        decoded->type = TMCCObjectType::ROUTE;
+        decoded->address = (word >> 7) & 0x1F;
+      } else {
+        return false;
+      }
       break;
   }
 
-  return word;
+  decoded->cmd_class = static_cast<TMCCCommandClass>((word >> 5) & 0x03);
+  decoded->data = word & 0x1F;
+  return true;
 }
 
-uint16_t tmcc_engine_action_word(uint8_t address, TMCCEngineAction action) {
-  uint16_t word = tmcc_make_word(TMCCObjectType::ENGINE, address, TMCCCommandClass::ACTION,
-                                 static_cast<uint8_t>(action));
-  // #region agent log
-  // Note: Logging here would require including log.h, but we'll log in the caller instead
-  // #endregion
-  return word;
+void tmcc_build_frame_table(TMCCObjectType type, uint8_t address, TMCCProtocol protocol,
+                            TMCCEngineFrameTable *table) {
+  bool train = type == TMCCObjectType::TRAIN;
+  if (protocol == TMCCProtocol::LEGACY) {
+    // Legacy engines and trains share one word layout; only the header differs
+    table->header = train ? TMCC2_TRAIN_HEADER : TMCC2_ENGINE_HEADER;
+    for (uint8_t action = 0; action < TMCC_ENGINE_ACTION_COUNT; action++) {
+      table->action_words[action] = tmcc2_engine_action_word(address, static_cast<TMCCEngineAction>(action));
+    }
+    table->speed_base = tmcc2_engine_speed_word(address, 0);
+    return;
+  }
+  table->header = TMCC1_HEADER;
+  for (uint8_t action = 0; action < TMCC_ENGINE_ACTION_COUNT; action++) {
+    auto code = static_cast<TMCCEngineAction>(action);
+    table->action_words[action] = train ? tmcc_train_action_word(address, code) : tmcc_engine_action_word(address, code);
+  }
+  table->speed_base = train ? tmcc_train_speed_word(address, 0) : tmcc_engine_speed_word(address, 0);
+}
+
+void tmcc2_make_parameter_frames(uint8_t header, uint8_t address, TMCC2ParameterIndex index, uint8_t data,
+                                 TMCCFrame *frames) {
+  uint8_t train_bit = (header == TMCC2_TRAIN_HEADER) ? 1 : 0;
+  uint8_t first_address_byte = static_cast<uint8_t>(((address & 0x7F) << 1) | 1);
+  uint8_t address_byte = static_cast<uint8_t>(((address & 0x7F) << 1) | train_bit);
+  uint8_t index_byte = static_cast<uint8_t>(index);
+
+  uint8_t sum = first_address_byte + index_byte + address_byte + data;
+  uint8_t checksum = static_cast<uint8_t>(~sum);
+
+  frames[0] = TMCCFrame{header, static_cast<uint16_t>((first_address_byte << 8) | index_byte)};
+  frames[1] = TMCCFrame{TMCC2_MULTIWORD_HEADER, static_cast<uint16_t>((address_byte << 8) | data)};
+  frames[2] = TMCCFrame{TMCC2_MULTIWORD_HEADER, static_cast<uint16_t>((address_byte << 8) | checksum)};
 }
 
-uint16_t tmcc_engine_speed_word(uint8_t address, uint8_t speed) {
-  // Clamp speed to 0-31
-  if (speed > 31) {
-    speed = 31;
+// Legacy command codes (bits 8-0) that the frame classifiers look at
+static uint16_t legacy_command(uint16_t word) {
+  return word & 0x01FF;
+}
+
+static bool is_legacy_engine_or_train(uint8_t header) {
+  return header == TMCC2_ENGINE_HEADER || header == TMCC2_TRAIN_HEADER;
+}
+
+uint32_t tmcc_frame_object_key(uint8_t header, uint16_t word) {
+  if (header == TMCC2_MULTIWORD_HEADER) {
+    // Continuation frames carry the engine/train flag in bit 8
+    header = (word & TMCC2_COMMAND_BIT) ? TMCC2_TRAIN_HEADER : TMCC2_ENGINE_HEADER;
+  }
+  if (is_legacy_engine_or_train(header)) {
+    return (static_cast<uint32_t>(header) << 16) | (word & 0xFE00);
   }
-  return tmcc_make_word(TMCCObjectType::ENGINE, address, TMCCCommandClass::ABSOLUTE_SPEED, speed);
+  return (static_cast<uint32_t>(header) << 16) | (word & 0xFF80);
 }
 
-}  // namespace tmcc
+uint32_t tmcc_frame_command_key(uint8_t header, uint16_t word) {
+  if (is_legacy_engine_or_train(header)) {
+    // Absolute speed carries its value in bits 7-0; everything else is exact
+    if ((word & TMCC2_COMMAND_BIT) == 0) {
+      return (static_cast<uint32_t>(header) << 16) | (word & 0xFF00);
+    }
+    return (static_cast<uint32_t>(header) << 16) | word;
+  }
+  return (static_cast<uint32_t>(header) << 16) | (word & 0xFFE0);
+}
+
+bool tmcc_frame_is_absolute_speed(uint8_t header, uint16_t word) {
+  if (is_legacy_engine_or_train(header)) {
+    return (word & TMCC2_COMMAND_BIT) == 0;
+  }
+  return header == TMCC1_HEADER && is_engine_or_train_word(word) &&
+         static_cast<TMCCCommandClass>((word >> 5) & 0x03) == TMCCCommandClass::ABSOLUTE_SPEED;
+}
+
+bool tmcc_frame_is_motion(uint8_t header, uint16_t word) {
+  if (is_legacy_engine_or_train(header)) {
+    if ((word & TMCC2_COMMAND_BIT) == 0) {
+      return true;
+    }
+    uint16_t command = legacy_command(word);
+    return command == (TMCC2_COMMAND_BIT | static_cast<uint16_t>(TMCCEngineAction::FORWARD)) ||
+           command == (TMCC2_COMMAND_BIT | static_cast<uint16_t>(TMCCEngineAction::TOGGLE_DIRECTION)) ||
+           command == (TMCC2_COMMAND_BIT | static_cast<uint16_t>(TMCCEngineAction::REVERSE)) ||
+           command == (TMCC2_COMMAND_BIT | static_cast<uint16_t>(TMCCEngineAction::BOOST));
+  }
+  if (header != TMCC1_HEADER || !is_engine_or_train_word(word)) {
+    return false;
+  }
+
+  auto cmd_class = static_cast<TMCCCommandClass>((word >> 5) & 0x03);
+  if (cmd_class == TMCCCommandClass::ABSOLUTE_SPEED || cmd_class == TMCCCommandClass::RELATIVE_SPEED) {
+    return true;
+  }
+  if (cmd_class != TMCCCommandClass::ACTION) {
+    return false;
+  }
+
+  auto action = static_cast<TMCCEngineAction>(word & 0x1F);
+  return action == TMCCEngineAction::FORWARD || action == TMCCEngineAction::TOGGLE_DIRECTION ||
+         action == TMCCEngineAction::REVERSE || action == TMCCEngineAction::BOOST;
+}
+
+bool tmcc_frame_is_brake(uint8_t header, uint16_t word) {
+  if (is_legacy_engine_or_train(header)) {
+    return legacy_command(word) == (TMCC2_COMMAND_BIT | static_cast<uint16_t>(TMCCEngineAction::BRAKE));
+  }
+  if (header != TMCC1_HEADER || !is_engine_or_train_word(word)) {
+    return false;
+  }
+  auto cmd_class = static_cast<TMCCCommandClass>((word >> 5) & 0x03);
+  return cmd_class == TMCCCommandClass::ACTION && static_cast<TMCCEngineAction>(word & 0x1F) == TMCCEngineAction::BRAKE;
+}
 
+}  // namespace tmcc
@@ -7,6 +7,51 @@ namespace tmcc {
 // TMCC1 frame header byte
 static constexpr uint8_t TMCC1_HEADER = 0xFE;
 
+// Bytes in one frame on the wire: header + 16-bit word
+static constexpr uint8_t TMCC_FRAME_SIZE = 3;
+
+// Wire time of one frame at 9600 baud, 8N1 (30 bits)
+static constexpr uint32_t TMCC_FRAME_TIME_US = 3125;
+
+// System Halt word (all bits set) - stops every engine on the layout
+static constexpr uint16_t TMCC1_SYSTEM_HALT_WORD = 0xFFFF;
+
+// Highest train an engine can be assigned to with a TMCC1 extended command
+static constexpr uint8_t TMCC1_MAX_ASSIGN_TRAIN = 7;
+
+// Legacy (TMCC2) frame header bytes.
+// NOTE: Legacy frames are only understood by a Legacy command base reached
+// through an LCS SER2 or LCS WiFi module. A TMCC1-only base ignores them.
+static constexpr uint8_t TMCC2_ENGINE_HEADER = 0xF8;
+static constexpr uint8_t TMCC2_TRAIN_HEADER = 0xF9;
+static constexpr uint8_t TMCC2_MULTIWORD_HEADER = 0xFB;
+
+// Legacy absolute speed range (0-199)
+static constexpr uint8_t TMCC2_MAX_SPEED = 199;
+
+// Number of 3-byte frames in a Legacy multi-word parameter command
+static constexpr uint8_t TMCC2_PARAMETER_FRAME_COUNT = 3;
+
+// Legacy word bit 8: clear for absolute speed, set for all other commands
+static constexpr uint16_t TMCC2_COMMAND_BIT = 0x0100;
+
+// Number of distinct engine action codes (5-bit data field)
+static constexpr uint8_t TMCC_ENGINE_ACTION_COUNT = 32;
+
+// Command protocol spoken to an engine
+enum class TMCCProtocol : uint8_t {
+  TMCC1 = 0,   // 0xFE frames, 32 speed steps
+  LEGACY = 1,  // 0xF8/0xF9/0xFB frames, 200 speed steps (requires LCS SER2/WiFi)
+};
+
+/**
+ * One 3-byte frame on the wire: header byte + 16-bit word (high byte first).
+ */
+struct TMCCFrame {
+  uint8_t header;
+  uint16_t word;
+};
+
 // Object types for TMCC1 16-bit word construction
 // Bit patterns for bits 15-14 (or more for some types)
 enum class TMCCObjectType : uint8_t {
@@ -48,6 +93,37 @@ enum class TMCCEngineAction : uint8_t {
   BLOW_HORN2 = 0b11111,
 };
 
+// Switch (turnout) action codes (5-bit data field for ACTION command class)
+enum class TMCCSwitchAction : uint8_t {
+  THROW_THROUGH = 0b00000,
+  THROW_OUT = 0b11111,
+};
+
+// Accessory action codes (5-bit data field for ACTION command class)
+enum class TMCCAccessoryAction : uint8_t {
+  AUX1_OFF = 0b01000,
+  AUX1_OPTION1 = 0b01001,
+  AUX1_OPTION2 = 0b01010,
+  AUX1_ON = 0b01011,
+  AUX2_OFF = 0b01100,
+  AUX2_OPTION1 = 0b01101,
+  AUX2_OPTION2 = 0b01110,
+  AUX2_ON = 0b01111,
+};
+
+// Route action codes (5-bit data field for ACTION command class)
+enum class TMCCRouteAction : uint8_t {
+  THROW = 0b11111,  // Throw every switch of a route stored in the command base
+};
+
+// Legacy multi-word parameter index (third byte of the first word)
+enum class TMCC2ParameterIndex : uint8_t {
+  DIALOG = 0x72,
+  EFFECT = 0x74,
+  MASK = 0x76,
+  LIGHTING = 0x7C,
+};
+
 // Extended command codes (5-bit data field for EXTENDED command class)
 enum class TMCCExtendedCommand : uint8_t {
   ASSIGN_TO_TRAIN = 0b00000,
@@ -58,6 +134,39 @@ enum class TMCCExtendedCommand : uint8_t {
   // Add more as needed
 };
 
+// Position of an engine in a lash-up, for the extended "assign unit"
+// command: 1 0 R P P (R = unit runs reversed, PP = position)
+enum class TMCCTrainUnit : uint8_t {
+  SINGLE = 0b00,
+  HEAD = 0b01,
+  MIDDLE = 0b10,
+  REAR = 0b11,
+};
+
+/**
+ * Fields of a TMCC1 command word, as produced by tmcc_decode_word().
+ */
+struct TMCCDecodedWord {
+  TMCCObjectType type;
+  uint8_t address;
+  TMCCCommandClass cmd_class;
+  uint8_t data;
+};
+
+/**
+ * Pre-encoded frames for one engine or train, built once when its address
+ * or protocol is set. Sending a command is then a table lookup.
+ */
+struct TMCCEngineFrameTable {
+  uint8_t header;                                      // TMCC1_HEADER, TMCC2_ENGINE_HEADER or TMCC2_TRAIN_HEADER
+  uint16_t action_words[TMCC_ENGINE_ACTION_COUNT];     // Indexed by TMCCEngineAction
+  uint16_t speed_base;                                 // Absolute speed word = speed_base | speed
+};
+
+// The word encoders below are constexpr so that frames can be built (and
+// their layouts checked with static_assert) at compile time. They are
+// defined here because constexpr functions must be visible to callers.
+
 /**
  * Build a TMCC1 16-bit command word.
  *
@@ -73,7 +182,24 @@ enum class TMCCExtendedCommand : uint8_t {
  * @param data 5-bit data field (0-31)
  * @return 16-bit TMCC1 command word
  */
-uint16_t tmcc_make_word(TMCCObjectType type, uint8_t address, TMCCCommandClass cmd_class, uint8_t data);
+constexpr uint16_t tmcc_make_word(TMCCObjectType type, uint8_t address, TMCCCommandClass cmd_class,
+                                  uint8_t data) {
+  // Type prefix | address (masked to the type's width) | class | 5-bit data
+  return static_cast<uint16_t>(
+      (type == TMCCObjectType::ENGINE      ? (0b00 << 14) | ((address & 0x7F) << 7)
+       : type == TMCCObjectType::SWITCH    ? (0b01 << 14) | ((address & 0x7F) << 7)
+       : type == TMCCObjectType::ACCESSORY ? (0b10 << 14) | ((address & 0x7F) << 7)
+       : type == TMCCObjectType::TRAIN     ? (0b11001 << 11) | ((address & 0x0F) << 7)
+                                           : (0b1101 << 12) | ((address & 0x1F) << 7)) |
+      (static_cast<uint8_t>(cmd_class) << 5) | (data & 0x1F));
+}
+
+/**
+ * Highest address an object type can carry in a TMCC1 word.
+ */
+constexpr uint8_t tmcc_max_address(TMCCObjectType type) {
+  return type == TMCCObjectType::TRAIN ? 0x0F : type == TMCCObjectType::ROUTE ? 0x1F : 0x7F;
+}
 
 /**
  * Build an engine action command word.
@@ -82,7 +208,9 @@ uint16_t tmcc_make_word(TMCCObjectType type, uint8_t address, TMCCCommandClass c
  * @param action Engine action code
  * @return 16-bit TMCC1 command word
  */
-uint16_t tmcc_engine_action_word(uint8_t address, TMCCEngineAction action);
+constexpr uint16_t tmcc_engine_action_word(uint8_t address, TMCCEngineAction action) {
+  return tmcc_make_word(TMCCObjectType::ENGINE, address, TMCCCommandClass::ACTION, static_cast<uint8_t>(action));
+}
 
 /**
  * Build an engine absolute speed command word.
@@ -91,6 +219,229 @@ uint16_t tmcc_engine_action_word(uint8_t address, TMCCEngineAction action);
  * @param speed Speed step (0-31)
  * @return 16-bit TMCC1 command word
  */
-uint16_t tmcc_engine_speed_word(uint8_t address, uint8_t speed);
+constexpr uint16_t tmcc_engine_speed_word(uint8_t address, uint8_t speed) {
+  // Clamp speed to 0-31
+  return tmcc_make_word(TMCCObjectType::ENGINE, address, TMCCCommandClass::ABSOLUTE_SPEED, speed > 31 ? 31 : speed);
+}
+
+/**
+ * Build a train (lash-up) action command word. Engines assigned to the
+ * train all act on this single word.
+ *
+ * @param train Train address (0-15)
+ * @param action Action code (same codes as engines)
+ * @return 16-bit TMCC1 command word
+ */
+constexpr uint16_t tmcc_train_action_word(uint8_t train, TMCCEngineAction action) {
+  return tmcc_make_word(TMCCObjectType::TRAIN, train, TMCCCommandClass::ACTION, static_cast<uint8_t>(action));
+}
+
+/**
+ * Build a train (lash-up) absolute speed command word.
+ *
+ * @param train Train address (0-15)
+ * @param speed Speed step (0-31)
+ * @return 16-bit TMCC1 command word
+ */
+constexpr uint16_t tmcc_train_speed_word(uint8_t train, uint8_t speed) {
+  return tmcc_make_word(TMCCObjectType::TRAIN, train, TMCCCommandClass::ABSOLUTE_SPEED, speed > 31 ? 31 : speed);
+}
+
+/**
+ * Build the extended command that assigns an engine to a train.
+ *
+ * The train shares the data field with the other extended commands:
+ * trains 8-11 would read as MOMENTUM_LOW..SET_ADDRESS. The train is
+ * masked to 3 bits so the word can never be one of those.
+ *
+ * @param address Engine address (0-127)
+ * @param train Train address (0-TMCC1_MAX_ASSIGN_TRAIN)
+ * @return 16-bit TMCC1 command word
+ */
+constexpr uint16_t tmcc_engine_assign_train_word(uint8_t address, uint8_t train) {
+  return tmcc_make_word(TMCCObjectType::ENGINE, address, TMCCCommandClass::EXTENDED,
+                        static_cast<uint8_t>(TMCCExtendedCommand::ASSIGN_TO_TRAIN) | (train & TMCC1_MAX_ASSIGN_TRAIN));
+}
+
+/**
+ * Build the extended command that sets an engine's position and direction
+ * within its train.
+ *
+ * @param address Engine address (0-127)
+ * @param unit Position in the lash-up
+ * @param reversed True if the unit runs backwards relative to the train
+ * @return 16-bit TMCC1 command word
+ */
+constexpr uint16_t tmcc_engine_unit_word(uint8_t address, TMCCTrainUnit unit, bool reversed) {
+  return tmcc_make_word(TMCCObjectType::ENGINE, address, TMCCCommandClass::EXTENDED,
+                        0b10000 | (reversed ? 0b00100 : 0) | static_cast<uint8_t>(unit));
+}
+
+/**
+ * Build a switch (turnout) command word.
+ *
+ * @param address Switch address (0-127)
+ * @param action Throw through or out
+ * @return 16-bit TMCC1 command word
+ */
+constexpr uint16_t tmcc_switch_word(uint8_t address, TMCCSwitchAction action) {
+  return tmcc_make_word(TMCCObjectType::SWITCH, address, TMCCCommandClass::ACTION, static_cast<uint8_t>(action));
+}
+
+/**
+ * Build an accessory command word.
+ *
+ * @param address Accessory address (0-127)
+ * @param action Accessory action code
+ * @return 16-bit TMCC1 command word
+ */
+constexpr uint16_t tmcc_accessory_word(uint8_t address, TMCCAccessoryAction action) {
+  return tmcc_make_word(TMCCObjectType::ACCESSORY, address, TMCCCommandClass::ACTION, static_cast<uint8_t>(action));
+}
+
+/**
+ * Build a route command word.
+ *
+ * @param address Route address (0-31)
+ * @param action Route action code
+ * @return 16-bit TMCC1 command word
+ */
+constexpr uint16_t tmcc_route_word(uint8_t address, TMCCRouteAction action) {
+  return tmcc_make_word(TMCCObjectType::ROUTE, address, TMCCCommandClass::ACTION, static_cast<uint8_t>(action));
+}
+
+/**
+ * Split a TMCC1 16-bit command word into its fields; the inverse of
+ * tmcc_make_word().
+ *
+ * @param word 16-bit TMCC1 command word
+ * @param decoded Receives type, address, command class and data
+ * @return false if the word matches no object type (e.g. System Halt)
+ */
+bool tmcc_decode_word(uint16_t word, TMCCDecodedWord *decoded);
+
+/**
+ * Build a Legacy engine or train command word.
+ *
+ * Format: A A A A A A A C D D D D D D D D
+ *   - Bits 15-9: 7-bit address (1-99 on a Legacy base)
+ *   - Bit 8:     0 for absolute speed, 1 for every other command
+ *   - Bits 7-0:  speed step or command code
+ *
+ * @param address 7-bit engine/train address
+ * @param command 9-bit command (bit 8 + data)
+ * @return 16-bit Legacy command word (send after TMCC2_ENGINE_HEADER or TMCC2_TRAIN_HEADER)
+ */
+constexpr uint16_t tmcc2_make_word(uint8_t address, uint16_t command) {
+  return static_cast<uint16_t>(((address & 0x7F) << 9) | (command & 0x01FF));
+}
+
+/**
+ * Build a Legacy absolute speed command word.
+ *
+ * @param address Engine address
+ * @param speed Speed step (0-199)
+ * @return 16-bit Legacy command word
+ */
+constexpr uint16_t tmcc2_engine_speed_word(uint8_t address, uint8_t speed) {
+  // Clamp speed to 0-199; bit 8 stays clear for absolute speed
+  return tmcc2_make_word(address, speed > TMCC2_MAX_SPEED ? TMCC2_MAX_SPEED : speed);
+}
+
+/**
+ * Build a Legacy engine action command word. Legacy reuses the TMCC1 action
+ * codes with bit 8 set.
+ *
+ * @param address Engine address
+ * @param action Engine action code
+ * @return 16-bit Legacy command word
+ */
+constexpr uint16_t tmcc2_engine_action_word(uint8_t address, TMCCEngineAction action) {
+  return tmcc2_make_word(address, TMCC2_COMMAND_BIT | static_cast<uint8_t>(action));
+}
+
+/**
+ * Pre-encode every action word and the speed base for one engine or train.
+ *
+ * @param type TMCCObjectType::ENGINE or TMCCObjectType::TRAIN
+ * @param address Engine or train address
+ * @param protocol TMCC1 or Legacy
+ * @param table Receives the encoded frames
+ */
+void tmcc_build_frame_table(TMCCObjectType type, uint8_t address, TMCCProtocol protocol,
+                            TMCCEngineFrameTable *table);
+
+/**
+ * Build a Legacy multi-word parameter command: three frames that must be
+ * sent back to back.
+ *
+ *   Frame 1: 0xF8/0xF9  A A A A A A A 1  parameter index
+ *   Frame 2: 0xFB       A A A A A A A E  data
+ *   Frame 3: 0xFB       A A A A A A A E  checksum
+ *
+ * E is 0 for an engine and 1 for a train. The checksum is the one's
+ * complement of the 8-bit sum of the address and data bytes of frames 1
+ * and 2.
+ *
+ * @param header TMCC2_ENGINE_HEADER or TMCC2_TRAIN_HEADER
+ * @param address Engine/train address
+ * @param index Parameter index
+ * @param data Parameter data byte
+ * @param frames Receives TMCC2_PARAMETER_FRAME_COUNT frames
+ */
+void tmcc2_make_parameter_frames(uint8_t header, uint8_t address, TMCC2ParameterIndex index, uint8_t data,
+                                 TMCCFrame *frames);
+
+/**
+ * Get the object a frame addresses, as a key combining the protocol family
+ * and the type and address bits. Two frames address the same engine,
+ * switch, accessory, train or route exactly when their object keys match.
+ * Legacy multi-word continuation frames (0xFB) map to their engine or train.
+ *
+ * @param header Frame header byte
+ * @param word 16-bit command word
+ * @return Object key
+ */
+uint32_t tmcc_frame_object_key(uint8_t header, uint16_t word);
+
+/**
+ * Get the command part of a frame: the object key plus the command, with the
+ * value masked off for speed commands. Two frames with equal command keys
+ * carry the same command for the same object and differ only in value.
+ *
+ * @param header Frame header byte
+ * @param word 16-bit command word
+ * @return Command key
+ */
+uint32_t tmcc_frame_command_key(uint8_t header, uint16_t word);
+
+/**
+ * Check whether a frame is an engine or train absolute speed command.
+ *
+ * @param header Frame header byte
+ * @param word 16-bit command word
+ * @return true for TMCC1 or Legacy engine/train absolute speed
+ */
+bool tmcc_frame_is_absolute_speed(uint8_t header, uint16_t word);
+
+/**
+ * Check whether a frame changes how an engine or train moves: absolute or
+ * relative speed, direction, or boost. These are the commands a System Halt
+ * or brake makes stale.
+ *
+ * @param header Frame header byte
+ * @param word 16-bit command word
+ * @return true for engine/train motion commands
+ */
+bool tmcc_frame_is_motion(uint8_t header, uint16_t word);
+
+/**
+ * Check whether a frame is an engine or train brake action.
+ *
+ * @param header Frame header byte
+ * @param word 16-bit command word
+ * @return true for engine/train BRAKE
+ */
+bool tmcc_frame_is_brake(uint8_t header, uint16_t word);
 
 }  // namespace tmcc
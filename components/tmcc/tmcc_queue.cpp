@@ -0,0 +1,341 @@
+#include "tmcc_queue.h"
+
+#include <new>
+
+namespace tmcc {
+
+TMCCTxQueue::~TMCCTxQueue() {
+  delete[] this->entries_;
+}
+
+bool TMCCTxQueue::init(size_t capacity) {
+  delete[] this->entries_;
+  this->entries_ = new (std::nothrow) TMCCTxEntry[capacity];
+  if (this->entries_ == nullptr) {
+    this->capacity_ = 0;
+    return false;
+  }
+  this->capacity_ = capacity;
+  this->clear();
+  return true;
+}
+
+bool TMCCTxQueue::push(const TMCCTxEntry &entry) {
+  if (this->full()) {
+    return false;
+  }
+  size_t tail = (this->head_ + this->count_) % this->capacity_;
+  this->entries_[tail] = entry;
+  this->count_++;
+  return true;
+}
+
+bool TMCCTxQueue::push_chain(const TMCCTxEntry *entries, size_t count) {
+  if (count == 0 || this->capacity_ - this->count_ < count) {
+    return false;
+  }
+  for (size_t i = 0; i < count; i++) {
+    TMCCTxEntry entry = entries[i];
+    entry.flags |= TMCC_TX_FLAG_CHAINED;
+    if (i + 1 < count) {
+      entry.flags |= TMCC_TX_FLAG_CHAIN_NEXT;
+    }
+    this->push(entry);
+  }
+  return true;
+}
+
+bool TMCCTxQueue::coalesce(const TMCCTxEntry &entry) {
+  uint32_t object_key = tmcc_frame_object_key(entry.header, entry.word);
+  for (size_t i = this->count_; i > 0; i--) {
+    TMCCTxEntry &queued = this->at_(i - 1);
+    if (tmcc_frame_object_key(queued.header, queued.word) != object_key) {
+      continue;
+    }
+    // Newest entry for this object decides: replace it or keep ordering
+    if (tmcc_frame_command_key(queued.header, queued.word) != tmcc_frame_command_key(entry.header, entry.word) ||
+        queued.priority != entry.priority || queued.repetitions != entry.repetitions ||
+        (queued.flags & TMCC_TX_FLAG_STARTED) != 0) {
+      return false;
+    }
+    queued.word = entry.word;
+    return true;
+  }
+  return false;
+}
+
+bool TMCCTxQueue::update_stream(uint8_t header, uint16_t word, uint32_t until_ms) {
+  for (size_t i = 0; i < this->count_; i++) {
+    TMCCTxEntry &entry = this->at_(i);
+    if ((entry.flags & TMCC_TX_FLAG_STREAM) != 0 && entry.header == header && entry.word == word) {
+      entry.until_ms = until_ms;
+      return true;
+    }
+  }
+  return false;
+}
+
+// Wrap-safe "now is at or after at" for millis() timestamps
+static bool time_reached(uint32_t now_ms, uint32_t at_ms) {
+  return static_cast<int32_t>(now_ms - at_ms) >= 0;
+}
+
+// A stream waiting for its next slot is not eligible to send
+static bool stream_waiting(const TMCCTxEntry &entry, uint32_t now_ms) {
+  return (entry.flags & TMCC_TX_FLAG_STREAM) != 0 && !time_reached(now_ms, entry.due_ms);
+}
+
+bool TMCCTxQueue::take_frame(uint32_t now_ms, TMCCTxEntry *frame, uint32_t *wait_ms) {
+  *wait_ms = UINT32_MAX;
+
+  // Drop streams whose time is up; they have nothing left to send
+  size_t index = 0;
+  while (index < this->count_) {
+    const TMCCTxEntry &entry = this->at_(index);
+    if ((entry.flags & TMCC_TX_FLAG_STREAM) != 0 && time_reached(now_ms, entry.until_ms)) {
+      this->remove_at_(index);
+    } else {
+      index++;
+    }
+  }
+
+  // Highest priority among eligible entries. For waiting streams, remember
+  // the earliest slot so the writer knows how long it may sleep.
+  bool any = false;
+  TMCCPriority top = TMCCPriority::NORMAL;
+  size_t resume = this->count_;
+  for (size_t i = 0; i < this->count_; i++) {
+    const TMCCTxEntry &entry = this->at_(i);
+    if ((entry.flags & TMCC_TX_FLAG_CHAIN_RESUME) != 0) {
+      resume = i;
+    }
+    if (this->continues_chain_(i)) {
+      continue;
+    }
+    if (stream_waiting(entry, now_ms)) {
+      uint32_t wait = entry.due_ms - now_ms;
+      if (wait < *wait_ms) {
+        *wait_ms = wait;
+      }
+      continue;
+    }
+    if (!any || entry.priority > top) {
+      top = entry.priority;
+    }
+    any = true;
+  }
+
+  // Finish an open chain first: its next frame was flagged when the
+  // previous one was taken. None is left if a halt removed the rest.
+  if (resume != this->count_) {
+    TMCCTxEntry &entry = this->at_(resume);
+    if ((entry.flags & TMCC_TX_FLAG_PREEMPTIBLE) == 0 || !any || top <= entry.priority) {
+      entry.flags &= ~TMCC_TX_FLAG_CHAIN_RESUME;
+      this->last_object_key_ = tmcc_frame_object_key(entry.header, entry.word);
+      this->take_at_(resume, now_ms, frame);
+      return true;
+    }
+  }
+  if (!any) {
+    return false;
+  }
+
+  // Round-robin: the smallest object key after the one served last, wrapping
+  // to the smallest key overall. The first match in FIFO order is that
+  // object's oldest entry. No per-object state is kept, so cost does not
+  // depend on how many engines are configured.
+  size_t best = this->count_;
+  size_t lowest = this->count_;
+  uint32_t best_key = 0;
+  uint32_t lowest_key = 0;
+  for (size_t i = 0; i < this->count_; i++) {
+    const TMCCTxEntry &entry = this->at_(i);
+    if (entry.priority != top || stream_waiting(entry, now_ms) || this->continues_chain_(i)) {
+      continue;
+    }
+    uint32_t key = tmcc_frame_object_key(entry.header, entry.word);
+    if (lowest == this->count_ || key < lowest_key) {
+      lowest = i;
+      lowest_key = key;
+    }
+    if (key > this->last_object_key_ && (best == this->count_ || key < best_key)) {
+      best = i;
+      best_key = key;
+    }
+  }
+  if (best == this->count_) {
+    best = lowest;
+    best_key = lowest_key;
+  }
+  this->last_object_key_ = best_key;
+
+  // A stream that is already sounding does not hold up the object's later
+  // commands: a newer plain entry goes first, and the stream resumes once
+  // the object has nothing else to send
+  if ((this->at_(best).flags & (TMCC_TX_FLAG_STREAM | TMCC_TX_FLAG_STARTED)) ==
+      (TMCC_TX_FLAG_STREAM | TMCC_TX_FLAG_STARTED)) {
+    for (size_t i = best + 1; i < this->count_; i++) {
+      const TMCCTxEntry &entry = this->at_(i);
+      if (entry.priority == top && (entry.flags & TMCC_TX_FLAG_STREAM) == 0 && !this->continues_chain_(i) &&
+          tmcc_frame_object_key(entry.header, entry.word) == best_key) {
+        best = i;
+        break;
+      }
+    }
+  }
+
+  this->take_at_(best, now_ms, frame);
+  return true;
+}
+
+void TMCCTxQueue::take_at_(size_t index, uint32_t now_ms, TMCCTxEntry *frame) {
+  TMCCTxEntry &entry = this->at_(index);
+  *frame = entry;
+  bool chain_next = (entry.flags & TMCC_TX_FLAG_CHAIN_NEXT) != 0;
+  if ((entry.flags & TMCC_TX_FLAG_STREAM) != 0) {
+    // Streams stay queued until their deadline; schedule the next slot
+    entry.due_ms = now_ms + entry.interval_ms;
+    entry.flags |= TMCC_TX_FLAG_STARTED;
+  } else if (entry.repetitions > 1) {
+    entry.repetitions--;
+    entry.flags |= TMCC_TX_FLAG_STARTED;
+    if (chain_next) {
+      // Repeat this frame before moving on to the rest of the chain
+      entry.flags |= TMCC_TX_FLAG_CHAIN_RESUME;
+    }
+  } else {
+    this->remove_at_(index);
+    // Chains are queued contiguously, so the next frame moved into `index`
+    if (chain_next && index < this->count_) {
+      this->at_(index).flags |= TMCC_TX_FLAG_CHAIN_RESUME;
+    }
+  }
+}
+
+bool TMCCTxQueue::evict_oldest(TMCCPriority max_priority) {
+  for (size_t i = 0; i < this->count_; i++) {
+    const TMCCTxEntry &entry = this->at_(i);
+    if (entry.priority <= max_priority && (entry.flags & TMCC_TX_FLAG_CHAINED) == 0) {
+      this->remove_at_(i);
+      return true;
+    }
+  }
+  return false;
+}
+
+bool TMCCTxQueue::evict_for_halt() {
+  if (this->evict_oldest(TMCCPriority::NORMAL) || this->evict_oldest(TMCCPriority::HIGH)) {
+    return true;
+  }
+  // Only chains are left besides halts. A chain's entries are contiguous,
+  // so the oldest chained entry starts the oldest command.
+  for (size_t i = 0; i < this->count_; i++) {
+    const TMCCTxEntry &entry = this->at_(i);
+    if ((entry.flags & TMCC_TX_FLAG_CHAINED) == 0) {
+      continue;
+    }
+    // If the writer was in the middle of it, take_frame() finds nothing left
+    // to finish and carries on with the rest of the queue
+    bool more;
+    do {
+      more = (this->at_(i).flags & TMCC_TX_FLAG_CHAIN_NEXT) != 0;
+      this->remove_at_(i);
+    } while (more && i < this->count_);
+    return true;
+  }
+  return false;
+}
+
+size_t TMCCTxQueue::remove_if(bool (*predicate)(const TMCCTxEntry &entry, uint32_t arg), uint32_t arg) {
+  size_t removed = 0;
+  size_t i = 0;
+  while (i < this->count_) {
+    if (predicate(this->at_(i), arg)) {
+      this->remove_at_(i);
+      removed++;
+    } else {
+      i++;
+    }
+  }
+  return removed;
+}
+
+size_t TMCCTxQueue::remove_chains_if(bool (*predicate)(const TMCCTxEntry &entry, uint32_t arg), uint32_t arg) {
+  size_t removed = 0;
+  size_t i = 0;
+  while (i < this->count_) {
+    const TMCCTxEntry &first = this->at_(i);
+    if ((first.flags & TMCC_TX_FLAG_CHAINED) == 0) {
+      i++;
+      continue;
+    }
+    // The chain runs up to its first entry without TMCC_TX_FLAG_CHAIN_NEXT
+    size_t end = i;
+    bool match = false;
+    bool more;
+    do {
+      const TMCCTxEntry &entry = this->at_(end);
+      match |= predicate(entry, arg);
+      more = (entry.flags & TMCC_TX_FLAG_CHAIN_NEXT) != 0;
+      end++;
+    } while (more && end < this->count_);
+    // What is left of a started chain begins at its resume frame; take_frame()
+    // finds nothing to resume if it goes
+    bool started = (first.flags & (TMCC_TX_FLAG_STARTED | TMCC_TX_FLAG_CHAIN_RESUME)) != 0;
+    if (!match || (started && (first.flags & TMCC_TX_FLAG_PREEMPTIBLE) == 0)) {
+      i = end;
+      continue;
+    }
+    for (size_t k = i; k < end; k++) {
+      this->remove_at_(i);
+    }
+    removed += end - i;
+  }
+  return removed;
+}
+
+void TMCCTxQueue::clear() {
+  this->head_ = 0;
+  this->count_ = 0;
+}
+
+size_t TMCCTxQueue::size() const {
+  return this->count_;
+}
+
+size_t TMCCTxQueue::capacity() const {
+  return this->capacity_;
+}
+
+bool TMCCTxQueue::empty() const {
+  return this->count_ == 0;
+}
+
+bool TMCCTxQueue::full() const {
+  return this->count_ >= this->capacity_;
+}
+
+TMCCTxEntry &TMCCTxQueue::at_(size_t index) {
+  return this->entries_[(this->head_ + index) % this->capacity_];
+}
+
+bool TMCCTxQueue::continues_chain_(size_t index) {
+  // Chains are contiguous: an earlier frame of the chain either sits just
+  // before this one or has already been taken, flagging this one to resume
+  return (this->at_(index).flags & TMCC_TX_FLAG_CHAIN_RESUME) != 0 ||
+         (index > 0 && (this->at_(index - 1).flags & TMCC_TX_FLAG_CHAIN_NEXT) != 0);
+}
+
+void TMCCTxQueue::remove_at_(size_t index) {
+  if (index == 0) {
+    this->head_ = (this->head_ + 1) % this->capacity_;
+  } else {
+    // Close the gap by shifting the newer entries back one slot
+    for (size_t i = index; i + 1 < this->count_; i++) {
+      this->at_(i) = this->at_(i + 1);
+    }
+  }
+  this->count_--;
+}
+
+}  // namespace tmcc
@@ -0,0 +1,152 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "tmcc_protocol.h"
+
+namespace tmcc {
+
+// What to do when a frame is enqueued while the TX queue is full
+enum class TMCCDropPolicy : uint8_t {
+  DROP_NEWEST = 0,  // Reject the frame being enqueued
+  DROP_OLDEST = 1,  // Evict the oldest queued frame to make room
+};
+
+// Transmit priority. Higher priorities always go out first; the writer
+// re-evaluates at every frame boundary, so a HALT never waits for more
+// than the frame already on the wire.
+enum class TMCCPriority : uint8_t {
+  NORMAL = 0,  // Speed, direction, horn, bell, ...
+  HIGH = 1,    // Brake
+  HALT = 2,    // System Halt
+};
+
+// TMCCTxEntry::flags
+static constexpr uint8_t TMCC_TX_FLAG_STARTED = 0x01;  // At least one repetition is already on the wire
+static constexpr uint8_t TMCC_TX_FLAG_STREAM = 0x02;   // Repeat every interval_ms until until_ms
+static constexpr uint8_t TMCC_TX_FLAG_CHAINED = 0x04;  // Part of a multi-frame command (pushed with push_chain)
+static constexpr uint8_t TMCC_TX_FLAG_CHAIN_NEXT = 0x08;  // Another frame of the same command must follow
+static constexpr uint8_t TMCC_TX_FLAG_CHAIN_RESUME = 0x10;  // Next frame of the chain being sent
+static constexpr uint8_t TMCC_TX_FLAG_PREEMPTIBLE = 0x20;   // Chain yields to higher priorities between frames
+
+/**
+ * A single pending transmission: one frame sent `repetitions` times.
+ *
+ * A stream entry (TMCC_TX_FLAG_STREAM) instead sends one frame per slot,
+ * at most every `interval_ms`, until `until_ms`. Held horns and whistles
+ * use streams so that other engines' frames interleave between repeats.
+ */
+struct TMCCTxEntry {
+  uint8_t header;        // TMCC1_HEADER, or a Legacy header
+  uint16_t word;
+  uint8_t repetitions;
+  TMCCPriority priority;
+  uint8_t flags;
+  uint16_t interval_ms;  // Stream only: minimum time between frames
+  uint32_t due_ms;       // Stream only: millis() of the next slot
+  uint32_t until_ms;     // Stream only: millis() at which the stream ends
+  uint32_t enqueued_us;  // micros() when the entry was queued, for latency measurement
+};
+
+/**
+ * TMCCTxQueue - Bounded priority queue of pending TX entries.
+ *
+ * Entries are kept in FIFO order in a ring buffer. Within a priority level
+ * the wire is shared round-robin between objects (engines, trains, ...):
+ * each frame goes to the next object key after the one served last, so a
+ * long burst for one engine is interleaved with other engines' commands.
+ * A chain (push_chain) takes part in the rotation by its first frame only.
+ * Commands for the same object always go out in the order they were queued,
+ * except that a stream which has started sounding lets the object's newer
+ * commands go ahead of its next slot.
+ * Once its first frame is out, the rest of a chain follows back to back, in
+ * the order queued, even ahead of a higher priority frame; a chain flagged
+ * TMCC_TX_FLAG_PREEMPTIBLE only keeps lower and equal priorities out. A chain
+ * may span several objects.
+ * Storage is allocated once by init() and never grows afterwards.
+ * The queue is not thread-safe on its own; TMCCBus guards every access
+ * with the mutex it shares with the UART writer task.
+ */
+class TMCCTxQueue {
+ public:
+  TMCCTxQueue() = default;
+  ~TMCCTxQueue();
+
+  TMCCTxQueue(const TMCCTxQueue &) = delete;
+  TMCCTxQueue &operator=(const TMCCTxQueue &) = delete;
+
+  // Allocate storage for `capacity` entries. Returns false on allocation failure.
+  bool init(size_t capacity);
+
+  // Append an entry at the tail. Returns false if the queue is full.
+  bool push(const TMCCTxEntry &entry);
+
+  // Append `count` entries that must go out back to back, all or nothing:
+  // a multi-frame command or a batch. The entries are flagged as a chain,
+  // keeping the flags they already have. Returns false if they do not fit.
+  bool push_chain(const TMCCTxEntry *entries, size_t count);
+
+  // Latest-wins coalescing: if the newest queued entry for the same object is
+  // an unsent entry with the same command key, overwrite its word with
+  // `entry.word` in place and return true. Only the newest entry for the
+  // object is considered, so the order relative to other commands for the
+  // same object is preserved. Returns false if `entry` must be pushed instead.
+  bool coalesce(const TMCCTxEntry &entry);
+
+  // Move the deadline of the queued stream for `header`/`word` to `until_ms`.
+  // Returns false if no such stream is queued.
+  bool update_stream(uint8_t header, uint16_t word, uint32_t until_ms);
+
+  // Take one frame from the highest-priority entry, rotating between objects
+  // within that priority (oldest entry first for each object). `frame` receives a
+  // copy of the entry as it was before this frame; the queued entry loses one
+  // repetition and is removed once all repetitions are taken. Streams that
+  // have ended are removed, and streams waiting for their next slot are skipped.
+  // Returns false if nothing can be sent at `now_ms`; `wait_ms` then holds the
+  // time until the next stream slot (UINT32_MAX if there is none).
+  bool take_frame(uint32_t now_ms, TMCCTxEntry *frame, uint32_t *wait_ms);
+
+  // Evict the oldest entry whose priority is at most `max_priority`. Chained
+  // entries are never evicted. Returns false if there is no such entry.
+  bool evict_oldest(TMCCPriority max_priority);
+
+  // Make room for a System Halt: evict the oldest entry below HALT priority,
+  // preferring normal entries, then brakes, then the oldest multi-frame
+  // command as a whole. Returns false only if every entry is a halt.
+  bool evict_for_halt();
+
+  // Remove every entry for which `predicate(entry, arg)` is true.
+  // Returns the number of entries removed.
+  size_t remove_if(bool (*predicate)(const TMCCTxEntry &entry, uint32_t arg), uint32_t arg);
+  // Remove every chain that has an entry for which `predicate(entry, arg)`
+  // is true, as a whole. A started chain loses only its unsent frames, and
+  // is kept if it is not preemptible. Returns the number of entries removed.
+  size_t remove_chains_if(bool (*predicate)(const TMCCTxEntry &entry, uint32_t arg), uint32_t arg);
+
+  void clear();
+
+  size_t size() const;
+  size_t capacity() const;
+  bool empty() const;
+  bool full() const;
+
+ protected:
+  // Entry at logical position `index` (0 = oldest)
+  TMCCTxEntry &at_(size_t index);
+  // Remove the entry at logical position `index`, keeping order of the rest
+  void remove_at_(size_t index);
+  // True if the entry at `index` follows an earlier frame of its chain
+  bool continues_chain_(size_t index);
+  // Copy one frame of the entry at `index` into `frame` and update or
+  // remove the entry, as take_frame() describes
+  void take_at_(size_t index, uint32_t now_ms, TMCCTxEntry *frame);
+
+  TMCCTxEntry *entries_{nullptr};
+  size_t capacity_{0};
+  size_t head_{0};
+  size_t count_{0};
+  uint32_t last_object_key_{0};  // Object served by the previous frame, for round-robin
+};
+
+}  // namespace tmcc
@@ -0,0 +1,259 @@
+#include "tmcc_recorder.h"
+#include "esphome/core/log.h"
+#include "esphome/core/hal.h"
+
+namespace tmcc {
+
+static const char *const TAG = "tmcc.recorder";
+
+// Bytes per hex line of dump()
+static const size_t DUMP_LINE_BYTES = 32;
+
+// ============================================================================
+// TMCCRecorder implementation
+// ============================================================================
+
+void TMCCRecorder::setup() {
+  if (this->bus_ == nullptr) {
+    ESP_LOGE(TAG, "TMCCBus not configured!");
+    this->mark_failed();
+    return;
+  }
+  if (!this->recording_.init(this->size_)) {
+    ESP_LOGE(TAG, "Failed to allocate recording buffer (%zu bytes)", this->size_);
+    this->mark_failed();
+    return;
+  }
+  // A halt must not be followed by the rest of a replay
+  this->bus_->add_on_halt_callback([this]() { this->stop_replay(); });
+  this->publish_states_();
+}
+
+void TMCCRecorder::loop() {
+  if (!this->replaying_) {
+    return;
+  }
+  uint32_t now_us = esphome::micros();
+  this->elapsed_us_ += now_us - this->last_loop_us_;
+  this->last_loop_us_ = now_us;
+
+  while (this->have_next_ && this->elapsed_us_ >= this->next_due_us_) {
+    // The frames of a multi-frame command are sent as one unit, as recorded
+    TMCCFrame frames[TMCC2_PARAMETER_FRAME_COUNT];
+    size_t count = 0;
+    uint8_t repetitions;
+    bool chain_next;
+    do {
+      frames[count].header = this->next_frame_.header;
+      frames[count].word = this->next_frame_.word;
+      count++;
+      repetitions = this->next_frame_.repetitions;
+      chain_next = this->next_frame_.chain_next;
+      this->have_next_ = this->read_next_();
+    } while (chain_next && this->have_next_ && count < TMCC2_PARAMETER_FRAME_COUNT);
+
+    if (count == 1) {
+      this->bus_->send_frame_repeated(frames[0].header, frames[0].word, repetitions);
+    } else {
+      this->bus_->send_tmcc2_frames(frames, count);
+    }
+    this->frames_replayed_ += count;
+  }
+
+  if (!this->have_next_) {
+    ESP_LOGI(TAG, "Replay finished: %u frames in %u ms", this->frames_replayed_,
+             static_cast<uint32_t>(this->elapsed_us_ / 1000));
+    this->stop_replay();
+  }
+}
+
+void TMCCRecorder::dump_config() {
+  ESP_LOGCONFIG(TAG, "TMCC Recorder:");
+  ESP_LOGCONFIG(TAG, "  Size: %zu bytes", this->size_);
+  ESP_LOGCONFIG(TAG, "  Recorded: %u commands, %zu bytes", this->recording_.get_record_count(),
+                this->recording_.size());
+  LOG_SWITCH("  ", "Record Switch", this->record_switch_);
+  LOG_SWITCH("  ", "Replay Switch", this->replay_switch_);
+}
+
+void TMCCRecorder::set_bus(TMCCBus *bus) {
+  this->bus_ = bus;
+}
+
+void TMCCRecorder::set_size(size_t size) {
+  this->size_ = size;
+}
+
+void TMCCRecorder::set_record_switch(TMCCRecordSwitch *record_switch) {
+  this->record_switch_ = record_switch;
+}
+
+void TMCCRecorder::set_replay_switch(TMCCReplaySwitch *replay_switch) {
+  this->replay_switch_ = replay_switch;
+}
+
+void TMCCRecorder::start_recording() {
+  if (this->is_failed()) {
+    return;
+  }
+  this->stop_replay();
+  this->bus_->set_recording(nullptr);
+  this->recording_.clear();
+  this->bus_->set_recording(&this->recording_);
+  this->recording_active_ = true;
+  ESP_LOGI(TAG, "Recording started");
+  this->publish_states_();
+}
+
+void TMCCRecorder::stop_recording() {
+  if (!this->recording_active_) {
+    return;
+  }
+  this->bus_->set_recording(nullptr);
+  this->recording_active_ = false;
+  ESP_LOGI(TAG, "Recording stopped: %u commands, %zu bytes", this->recording_.get_record_count(),
+           this->recording_.size());
+  if (this->recording_.get_records_dropped() > 0) {
+    ESP_LOGW(TAG, "Ring was full, %u oldest commands dropped", this->recording_.get_records_dropped());
+  }
+  this->publish_states_();
+}
+
+bool TMCCRecorder::is_recording() const {
+  return this->recording_active_;
+}
+
+void TMCCRecorder::start_replay() {
+  if (this->is_failed()) {
+    return;
+  }
+  this->stop_recording();
+  this->replay_offset_ = 0;
+  this->first_frame_ = true;
+  this->next_due_us_ = 0;
+  this->have_next_ = this->read_next_();
+  if (!this->have_next_) {
+    ESP_LOGW(TAG, "Nothing recorded to replay");
+    this->publish_states_();
+    return;
+  }
+
+  ESP_LOGI(TAG, "Replaying %u commands", this->recording_.get_record_count());
+  this->elapsed_us_ = 0;
+  this->last_loop_us_ = esphome::micros();
+  this->frames_replayed_ = 0;
+  this->replaying_ = true;
+  this->high_freq_.start();
+  this->publish_states_();
+}
+
+void TMCCRecorder::stop_replay() {
+  if (!this->replaying_) {
+    return;
+  }
+  this->replaying_ = false;
+  this->high_freq_.stop();
+  this->publish_states_();
+}
+
+bool TMCCRecorder::is_replaying() const {
+  return this->replaying_;
+}
+
+void TMCCRecorder::dump() {
+  if (this->is_failed()) {
+    return;
+  }
+  // The ring may only be read while the writer task is not appending to it
+  this->stop_recording();
+
+  size_t size = this->recording_.size();
+  ESP_LOGI(TAG, "Recording: %u commands, %zu bytes (decode with tools/tmcc_recording.py)",
+           this->recording_.get_record_count(), size);
+  uint8_t bytes[DUMP_LINE_BYTES];
+  char line[DUMP_LINE_BYTES * 3 + 1];
+  for (size_t offset = 0; offset < size; offset += DUMP_LINE_BYTES) {
+    size_t count = this->recording_.copy(offset, bytes, DUMP_LINE_BYTES);
+    for (size_t i = 0; i < count; i++) {
+      snprintf(line + i * 3, 4, " %02X", bytes[i]);
+    }
+    ESP_LOGI(TAG, "REC %04X:%s", static_cast<unsigned>(offset), line);
+  }
+}
+
+bool TMCCRecorder::read_next_() {
+  if (!this->recording_.read(&this->replay_offset_, &this->next_frame_)) {
+    return false;
+  }
+  // The first record's delta refers to a command that is not in the ring
+  if (!this->first_frame_) {
+    this->next_due_us_ += this->next_frame_.delta_us;
+  }
+  this->first_frame_ = false;
+  return true;
+}
+
+void TMCCRecorder::publish_states_() {
+  if (this->record_switch_ != nullptr) {
+    this->record_switch_->publish_state(this->recording_active_);
+  }
+  if (this->replay_switch_ != nullptr) {
+    this->replay_switch_->publish_state(this->replaying_);
+  }
+}
+
+// ============================================================================
+// TMCCRecordSwitch implementation
+// ============================================================================
+
+void TMCCRecordSwitch::set_recorder(TMCCRecorder *recorder) {
+  this->recorder_ = recorder;
+}
+
+void TMCCRecordSwitch::write_state(bool state) {
+  if (this->recorder_ == nullptr) {
+    return;
+  }
+  if (state) {
+    this->recorder_->start_recording();
+  } else {
+    this->recorder_->stop_recording();
+  }
+  this->publish_state(this->recorder_->is_recording());
+}
+
+// ============================================================================
+// TMCCReplaySwitch implementation
+// ============================================================================
+
+void TMCCReplaySwitch::set_recorder(TMCCRecorder *recorder) {
+  this->recorder_ = recorder;
+}
+
+void TMCCReplaySwitch::write_state(bool state) {
+  if (this->recorder_ == nullptr) {
+    return;
+  }
+  if (state) {
+    this->recorder_->start_replay();
+  } else {
+    this->recorder_->stop_replay();
+  }
+  this->publish_state(this->recorder_->is_replaying());
+}
+
+// ============================================================================
+// TMCCRecordingDumpButton implementation
+// ============================================================================
+
+void TMCCRecordingDumpButton::set_recorder(TMCCRecorder *recorder) {
+  this->recorder_ = recorder;
+}
+
+void TMCCRecordingDumpButton::press_action() {
+  if (this->recorder_ != nullptr) {
+    this->recorder_->dump();
+  }
+}
+
+}  // namespace tmcc
@@ -0,0 +1,104 @@
+#pragma once
+
+#include "esphome/core/component.h"
+#include "esphome/core/helpers.h"
+#include "esphome/components/button/button.h"
+#include "esphome/components/switch/switch.h"
+#include "tmcc.h"
+#include "tmcc_recording.h"
+
+namespace tmcc {
+
+class TMCCRecordSwitch;
+class TMCCReplaySwitch;
+
+/**
+ * TMCCRecorder - Records an operating session and replays it.
+ *
+ * While recording, the writer task appends every command it puts on the
+ * wire to a fixed RAM ring (see tmcc_recording.h for the format), with the
+ * time since the previous command. Replay feeds the commands back through
+ * the normal send path at the recorded times, so queueing, pacing and
+ * halt priority apply exactly as they did live. While replaying, loop()
+ * runs at high frequency, keeping the timing well inside one frame time.
+ *
+ * Recording and replay exclude each other, and a halt stops a replay.
+ * dump() logs the ring as hex for tools/tmcc_recording.py.
+ */
+class TMCCRecorder : public esphome::Component {
+ public:
+  void setup() override;
+  void loop() override;
+  void dump_config() override;
+
+  void set_bus(TMCCBus *bus);
+  void set_size(size_t size);  // Ring size in bytes
+  void set_record_switch(TMCCRecordSwitch *record_switch);
+  void set_replay_switch(TMCCReplaySwitch *replay_switch);
+
+  void start_recording();  // Clears the previous recording
+  void stop_recording();
+  bool is_recording() const;
+
+  void start_replay();
+  void stop_replay();
+  bool is_replaying() const;
+
+  void dump();  // Log the recording as hex, oldest first
+
+ protected:
+  // Read the next record and advance the replay clock by its delta
+  bool read_next_();
+  void publish_states_();
+
+  TMCCBus *bus_{nullptr};
+  TMCCRecording recording_;
+  size_t size_{4096};
+  bool recording_active_{false};
+  TMCCRecordSwitch *record_switch_{nullptr};
+  TMCCReplaySwitch *replay_switch_{nullptr};
+
+  // Replay state
+  bool replaying_{false};
+  esphome::HighFrequencyLoopRequester high_freq_;
+  size_t replay_offset_{0};
+  TMCCRecordedFrame next_frame_{};
+  bool have_next_{false};
+  bool first_frame_{true};
+  uint64_t next_due_us_{0};   // Replay clock time at which next_frame_ is sent
+  uint64_t elapsed_us_{0};    // Replay clock; 64 bits so long sessions never wrap
+  uint32_t last_loop_us_{0};
+  uint32_t frames_replayed_{0};
+};
+
+// Switch that records while on
+class TMCCRecordSwitch : public esphome::switch_::Switch {
+ public:
+  void set_recorder(TMCCRecorder *recorder);
+
+ protected:
+  void write_state(bool state) override;
+  TMCCRecorder *recorder_{nullptr};
+};
+
+// Switch that is on while a replay runs; turns itself off at the end
+class TMCCReplaySwitch : public esphome::switch_::Switch {
+ public:
+  void set_recorder(TMCCRecorder *recorder);
+
+ protected:
+  void write_state(bool state) override;
+  TMCCRecorder *recorder_{nullptr};
+};
+
+// Button that logs the recording for the host decoder
+class TMCCRecordingDumpButton : public esphome::button::Button {
+ public:
+  void set_recorder(TMCCRecorder *recorder);
+
+ protected:
+  void press_action() override;
+  TMCCRecorder *recorder_{nullptr};
+};
+
+}  // namespace tmcc
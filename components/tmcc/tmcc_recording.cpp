@@ -0,0 +1,170 @@
+#include "tmcc_recording.h"
+
+#include <new>
+
+namespace tmcc {
+
+static const uint8_t RECORD_HEADERS[] = {TMCC1_HEADER, TMCC2_ENGINE_HEADER, TMCC2_TRAIN_HEADER,
+                                         TMCC2_MULTIWORD_HEADER};
+static const uint8_t RECORD_HEADER_SHIFT = 5;
+static const uint8_t RECORD_CHAIN_NEXT = 0x80;
+static const size_t RECORD_MAX_VARINT_SIZE = 5;
+
+size_t tmcc_record_encode(const TMCCRecordedFrame &frame, uint8_t *out) {
+  uint8_t header_index = 0;
+  while (header_index < sizeof(RECORD_HEADERS) && RECORD_HEADERS[header_index] != frame.header) {
+    header_index++;
+  }
+  if (header_index == sizeof(RECORD_HEADERS)) {
+    return 0;
+  }
+
+  size_t len = 0;
+  uint32_t delta = frame.delta_us;
+  do {
+    uint8_t byte = delta & 0x7F;
+    delta >>= 7;
+    out[len++] = delta != 0 ? (byte | 0x80) : byte;
+  } while (delta != 0);
+
+  uint8_t repetitions = frame.repetitions;
+  if (repetitions == 0) {
+    repetitions = 1;
+  } else if (repetitions > TMCC_RECORD_MAX_REPETITIONS) {
+    repetitions = TMCC_RECORD_MAX_REPETITIONS;
+  }
+  out[len++] = repetitions | (header_index << RECORD_HEADER_SHIFT) | (frame.chain_next ? RECORD_CHAIN_NEXT : 0);
+  out[len++] = static_cast<uint8_t>(frame.word >> 8);
+  out[len++] = static_cast<uint8_t>(frame.word & 0xFF);
+  return len;
+}
+
+size_t tmcc_record_decode(const uint8_t *data, size_t len, TMCCRecordedFrame *frame) {
+  size_t pos = 0;
+  uint32_t delta = 0;
+  while (true) {
+    if (pos >= len || pos >= RECORD_MAX_VARINT_SIZE) {
+      return 0;
+    }
+    uint8_t byte = data[pos];
+    delta |= static_cast<uint32_t>(byte & 0x7F) << (7 * pos);
+    pos++;
+    if ((byte & 0x80) == 0) {
+      break;
+    }
+  }
+  if (len - pos < 3) {
+    return 0;
+  }
+
+  uint8_t control = data[pos];
+  frame->delta_us = delta;
+  frame->repetitions = control & TMCC_RECORD_MAX_REPETITIONS;
+  frame->header = RECORD_HEADERS[(control >> RECORD_HEADER_SHIFT) & 0x03];
+  frame->chain_next = (control & RECORD_CHAIN_NEXT) != 0;
+  frame->word = static_cast<uint16_t>((data[pos + 1] << 8) | data[pos + 2]);
+  return pos + 3;
+}
+
+TMCCRecording::~TMCCRecording() {
+  delete[] this->data_;
+}
+
+bool TMCCRecording::init(size_t capacity) {
+  delete[] this->data_;
+  this->data_ = new (std::nothrow) uint8_t[capacity];
+  if (this->data_ == nullptr) {
+    this->capacity_ = 0;
+    return false;
+  }
+  this->capacity_ = capacity;
+  this->clear();
+  return true;
+}
+
+bool TMCCRecording::append(uint32_t timestamp_us, uint8_t header, uint16_t word, uint8_t repetitions,
+                           bool chain_next) {
+  if (this->capacity_ < TMCC_RECORD_MAX_SIZE) {
+    return false;
+  }
+  TMCCRecordedFrame frame;
+  frame.delta_us = this->record_count_ == 0 ? 0 : timestamp_us - this->last_us_;
+  frame.word = word;
+  frame.header = header;
+  frame.repetitions = repetitions;
+  frame.chain_next = chain_next;
+  uint8_t encoded[TMCC_RECORD_MAX_SIZE];
+  size_t len = tmcc_record_encode(frame, encoded);
+  if (len == 0) {
+    return false;
+  }
+
+  while (this->capacity_ - this->count_ < len) {
+    this->drop_oldest_();
+  }
+  for (size_t i = 0; i < len; i++) {
+    this->data_[(this->head_ + this->count_ + i) % this->capacity_] = encoded[i];
+  }
+  this->count_ += len;
+  this->last_us_ = timestamp_us;
+  this->record_count_++;
+  return true;
+}
+
+bool TMCCRecording::read(size_t *offset, TMCCRecordedFrame *frame) const {
+  uint8_t encoded[TMCC_RECORD_MAX_SIZE];
+  size_t len = this->copy(*offset, encoded, sizeof(encoded));
+  size_t used = tmcc_record_decode(encoded, len, frame);
+  if (used == 0) {
+    return false;
+  }
+  *offset += used;
+  return true;
+}
+
+size_t TMCCRecording::copy(size_t start, uint8_t *out, size_t max_count) const {
+  size_t copied = 0;
+  for (size_t i = start; i < this->count_ && copied < max_count; i++) {
+    out[copied++] = this->data_[(this->head_ + i) % this->capacity_];
+  }
+  return copied;
+}
+
+void TMCCRecording::drop_oldest_() {
+  size_t offset = 0;
+  TMCCRecordedFrame frame;
+  if (!this->read(&offset, &frame)) {
+    // Never happens for data written by append(); start over rather than loop
+    this->clear();
+    return;
+  }
+  this->head_ = (this->head_ + offset) % this->capacity_;
+  this->count_ -= offset;
+  this->record_count_--;
+  this->records_dropped_++;
+}
+
+void TMCCRecording::clear() {
+  this->head_ = 0;
+  this->count_ = 0;
+  this->record_count_ = 0;
+  this->records_dropped_ = 0;
+}
+
+size_t TMCCRecording::size() const {
+  return this->count_;
+}
+
+size_t TMCCRecording::capacity() const {
+  return this->capacity_;
+}
+
+uint32_t TMCCRecording::get_record_count() const {
+  return this->record_count_;
+}
+
+uint32_t TMCCRecording::get_records_dropped() const {
+  return this->records_dropped_;
+}
+
+}  // namespace tmcc
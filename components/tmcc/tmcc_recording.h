@@ -0,0 +1,101 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "tmcc_protocol.h"
+
+namespace tmcc {
+
+/*
+ * Recording format
+ *
+ * A recording is a byte stream of variable-length records, one per command
+ * the writer task put on the wire:
+ *
+ *   delta   LEB128 varint: microseconds since the previous record (1-5 bytes)
+ *   control bits 0-4: repetitions (1-31)
+ *           bits 5-6: header (0 = 0xFE TMCC1, 1 = 0xF8, 2 = 0xF9, 3 = 0xFB)
+ *           bit 7:    another frame of the same multi-frame command follows
+ *   word    16-bit command word, high byte first
+ *
+ * A repeated command is one record, however many times it was sent, so a
+ * typical record is 5-6 bytes. The delta of the first record is not used.
+ * tools/tmcc_recording.py decodes the format to text.
+ */
+
+static constexpr size_t TMCC_RECORD_MAX_SIZE = 8;  // 5-byte varint + control + word
+static constexpr uint8_t TMCC_RECORD_MAX_REPETITIONS = 0x1F;
+
+// One decoded record
+struct TMCCRecordedFrame {
+  uint32_t delta_us;
+  uint16_t word;
+  uint8_t header;
+  uint8_t repetitions;
+  bool chain_next;  // Another frame of the same command follows
+};
+
+// Encode `frame` into `out` (at least TMCC_RECORD_MAX_SIZE bytes). Returns
+// the bytes written, or 0 if the header cannot be recorded.
+size_t tmcc_record_encode(const TMCCRecordedFrame &frame, uint8_t *out);
+
+// Decode one record from `data`. Returns the bytes consumed, or 0 if `len`
+// bytes do not hold a complete record.
+size_t tmcc_record_decode(const uint8_t *data, size_t len, TMCCRecordedFrame *frame);
+
+/**
+ * TMCCRecording - Fixed-size byte ring of recorded commands.
+ *
+ * Storage is allocated once by init() and never grows. When the ring is
+ * full the oldest whole records are dropped to make room, so the ring
+ * always holds the latest part of the session. Like TMCCTraceBuffer it is
+ * not thread-safe on its own: TMCCBus appends under its queue lock, and
+ * the recording is only read while it is not attached to the bus.
+ *
+ * Plain C++ with no ESPHome or FreeRTOS dependencies.
+ */
+class TMCCRecording {
+ public:
+  TMCCRecording() = default;
+  ~TMCCRecording();
+
+  TMCCRecording(const TMCCRecording &) = delete;
+  TMCCRecording &operator=(const TMCCRecording &) = delete;
+
+  // Allocate `capacity` bytes. Returns false on allocation failure.
+  bool init(size_t capacity);
+
+  // Append a command sent at `timestamp_us` (micros()). Returns false if it
+  // cannot be recorded (no storage, or a header outside the format).
+  bool append(uint32_t timestamp_us, uint8_t header, uint16_t word, uint8_t repetitions, bool chain_next);
+
+  // Decode the record at logical byte `*offset` (0 = oldest) and advance
+  // `*offset` past it. Returns false at the end of the recording.
+  bool read(size_t *offset, TMCCRecordedFrame *frame) const;
+
+  // Copy up to `max_count` bytes starting at logical byte `start` into
+  // `out`. Returns the number copied.
+  size_t copy(size_t start, uint8_t *out, size_t max_count) const;
+
+  void clear();
+
+  size_t size() const;  // Bytes in use
+  size_t capacity() const;
+  uint32_t get_record_count() const;    // Records currently held
+  uint32_t get_records_dropped() const;  // Oldest records dropped to make room
+
+ protected:
+  // Drop the oldest record
+  void drop_oldest_();
+
+  uint8_t *data_{nullptr};
+  size_t capacity_{0};
+  size_t head_{0};  // Position of the oldest byte
+  size_t count_{0};
+  uint32_t last_us_{0};
+  uint32_t record_count_{0};
+  uint32_t records_dropped_{0};
+};
+
+}  // namespace tmcc
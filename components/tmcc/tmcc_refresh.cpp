@@ -0,0 +1,56 @@
+#include "tmcc_refresh.h"
+#include "esphome/core/log.h"
+
+namespace tmcc {
+
+static const char *const TAG = "tmcc.refresh";
+
+void TMCCRefresh::setup() {
+  if (this->bus_ == nullptr) {
+    ESP_LOGE(TAG, "TMCCBus not configured!");
+    return;
+  }
+  if (this->engines_.empty() || this->budget_ <= 0.0f) {
+    return;
+  }
+  uint32_t period_ms = static_cast<uint32_t>(TMCC_FRAME_TIME_US / (this->budget_ * 1000.0f)) + 1;
+  this->set_interval(period_ms, [this]() { this->refresh_next_(); });
+}
+
+void TMCCRefresh::dump_config() {
+  ESP_LOGCONFIG(TAG, "TMCC Refresh:");
+  ESP_LOGCONFIG(TAG, "  Budget: %.1f%% of the wire", this->budget_ * 100.0f);
+  ESP_LOGCONFIG(TAG, "  Engines: %zu", this->engines_.size());
+  ESP_LOGCONFIG(TAG, "  Frames Sent: %u", this->frames_sent_);
+}
+
+void TMCCRefresh::set_bus(TMCCBus *bus) {
+  this->bus_ = bus;
+}
+
+void TMCCRefresh::set_budget(float budget) {
+  this->budget_ = budget;
+}
+
+void TMCCRefresh::add_engine(TMCCEngine *engine) {
+  this->engines_.push_back(engine);
+}
+
+void TMCCRefresh::refresh_next_() {
+  if (!this->bus_->is_tx_idle()) {
+    return;
+  }
+  size_t slots = this->engines_.size() * 2;
+  for (size_t tried = 0; tried < slots; tried++) {
+    size_t slot = this->next_slot_;
+    this->next_slot_ = (slot + 1) % slots;
+    TMCCEngine *engine = this->engines_[slot / 2];
+    bool sent = (slot % 2 == 0) ? engine->refresh_speed() : engine->refresh_direction();
+    if (sent) {
+      this->frames_sent_++;
+      return;
+    }
+  }
+}
+
+}  // namespace tmcc
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <vector>
+
+#include "esphome/core/component.h"
+#include "tmcc_engine.h"
+
+namespace tmcc {
+
+/**
+ * TMCCRefresh - Re-asserts every engine's speed and direction in the background.
+ *
+ * TMCC1 has no acknowledgement, so a lost speed or direction frame would
+ * otherwise go unnoticed until the next change. The refresher walks the
+ * engines round-robin and re-sends one known speed or direction per tick.
+ * The tick period is set so refresh frames take at most `budget` of the
+ * wire time, and a tick is skipped whenever other frames are waiting, so
+ * refreshes never delay real commands.
+ */
+class TMCCRefresh : public esphome::Component {
+ public:
+  void setup() override;
+  void dump_config() override;
+
+  void set_bus(TMCCBus *bus);
+  void set_budget(float budget);  // Fraction of the wire time, 0-1
+  void add_engine(TMCCEngine *engine);
+
+ protected:
+  // Send the next refresh frame, skipping engines with nothing to re-send
+  void refresh_next_();
+
+  TMCCBus *bus_{nullptr};
+  float budget_{0.02f};
+  std::vector<TMCCEngine *> engines_;
+  size_t next_slot_{0};  // Two slots per engine: speed, then direction
+  uint32_t frames_sent_{0};
+};
+
+}  // namespace tmcc
@@ -0,0 +1,88 @@
+#include "tmcc_sequence.h"
+#include "esphome/core/log.h"
+
+namespace tmcc {
+
+static const char *const TAG = "tmcc.sequence";
+
+static const char *const STEP_TIMEOUT_NAME = "step";
+
+void TMCCSequence::setup() {
+  if (this->bus_ == nullptr) {
+    ESP_LOGE(TAG, "TMCCBus not configured!");
+    return;
+  }
+  this->bus_->add_on_halt_callback([this]() { this->stop(); });
+}
+
+void TMCCSequence::dump_config() {
+  LOG_BUTTON("", "TMCC Sequence", this);
+  ESP_LOGCONFIG(TAG, "  Steps: %zu", this->steps_.size());
+}
+
+void TMCCSequence::set_bus(TMCCBus *bus) {
+  this->bus_ = bus;
+}
+
+void TMCCSequence::add_action_step(TMCCEngine *engine, TMCCEngineAction action, uint8_t repetitions,
+                                   uint32_t delay_ms) {
+  this->steps_.push_back(TMCCSequenceStep{engine, static_cast<uint8_t>(action), repetitions, delay_ms});
+}
+
+void TMCCSequence::add_speed_step(TMCCEngine *engine, uint8_t speed, uint32_t delay_ms) {
+  this->steps_.push_back(TMCCSequenceStep{engine, speed, 0, delay_ms});
+}
+
+void TMCCSequence::add_delay_step(uint32_t delay_ms) {
+  this->steps_.push_back(TMCCSequenceStep{nullptr, 0, 0, delay_ms});
+}
+
+void TMCCSequence::start() {
+  if (this->bus_ == nullptr || this->steps_.empty()) {
+    return;
+  }
+  this->cancel_timeout(STEP_TIMEOUT_NAME);
+  this->next_step_ = 0;
+  this->running_ = true;
+  this->run_();
+}
+
+void TMCCSequence::stop() {
+  if (this->running_) {
+    this->cancel_timeout(STEP_TIMEOUT_NAME);
+    this->running_ = false;
+  }
+}
+
+bool TMCCSequence::is_running() const {
+  return this->running_;
+}
+
+void TMCCSequence::press_action() {
+  this->start();
+}
+
+void TMCCSequence::run_() {
+  while (this->next_step_ < this->steps_.size()) {
+    const TMCCSequenceStep &step = this->steps_[this->next_step_++];
+    if (step.engine != nullptr && step.repetitions == 0) {
+      step.engine->set_speed(step.value);
+    } else if (step.engine != nullptr) {
+      // Looked up now: a cab's table follows the engine it drives
+      const TMCCEngineFrameTable &frames = step.engine->get_frames();
+      uint16_t word = frames.action_words[step.value];
+      if (step.repetitions == 1) {
+        this->bus_->send_frame(frames.header, word);
+      } else {
+        this->bus_->send_frame_repeated(frames.header, word, step.repetitions);
+      }
+    }
+    if (step.delay_ms > 0) {
+      this->set_timeout(STEP_TIMEOUT_NAME, step.delay_ms, [this]() { this->run_(); });
+      return;
+    }
+  }
+  this->running_ = false;
+}
+
+}  // namespace tmcc
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <vector>
+
+#include "esphome/core/component.h"
+#include "esphome/components/button/button.h"
+#include "tmcc_engine.h"
+
+namespace tmcc {
+
+/**
+ * One step of a sequence: send one of an engine's pre-encoded action
+ * frames, or set its speed (through its momentum), then wait.
+ */
+struct TMCCSequenceStep {
+  TMCCEngine *engine;    // nullptr for a wait-only step
+  uint8_t value;         // TMCCEngineAction, or target speed for a speed step
+  uint8_t repetitions;   // Action steps: times to send the frame; 0 = speed step
+  uint32_t delay_ms;     // Wait before the next step
+};
+
+/**
+ * TMCCSequence - Button that runs a scripted list of engine commands.
+ *
+ * A step keeps its engine, and running it looks the frame up in the
+ * engine's pre-encoded table, so running a step is a queue push and a
+ * cab's steps reach whichever engine it drives at the time. The sequence
+ * advances from Component timeouts: loop() is never blocked while it
+ * waits, and any number of sequences can run at the same time. Pressing
+ * the button again restarts the sequence; a System Halt cancels it.
+ */
+class TMCCSequence : public esphome::button::Button, public esphome::Component {
+ public:
+  void setup() override;
+  void dump_config() override;
+
+  void set_bus(TMCCBus *bus);
+
+  // Step builders, called in order by the generated code
+  void add_action_step(TMCCEngine *engine, TMCCEngineAction action, uint8_t repetitions, uint32_t delay_ms);
+  void add_speed_step(TMCCEngine *engine, uint8_t speed, uint32_t delay_ms);
+  void add_delay_step(uint32_t delay_ms);
+
+  void start();
+  void stop();
+  bool is_running() const;
+
+ protected:
+  void press_action() override;
+  // Run steps from next_step_ until one has a delay (or the end is reached)
+  void run_();
+
+  TMCCBus *bus_{nullptr};
+  std::vector<TMCCSequenceStep> steps_;
+  size_t next_step_{0};
+  bool running_{false};
+};
+
+}  // namespace tmcc
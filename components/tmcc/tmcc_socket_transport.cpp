@@ -0,0 +1,146 @@
+#include "tmcc_socket_transport.h"
+
+#ifdef USE_TMCC_SOCKET_TRANSPORT
+
+#include "esphome/core/hal.h"
+#include "esphome/core/log.h"
+
+namespace tmcc {
+
+static const char *const TAG = "tmcc.transport";
+
+// Time between connection attempts while the simulator is unreachable
+static const uint32_t SOCKET_RETRY_MS = 5000;
+
+void TMCCSocketTransport::set_address(const std::string &address) {
+  this->address_ = address;
+}
+
+void TMCCSocketTransport::set_port(uint16_t port) {
+  this->port_ = port;
+}
+
+bool TMCCSocketTransport::begin() {
+  // The network is not up yet; the receive task connects once it is
+  this->lock_ = xSemaphoreCreateMutex();
+  return this->lock_ != nullptr;
+}
+
+void TMCCSocketTransport::write(const uint8_t *data, size_t len) {
+  xSemaphoreTake(this->lock_, portMAX_DELAY);
+  if (!this->ready_()) {
+    this->bytes_dropped_ += len;
+    xSemaphoreGive(this->lock_);
+    return;
+  }
+  ssize_t written = this->socket_->write(data, len);
+  if (written < 0 && errno != EWOULDBLOCK && errno != EAGAIN) {
+    ESP_LOGW(TAG, "Connection to %s:%u lost: errno %d", this->address_.c_str(), this->port_, errno);
+    this->close_();
+  }
+  if (written < static_cast<ssize_t>(len)) {
+    this->bytes_dropped_ += len - (written > 0 ? written : 0);
+  }
+  xSemaphoreGive(this->lock_);
+}
+
+void TMCCSocketTransport::flush() {
+  // TCP has no wire time to wait for
+}
+
+size_t TMCCSocketTransport::read(uint8_t *data, size_t max) {
+  xSemaphoreTake(this->lock_, portMAX_DELAY);
+  size_t count = 0;
+  if (this->ready_()) {
+    ssize_t received = this->socket_->read(data, max);
+    if (received > 0) {
+      count = received;
+    } else if (received == 0 || (errno != EWOULDBLOCK && errno != EAGAIN)) {
+      ESP_LOGW(TAG, "Connection to %s:%u closed", this->address_.c_str(), this->port_);
+      this->close_();
+    }
+  }
+  xSemaphoreGive(this->lock_);
+  return count;
+}
+
+const char *TMCCSocketTransport::get_name() const {
+  return "TCP";
+}
+
+uint32_t TMCCSocketTransport::get_bytes_dropped() const {
+  return this->bytes_dropped_;
+}
+
+bool TMCCSocketTransport::ready_() {
+  if (this->socket_ == nullptr) {
+    this->start_connect_();
+  }
+  if (this->connecting_ && !this->finish_connect_()) {
+    return false;
+  }
+  return this->socket_ != nullptr;
+}
+
+void TMCCSocketTransport::start_connect_() {
+  uint32_t now = esphome::millis();
+  if (this->attempted_ && now - this->last_attempt_ms_ < SOCKET_RETRY_MS) {
+    return;
+  }
+  this->attempted_ = true;
+  this->last_attempt_ms_ = now;
+
+  struct sockaddr_storage addr;
+  socklen_t addr_len = esphome::socket::set_sockaddr(reinterpret_cast<struct sockaddr *>(&addr), sizeof(addr),
+                                                     this->address_, this->port_);
+  if (addr_len == 0) {
+    ESP_LOGE(TAG, "Invalid address %s", this->address_.c_str());
+    return;
+  }
+  auto sock = esphome::socket::socket(addr.ss_family, SOCK_STREAM, 0);
+  if (sock == nullptr) {
+    ESP_LOGE(TAG, "Could not create socket for %s:%u", this->address_.c_str(), this->port_);
+    return;
+  }
+  sock->setblocking(false);
+  if (sock->connect(reinterpret_cast<struct sockaddr *>(&addr), addr_len) != 0 && errno != EINPROGRESS) {
+    ESP_LOGW(TAG, "Could not connect to %s:%u: errno %d", this->address_.c_str(), this->port_, errno);
+    return;
+  }
+  this->socket_ = std::move(sock);
+  this->connecting_ = true;
+}
+
+bool TMCCSocketTransport::finish_connect_() {
+  // The handshake is over once the socket turns writable
+  int fd = this->socket_->get_fd();
+  fd_set writable;
+  FD_ZERO(&writable);
+  FD_SET(fd, &writable);
+  struct timeval no_wait = {0, 0};
+  if (select(fd + 1, nullptr, &writable, nullptr, &no_wait) <= 0) {
+    return false;
+  }
+  int error = 0;
+  socklen_t len = sizeof(error);
+  if (this->socket_->getsockopt(SOL_SOCKET, SO_ERROR, &error, &len) != 0 || error != 0) {
+    ESP_LOGW(TAG, "Could not connect to %s:%u: errno %d", this->address_.c_str(), this->port_, error);
+    this->close_();
+    return false;
+  }
+  int enable = 1;
+  this->socket_->setsockopt(IPPROTO_TCP, TCP_NODELAY, &enable, sizeof(enable));
+  this->connecting_ = false;
+  ESP_LOGI(TAG, "Connected to %s:%u", this->address_.c_str(), this->port_);
+  return true;
+}
+
+void TMCCSocketTransport::close_() {
+  this->socket_->close();
+  this->socket_ = nullptr;
+  this->connecting_ = false;
+}
+
+}  // namespace tmcc
+
+#endif  // USE_TMCC_SOCKET_TRANSPORT
@@ -0,0 +1,63 @@
+#pragma once
+
+#include "esphome/core/defines.h"
+
+#ifdef USE_TMCC_SOCKET_TRANSPORT
+
+#include <memory>
+#include <string>
+
+#include "esphome/components/socket/socket.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "tmcc_transport.h"
+
+namespace tmcc {
+
+/**
+ * TMCCSocketTransport - Frames over a TCP connection instead of a wire.
+ *
+ * Connects as a client to a simulated command base (or a ser2net port in
+ * front of a real one) on a Linux host, so the bus, engines and entities
+ * can be exercised against a simulator. The connection is opened by the
+ * receive task's first read and re-opened, at most every few seconds,
+ * after it drops; bytes written while not connected are dropped and counted.
+ *
+ * The socket is non-blocking from the start, connect included: neither
+ * task ever waits on the network while holding the lock that keeps the
+ * receive task from reading while the writer task replaces the connection.
+ */
+class TMCCSocketTransport : public TMCCTransport {
+ public:
+  void set_address(const std::string &address);  // IP address of the simulator
+  void set_port(uint16_t port);
+
+  bool begin() override;
+  void write(const uint8_t *data, size_t len) override;
+  void flush() override;
+  size_t read(uint8_t *data, size_t max) override;
+  const char *get_name() const override;
+
+  uint32_t get_bytes_dropped() const;
+
+ protected:
+  // All called with lock_ held. ready_() starts a connection when none is
+  // open and returns true once it is established.
+  bool ready_();
+  void start_connect_();
+  bool finish_connect_();
+  void close_();
+
+  std::string address_;
+  uint16_t port_{5001};
+  std::unique_ptr<esphome::socket::Socket> socket_;
+  bool connecting_{false};  // socket_ is still waiting for the handshake
+  SemaphoreHandle_t lock_{nullptr};
+  uint32_t last_attempt_ms_{0};
+  bool attempted_{false};
+  uint32_t bytes_dropped_{0};
+};
+
+}  // namespace tmcc
+
+#endif  // USE_TMCC_SOCKET_TRANSPORT
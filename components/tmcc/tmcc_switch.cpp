@@ -0,0 +1,134 @@
+#include "tmcc_switch.h"
+#include "esphome/core/log.h"
+
+namespace tmcc {
+
+static const char *const TAG = "tmcc.switch";
+
+static const char *const ROUTE_INTERVAL_NAME = "route";
+
+// ============================================================================
+// TMCCSwitch implementation
+// ============================================================================
+
+void TMCCSwitch::setup() {
+  if (this->bus_ == nullptr) {
+    ESP_LOGE(TAG, "TMCCBus not configured!");
+    return;
+  }
+  this->bus_->add_on_frame_callback([this](uint8_t header, uint16_t word) {
+    if (header == TMCC1_HEADER) {
+      this->on_frame_(word);
+    }
+  });
+}
+
+void TMCCSwitch::dump_config() {
+  LOG_SWITCH("", "TMCC Switch", this);
+  ESP_LOGCONFIG(TAG, "  Address: %u", this->address_);
+}
+
+void TMCCSwitch::set_bus(TMCCBus *bus) {
+  this->bus_ = bus;
+}
+
+void TMCCSwitch::set_address(uint8_t address) {
+  this->address_ = address & 0x7F;  // Mask to 7 bits
+}
+
+uint8_t TMCCSwitch::get_address() const {
+  return this->address_;
+}
+
+void TMCCSwitch::throw_to(bool out) {
+  if (this->bus_ == nullptr) {
+    return;
+  }
+  TMCC_LOG_FRAME(TAG, "throw: address=%u out=%s", this->address_, out ? "true" : "false");
+  this->bus_->send_frame(TMCC1_HEADER, tmcc_switch_word(this->address_, out ? TMCCSwitchAction::THROW_OUT
+                                                                               : TMCCSwitchAction::THROW_THROUGH));
+  this->publish_state(out);
+}
+
+void TMCCSwitch::write_state(bool state) {
+  this->throw_to(state);
+}
+
+void TMCCSwitch::on_frame_(uint16_t word) {
+  TMCCDecodedWord decoded;
+  if (!tmcc_decode_word(word, &decoded) || decoded.type != TMCCObjectType::SWITCH ||
+      decoded.address != this->address_ || decoded.cmd_class != TMCCCommandClass::ACTION) {
+    return;
+  }
+  if (decoded.data == static_cast<uint8_t>(TMCCSwitchAction::THROW_OUT)) {
+    this->publish_state(true);
+  } else if (decoded.data == static_cast<uint8_t>(TMCCSwitchAction::THROW_THROUGH)) {
+    this->publish_state(false);
+  }
+}
+
+// ============================================================================
+// TMCCRoute implementation
+// ============================================================================
+
+void TMCCRoute::dump_config() {
+  LOG_BUTTON("", "TMCC Route", this);
+  if (this->address_ >= 0) {
+    ESP_LOGCONFIG(TAG, "  Route Address: %d", this->address_);
+  }
+  ESP_LOGCONFIG(TAG, "  Switches: %zu (one every %u ms)", this->steps_.size(), this->pace_ms_);
+}
+
+void TMCCRoute::set_bus(TMCCBus *bus) {
+  this->bus_ = bus;
+}
+
+void TMCCRoute::set_address(int16_t address) {
+  this->address_ = address;
+}
+
+void TMCCRoute::set_pace(uint32_t pace_ms) {
+  this->pace_ms_ = pace_ms;
+}
+
+void TMCCRoute::add_step(TMCCSwitch *turnout, bool out) {
+  this->steps_.push_back(TMCCRouteStep{turnout, out});
+}
+
+bool TMCCRoute::is_running() const {
+  return this->running_;
+}
+
+void TMCCRoute::press_action() {
+  if (this->bus_ == nullptr) {
+    ESP_LOGE(TAG, "Cannot set route: bus not configured");
+    return;
+  }
+  if (this->address_ >= 0) {
+    this->bus_->send_frame(TMCC1_HEADER,
+                           tmcc_route_word(static_cast<uint8_t>(this->address_), TMCCRouteAction::THROW));
+  }
+  if (this->steps_.empty()) {
+    return;
+  }
+
+  // Throw the first switch now and the rest one per interval
+  this->next_step_ = 0;
+  this->running_ = true;
+  this->run_step_();
+  if (this->running_) {
+    this->set_interval(ROUTE_INTERVAL_NAME, this->pace_ms_, [this]() { this->run_step_(); });
+  }
+}
+
+void TMCCRoute::run_step_() {
+  const TMCCRouteStep &step = this->steps_[this->next_step_];
+  step.turnout->throw_to(step.out);
+  this->next_step_++;
+  if (this->next_step_ >= this->steps_.size()) {
+    this->cancel_interval(ROUTE_INTERVAL_NAME);
+    this->running_ = false;
+  }
+}
+
+}  // namespace tmcc
@@ -0,0 +1,80 @@
+#pragma once
+
+#include <vector>
+
+#include "esphome/core/component.h"
+#include "esphome/components/button/button.h"
+#include "esphome/components/switch/switch.h"
+#include "tmcc.h"
+
+namespace tmcc {
+
+/**
+ * TMCCSwitch - A TMCC switch (turnout) as a Switch entity.
+ * ON = thrown out, OFF = through.
+ *
+ * The state also follows switch commands received from the command base,
+ * so turnouts thrown from a CAB-1 are reflected in Home Assistant.
+ */
+class TMCCSwitch : public esphome::switch_::Switch, public esphome::Component {
+ public:
+  void setup() override;
+  void dump_config() override;
+
+  void set_bus(TMCCBus *bus);
+  void set_address(uint8_t address);
+  uint8_t get_address() const;
+
+  // Send the throw command and publish the new position
+  void throw_to(bool out);
+
+ protected:
+  void write_state(bool state) override;
+  void on_frame_(uint16_t word);
+
+  TMCCBus *bus_{nullptr};
+  uint8_t address_{1};
+};
+
+/**
+ * One switch position in a route.
+ */
+struct TMCCRouteStep {
+  TMCCSwitch *turnout;
+  bool out;
+};
+
+/**
+ * TMCCRoute - Button that sets a route.
+ *
+ * A route may name a route stored in the command base (`address`), a list
+ * of switch positions to throw as one batch, or both. The batch is paced:
+ * one switch is thrown per `pace` interval from a Component interval, so
+ * the command base and switch machines are not overrun and the main loop
+ * is never blocked for the length of the batch. Pressing the button again
+ * while the batch runs restarts it from the first switch.
+ */
+class TMCCRoute : public esphome::button::Button, public esphome::Component {
+ public:
+  void dump_config() override;
+
+  void set_bus(TMCCBus *bus);
+  void set_address(int16_t address);  // -1 = no stored route
+  void set_pace(uint32_t pace_ms);
+  void add_step(TMCCSwitch *turnout, bool out);
+
+  bool is_running() const;
+
+ protected:
+  void press_action() override;
+  void run_step_();
+
+  TMCCBus *bus_{nullptr};
+  int16_t address_{-1};
+  uint32_t pace_ms_{200};
+  std::vector<TMCCRouteStep> steps_;
+  size_t next_step_{0};
+  bool running_{false};
+};
+
+}  // namespace tmcc
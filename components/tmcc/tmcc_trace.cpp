@@ -0,0 +1,63 @@
+#include "tmcc_trace.h"
+
+#include <new>
+
+namespace tmcc {
+
+TMCCTraceBuffer::~TMCCTraceBuffer() {
+  delete[] this->records_;
+}
+
+bool TMCCTraceBuffer::init(size_t capacity) {
+  delete[] this->records_;
+  this->records_ = new (std::nothrow) TMCCTraceRecord[capacity];
+  if (this->records_ == nullptr) {
+    this->capacity_ = 0;
+    return false;
+  }
+  this->capacity_ = capacity;
+  this->clear();
+  return true;
+}
+
+void TMCCTraceBuffer::record(const TMCCTraceRecord &record) {
+  if (this->capacity_ == 0) {
+    return;
+  }
+  this->total_recorded_++;
+  if (this->count_ < this->capacity_) {
+    this->records_[(this->head_ + this->count_) % this->capacity_] = record;
+    this->count_++;
+    return;
+  }
+  // Full: the oldest slot becomes the newest
+  this->records_[this->head_] = record;
+  this->head_ = (this->head_ + 1) % this->capacity_;
+}
+
+size_t TMCCTraceBuffer::copy(size_t start, TMCCTraceRecord *out, size_t max_count) const {
+  size_t copied = 0;
+  for (size_t i = start; i < this->count_ && copied < max_count; i++) {
+    out[copied++] = this->records_[(this->head_ + i) % this->capacity_];
+  }
+  return copied;
+}
+
+void TMCCTraceBuffer::clear() {
+  this->head_ = 0;
+  this->count_ = 0;
+}
+
+size_t TMCCTraceBuffer::size() const {
+  return this->count_;
+}
+
+size_t TMCCTraceBuffer::capacity() const {
+  return this->capacity_;
+}
+
+uint32_t TMCCTraceBuffer::get_total_recorded() const {
+  return this->total_recorded_;
+}
+
+}  // namespace tmcc
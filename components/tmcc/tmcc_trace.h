@@ -0,0 +1,68 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace tmcc {
+
+// Where a traced frame was seen
+enum class TMCCTraceSource : uint8_t {
+  TX = 0,    // Written to the wire by the writer task
+  RX = 1,    // Received from the command base
+  DROP = 2,  // Rejected or evicted because the TX queue was full
+};
+
+/**
+ * One traced frame. Kept small and fixed-size so that recording costs a
+ * struct copy instead of a formatted log line.
+ */
+struct TMCCTraceRecord {
+  uint32_t timestamp_us;  // micros() when the frame was recorded
+  uint16_t word;
+  uint8_t header;
+  uint8_t repetitions;    // Repetitions left including this one (TX), otherwise 1
+  TMCCTraceSource source;
+};
+
+/**
+ * TMCCTraceBuffer - Fixed-size ring of the most recent frames.
+ *
+ * Once full, each new record overwrites the oldest. Storage is allocated
+ * once by init() and never grows afterwards. Like TMCCTxQueue, the buffer
+ * is not thread-safe on its own; TMCCBus records and reads it under its
+ * queue lock.
+ */
+class TMCCTraceBuffer {
+ public:
+  TMCCTraceBuffer() = default;
+  ~TMCCTraceBuffer();
+
+  TMCCTraceBuffer(const TMCCTraceBuffer &) = delete;
+  TMCCTraceBuffer &operator=(const TMCCTraceBuffer &) = delete;
+
+  // Allocate storage for `capacity` records. Returns false on allocation failure.
+  bool init(size_t capacity);
+
+  // Record one frame, overwriting the oldest record when full. Does nothing
+  // if the buffer was never initialised.
+  void record(const TMCCTraceRecord &record);
+
+  // Copy up to `max_count` records starting at logical position `start`
+  // (0 = oldest) into `out`. Returns the number copied.
+  size_t copy(size_t start, TMCCTraceRecord *out, size_t max_count) const;
+
+  void clear();
+
+  size_t size() const;
+  size_t capacity() const;
+  uint32_t get_total_recorded() const;
+
+ protected:
+  TMCCTraceRecord *records_{nullptr};
+  size_t capacity_{0};
+  size_t head_{0};             // Position of the oldest record
+  size_t count_{0};
+  uint32_t total_recorded_{0};  // Records ever written, including overwritten ones
+};
+
+}  // namespace tmcc
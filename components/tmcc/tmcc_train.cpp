@@ -0,0 +1,102 @@
+#include "tmcc_train.h"
+#include "esphome/core/log.h"
+
+namespace tmcc {
+
+static const char *const TAG = "tmcc.train";
+
+// ============================================================================
+// TMCCTrain implementation
+// ============================================================================
+
+TMCCTrain::TMCCTrain() {
+  this->object_type_ = TMCCObjectType::TRAIN;
+  this->build_frames_();
+}
+
+void TMCCTrain::setup() {
+  TMCCEngine::setup();
+  if (this->assign_on_boot_) {
+    this->assign_units();
+  }
+}
+
+void TMCCTrain::dump_config() {
+  ESP_LOGCONFIG(TAG, "TMCC Train:");
+  ESP_LOGCONFIG(TAG, "  Address: %u", this->address_);
+  ESP_LOGCONFIG(TAG, "  Protocol: %s", this->protocol_ == TMCCProtocol::LEGACY ? "Legacy" : "TMCC1");
+  ESP_LOGCONFIG(TAG, "  Max Speed: %u", this->max_speed_);
+  for (const TMCCTrainUnitConfig &unit : this->units_) {
+    ESP_LOGCONFIG(TAG, "  Unit: engine %u%s", unit.engine->get_address(), unit.reversed ? " (reversed)" : "");
+  }
+}
+
+void TMCCTrain::add_unit(TMCCEngine *engine, bool reversed) {
+  this->units_.push_back(TMCCTrainUnitConfig{engine, reversed});
+}
+
+void TMCCTrain::set_assign_on_boot(bool assign_on_boot) {
+  this->assign_on_boot_ = assign_on_boot;
+}
+
+void TMCCTrain::assign_units() {
+  if (this->bus_ == nullptr) {
+    ESP_LOGE(TAG, "Cannot assign train %u: bus not configured", this->address_);
+    return;
+  }
+  if (this->address_ > TMCC1_MAX_ASSIGN_TRAIN) {
+    ESP_LOGE(TAG, "Cannot assign train %u: TMCC1 lash-ups go up to train %u", this->address_,
+             TMCC1_MAX_ASSIGN_TRAIN);
+    return;
+  }
+
+  size_t count = this->units_.size();
+  size_t failed = 0;
+  for (size_t i = 0; i < count; i++) {
+    const TMCCTrainUnitConfig &unit = this->units_[i];
+    TMCCTrainUnit position = TMCCTrainUnit::MIDDLE;
+    if (count == 1) {
+      position = TMCCTrainUnit::SINGLE;
+    } else if (i == 0) {
+      position = TMCCTrainUnit::HEAD;
+    } else if (i + 1 == count) {
+      position = TMCCTrainUnit::REAR;
+    }
+    uint8_t engine = unit.engine->get_address();
+    if (!this->bus_->send_frame(TMCC1_HEADER, tmcc_engine_assign_train_word(engine, this->address_))) {
+      failed++;
+    }
+    if (!this->bus_->send_frame(TMCC1_HEADER, tmcc_engine_unit_word(engine, position, unit.reversed))) {
+      failed++;
+    }
+  }
+
+  if (failed > 0) {
+    ESP_LOGW(TAG, "Train %u: %zu lash-up command(s) dropped, press assign again", this->address_, failed);
+  } else {
+    ESP_LOGI(TAG, "Train %u: assigned %zu unit(s)", this->address_, count);
+  }
+}
+
+// ============================================================================
+// TMCCTrainAssign implementation
+// ============================================================================
+
+void TMCCTrainAssign::set_train(TMCCTrain *train) {
+  this->train_ = train;
+}
+
+void TMCCTrainAssign::dump_config() {
+  LOG_BUTTON("", "TMCC Train Assign", this);
+  if (this->train_ != nullptr) {
+    ESP_LOGCONFIG(TAG, "  Train Address: %u", this->train_->get_address());
+  }
+}
+
+void TMCCTrainAssign::press_action() {
+  if (this->train_ != nullptr) {
+    this->train_->assign_units();
+  }
+}
+
+}  // namespace tmcc
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <vector>
+
+#include "esphome/core/component.h"
+#include "esphome/components/button/button.h"
+#include "tmcc_engine.h"
+
+namespace tmcc {
+
+/**
+ * One engine in a lash-up.
+ */
+struct TMCCTrainUnitConfig {
+  TMCCEngine *engine;
+  bool reversed;  // Runs backwards relative to the train
+};
+
+/**
+ * TMCCTrain - A lash-up (consist) of engines driven as one.
+ *
+ * A train is addressed with TRAIN words, so one speed, direction or horn
+ * frame moves every unit in step instead of one frame per engine. It
+ * accepts the same speed, direction and button entities as an engine.
+ *
+ * assign_units() builds the lash-up in the command base with the extended
+ * "assign to train" and "assign unit" commands: the first unit becomes the
+ * head end, the last the rear end and any others middle units.
+ */
+class TMCCTrain : public TMCCEngine {
+ public:
+  TMCCTrain();
+
+  void setup() override;
+  void dump_config() override;
+
+  void add_unit(TMCCEngine *engine, bool reversed);
+  void set_assign_on_boot(bool assign_on_boot);
+
+  // Send the lash-up commands for every unit
+  void assign_units();
+
+ protected:
+  std::vector<TMCCTrainUnitConfig> units_;
+  bool assign_on_boot_{false};
+};
+
+/**
+ * Button that (re)builds a train's lash-up in the command base.
+ */
+class TMCCTrainAssign : public esphome::button::Button, public esphome::Component {
+ public:
+  void set_train(TMCCTrain *train);
+  void dump_config() override;
+
+ protected:
+  void press_action() override;
+  TMCCTrain *train_{nullptr};
+};
+
+}  // namespace tmcc
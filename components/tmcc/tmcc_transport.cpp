@@ -0,0 +1,52 @@
+#include "tmcc_transport.h"
+
+namespace tmcc {
+
+bool TMCCLoopbackTransport::begin() {
+  return true;
+}
+
+void TMCCLoopbackTransport::write(const uint8_t *data, size_t len) {
+  size_t head = this->head_.load(std::memory_order_relaxed);
+  size_t tail = this->tail_.load(std::memory_order_acquire);
+  for (size_t i = 0; i < len; i++) {
+    if (head - tail == TMCC_LOOPBACK_SIZE) {
+      this->bytes_dropped_ += len - i;
+      break;
+    }
+    this->buffer_[head % TMCC_LOOPBACK_SIZE] = data[i];
+    head++;
+    this->bytes_written_++;
+  }
+  this->head_.store(head, std::memory_order_release);
+}
+
+void TMCCLoopbackTransport::flush() {
+  // Nothing is ever in flight
+}
+
+size_t TMCCLoopbackTransport::read(uint8_t *data, size_t max) {
+  size_t tail = this->tail_.load(std::memory_order_relaxed);
+  size_t head = this->head_.load(std::memory_order_acquire);
+  size_t count = 0;
+  while (tail != head && count < max) {
+    data[count++] = this->buffer_[tail % TMCC_LOOPBACK_SIZE];
+    tail++;
+  }
+  this->tail_.store(tail, std::memory_order_release);
+  return count;
+}
+
+const char *TMCCLoopbackTransport::get_name() const {
+  return "loopback";
+}
+
+uint32_t TMCCLoopbackTransport::get_bytes_written() const {
+  return this->bytes_written_;
+}
+
+uint32_t TMCCLoopbackTransport::get_bytes_dropped() const {
+  return this->bytes_dropped_;
+}
+
+}  // namespace tmcc
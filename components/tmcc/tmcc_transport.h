@@ -0,0 +1,70 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace tmcc {
+
+/**
+ * TMCCTransport - The byte pipe between TMCCBus and the command base.
+ *
+ * The bus only ever writes whole frames, waits for them with flush(), and
+ * reads bytes coming back, sleeping in wait_readable() between reads;
+ * framing, queueing and pacing stay in the bus. Swapping the backend changes nothing above it.
+ *
+ * write() and flush() are serialised by the bus's write lock. read() is
+ * only called from the receive task, possibly while a write is running.
+ */
+class TMCCTransport {
+ public:
+  virtual ~TMCCTransport() = default;
+
+  // Open the backend from TMCCBus::setup(); false marks the bus failed
+  virtual bool begin() = 0;
+  // Hand bytes to the backend. May return before they are on the wire.
+  virtual void write(const uint8_t *data, size_t len) = 0;
+  // Block until every written byte has left the wire
+  virtual void flush() = 0;
+  // Copy up to `max` received bytes without blocking; returns how many
+  virtual size_t read(uint8_t *data, size_t max) = 0;
+  // Sleep until read() may have bytes, at most `timeout_ms`. false means
+  // the backend cannot wait this way and the caller should poll.
+  virtual bool wait_readable(uint32_t /*timeout_ms*/) { return false; }
+  // For dump_config
+  virtual const char *get_name() const = 0;
+};
+
+// Bytes the loopback transport holds before it drops writes
+static constexpr size_t TMCC_LOOPBACK_SIZE = 256;
+
+/**
+ * TMCCLoopbackTransport - In-memory transport that echoes every write.
+ *
+ * Written bytes come back from read(), like a command base that repeats
+ * its traffic, so the whole TX/RX path (including adaptive pacing) runs
+ * without hardware. The ring is single-producer/single-consumer and lock
+ * free; when it is full new bytes are dropped and counted.
+ *
+ * Plain C++ with no ESPHome or FreeRTOS dependencies.
+ */
+class TMCCLoopbackTransport : public TMCCTransport {
+ public:
+  bool begin() override;
+  void write(const uint8_t *data, size_t len) override;
+  void flush() override;
+  size_t read(uint8_t *data, size_t max) override;
+  const char *get_name() const override;
+
+  uint32_t get_bytes_written() const;
+  uint32_t get_bytes_dropped() const;
+
+ protected:
+  uint8_t buffer_[TMCC_LOOPBACK_SIZE];
+  std::atomic<size_t> head_{0};  // Total bytes written; advanced by write() only
+  std::atomic<size_t> tail_{0};  // Total bytes read; advanced by read() only
+  uint32_t bytes_written_{0};
+  uint32_t bytes_dropped_{0};
+};
+
+}  // namespace tmcc
@@ -0,0 +1,144 @@
+#include "tmcc_uart_transport.h"
+#include "esphome/core/log.h"
+
+namespace tmcc {
+
+static const char *const TAG = "tmcc.transport";
+
+#ifdef USE_TMCC_UART_TRANSPORT
+
+// ============================================================================
+// TMCCUARTTransport implementation
+// ============================================================================
+
+void TMCCUARTTransport::set_uart(esphome::uart::UARTComponent *uart) {
+  this->uart_ = uart;
+}
+
+bool TMCCUARTTransport::begin() {
+  if (this->uart_ == nullptr) {
+    ESP_LOGE(TAG, "UART not configured!");
+    return false;
+  }
+  return true;
+}
+
+void TMCCUARTTransport::write(const uint8_t *data, size_t len) {
+  this->uart_->write_array(data, len);
+}
+
+void TMCCUARTTransport::flush() {
+  this->uart_->flush();
+}
+
+size_t TMCCUARTTransport::read(uint8_t *data, size_t max) {
+  size_t count = 0;
+  while (count < max && this->uart_->available() > 0 && this->uart_->read_byte(&data[count])) {
+    count++;
+  }
+  return count;
+}
+
+const char *TMCCUARTTransport::get_name() const {
+  return "ESPHome UART";
+}
+
+#endif  // USE_TMCC_UART_TRANSPORT
+
+#ifdef USE_TMCC_IDF_UART_TRANSPORT
+
+// ============================================================================
+// TMCCIDFUARTTransport implementation
+// ============================================================================
+
+// Driver ring buffers; both must be larger than the 128-byte hardware FIFO
+static const int IDF_UART_RX_BUFFER_SIZE = 256;
+static const int IDF_UART_TX_BUFFER_SIZE = 256;
+// Driver events (data, overflow, break...) waiting for the receive task
+static const int IDF_UART_EVENT_QUEUE_SIZE = 16;
+// Longest flush() waits; a full TX buffer drains in ~270 ms at 9600 baud
+static const TickType_t IDF_UART_FLUSH_TIMEOUT = pdMS_TO_TICKS(500);
+
+void TMCCIDFUARTTransport::set_uart_num(uint8_t uart_num) {
+  this->uart_num_ = static_cast<uart_port_t>(uart_num);
+}
+
+void TMCCIDFUARTTransport::set_tx_pin(int tx_pin) {
+  this->tx_pin_ = tx_pin;
+}
+
+void TMCCIDFUARTTransport::set_rx_pin(int rx_pin) {
+  this->rx_pin_ = rx_pin;
+}
+
+void TMCCIDFUARTTransport::set_baud_rate(uint32_t baud_rate) {
+  this->baud_rate_ = baud_rate;
+}
+
+void TMCCIDFUARTTransport::set_inverted(bool inverted) {
+  this->inverted_ = inverted;
+}
+
+bool TMCCIDFUARTTransport::begin() {
+  uart_config_t config{};
+  config.baud_rate = static_cast<int>(this->baud_rate_);
+  config.data_bits = UART_DATA_8_BITS;
+  config.parity = UART_PARITY_DISABLE;
+  config.stop_bits = UART_STOP_BITS_1;
+  config.flow_ctrl = UART_HW_FLOWCTRL_DISABLE;
+  config.source_clk = UART_SCLK_DEFAULT;
+
+  esp_err_t err = uart_driver_install(this->uart_num_, IDF_UART_RX_BUFFER_SIZE, IDF_UART_TX_BUFFER_SIZE,
+                                      IDF_UART_EVENT_QUEUE_SIZE, &this->event_queue_, 0);
+  if (err == ESP_OK) {
+    err = uart_param_config(this->uart_num_, &config);
+  }
+  if (err == ESP_OK) {
+    err = uart_set_pin(this->uart_num_, this->tx_pin_, this->rx_pin_, UART_PIN_NO_CHANGE, UART_PIN_NO_CHANGE);
+  }
+  if (err == ESP_OK && this->inverted_) {
+    err = uart_set_line_inverse(this->uart_num_, UART_SIGNAL_TXD_INV | UART_SIGNAL_RXD_INV);
+  }
+  if (err != ESP_OK) {
+    ESP_LOGE(TAG, "Could not set up UART%u: %s", this->uart_num_, esp_err_to_name(err));
+    return false;
+  }
+  return true;
+}
+
+void TMCCIDFUARTTransport::write(const uint8_t *data, size_t len) {
+  // Copies into the TX ring buffer; only blocks if the buffer is full
+  uart_write_bytes(this->uart_num_, data, len);
+}
+
+void TMCCIDFUARTTransport::flush() {
+  uart_wait_tx_done(this->uart_num_, IDF_UART_FLUSH_TIMEOUT);
+}
+
+size_t TMCCIDFUARTTransport::read(uint8_t *data, size_t max) {
+  int count = uart_read_bytes(this->uart_num_, data, max, 0);
+  return count > 0 ? static_cast<size_t>(count) : 0;
+}
+
+bool TMCCIDFUARTTransport::wait_readable(uint32_t timeout_ms) {
+  uart_event_t event;
+  if (xQueueReceive(this->event_queue_, &event, pdMS_TO_TICKS(timeout_ms)) != pdTRUE) {
+    return true;
+  }
+  if (event.type == UART_FIFO_OVF || event.type == UART_BUFFER_FULL) {
+    // The driver stops taking bytes until the input is flushed; the parser
+    // resynchronises on the next header
+    ESP_LOGW(TAG, "UART%u RX overflow", this->uart_num_);
+    uart_flush_input(this->uart_num_);
+    xQueueReset(this->event_queue_);
+  }
+  return true;
+}
+
+const char *TMCCIDFUARTTransport::get_name() const {
+  return "ESP-IDF UART";
+}
+
+#endif  // USE_TMCC_IDF_UART_TRANSPORT
+
+}  // namespace tmcc
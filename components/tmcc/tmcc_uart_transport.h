@@ -0,0 +1,74 @@
+#pragma once
+
+#include "esphome/core/defines.h"
+#include "tmcc_transport.h"
+
+#ifdef USE_TMCC_UART_TRANSPORT
+#include "esphome/components/uart/uart.h"
+#endif
+#ifdef USE_TMCC_IDF_UART_TRANSPORT
+#include "driver/uart.h"
+#endif
+
+namespace tmcc {
+
+#ifdef USE_TMCC_UART_TRANSPORT
+/**
+ * TMCCUARTTransport - An ESPHome `uart:` component (`uart_id`).
+ *
+ * flush() waits the way the UART component does on this platform. The
+ * component has no receive notification, so wait_readable() keeps the
+ * default and the bus polls read().
+ */
+class TMCCUARTTransport : public TMCCTransport {
+ public:
+  void set_uart(esphome::uart::UARTComponent *uart);
+
+  bool begin() override;
+  void write(const uint8_t *data, size_t len) override;
+  void flush() override;
+  size_t read(uint8_t *data, size_t max) override;
+  const char *get_name() const override;
+
+ protected:
+  esphome::uart::UARTComponent *uart_{nullptr};
+};
+#endif  // USE_TMCC_UART_TRANSPORT
+
+#ifdef USE_TMCC_IDF_UART_TRANSPORT
+/**
+ * TMCCIDFUARTTransport - An ESP32 UART driven through the ESP-IDF driver.
+ *
+ * write() copies the frame into the driver's TX ring buffer and returns;
+ * the UART interrupt feeds the FIFO from there. flush() blocks on the
+ * driver's TX-done semaphore, which the interrupt gives once the last
+ * stop bit is out, so the writer task sleeps instead of polling the FIFO.
+ * The receive task likewise sleeps on the driver's event queue until the
+ * RX interrupt reports data.
+ */
+class TMCCIDFUARTTransport : public TMCCTransport {
+ public:
+  void set_uart_num(uint8_t uart_num);
+  void set_tx_pin(int tx_pin);
+  void set_rx_pin(int rx_pin);  // -1 = transmit only
+  void set_baud_rate(uint32_t baud_rate);
+  void set_inverted(bool inverted);  // Invert TX and RX, for wiring without an inverting buffer
+
+  bool begin() override;
+  void write(const uint8_t *data, size_t len) override;
+  void flush() override;
+  size_t read(uint8_t *data, size_t max) override;
+  bool wait_readable(uint32_t timeout_ms) override;
+  const char *get_name() const override;
+
+ protected:
+  uart_port_t uart_num_{UART_NUM_1};
+  QueueHandle_t event_queue_{nullptr};
+  int tx_pin_{-1};
+  int rx_pin_{-1};
+  uint32_t baud_rate_{9600};
+  bool inverted_{false};
+};
+#endif  // USE_TMCC_IDF_UART_TRANSPORT
+
+}  // namespace tmcc
@@ -0,0 +1,83 @@
+// Per-command CPU cost of TMCCBus on the UART stub: the caller's share
+// (enqueue) and the whole path (enqueue, writer task, transport write),
+// with the simulated wire not holding anything up.
+//
+// Usage: bench_bus [--quick]
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <cstdlib>
+#include <ctime>
+#include <thread>
+
+#include "esphome/components/uart/uart.h"
+#include "esphome/core/component.h"
+#include "tmcc.h"
+#include "tmcc_uart_transport.h"
+
+using namespace tmcc;
+
+static double elapsed_ns(std::chrono::steady_clock::time_point start) {
+  return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+}
+
+static void wait_idle(TMCCBus *bus) {
+  while (!bus->is_tx_idle()) {
+    std::this_thread::yield();
+  }
+}
+
+// Send `commands` words produced by `word_for`, refilling the queue as the
+// writer drains it, and report the caller's and the process's cost
+template<typename F> static void run(const char *name, TMCCBus *bus, uint32_t commands, F &&word_for) {
+  uint32_t sent_before = bus->get_frames_sent();
+  double enqueue_ns = 0;
+  std::clock_t cpu_start = std::clock();
+  auto start = std::chrono::steady_clock::now();
+  for (uint32_t i = 0; i < commands; i++) {
+    while (bus->get_queue_free() == 0) {
+      std::this_thread::yield();
+    }
+    auto send_start = std::chrono::steady_clock::now();
+    bus->send_tmcc1_frame(word_for(i));
+    enqueue_ns += elapsed_ns(send_start);
+  }
+  wait_idle(bus);
+  double wall_ns = elapsed_ns(start);
+  double cpu_ns = 1e9 * (std::clock() - cpu_start) / CLOCKS_PER_SEC;
+  uint32_t frames = bus->get_frames_sent() - sent_before;
+  std::printf("%-24s %8u cmds %7u frames  enqueue %7.0f ns/cmd  cpu %7.0f ns/cmd  wall %7.0f ns/cmd\n", name,
+              commands, frames, enqueue_ns / commands, cpu_ns / commands, wall_ns / commands);
+}
+
+int main(int argc, char **argv) {
+  bool quick = argc > 1 && std::strcmp(argv[1], "--quick") == 0;
+  uint32_t commands = quick ? 2000 : 200000;
+
+  // Never freed: the bus tasks run until the process exits
+  auto *uart = new esphome::uart::UARTComponent();
+  auto *transport = new TMCCUARTTransport();
+  transport->set_uart(uart);
+  auto *bus = new TMCCBus();
+  bus->set_transport(transport);
+  bus->set_queue_size(32);
+  bus->setup();
+  if (bus->is_failed()) {
+    std::printf("bus setup failed\n");
+    return 1;
+  }
+
+  run("action, one engine", bus, commands,
+      [](uint32_t /*i*/) { return tmcc_engine_action_word(1, TMCCEngineAction::RING_BELL); });
+  uart->clear_tx();
+  run("action, 16 engines", bus, commands, [](uint32_t i) {
+    return tmcc_engine_action_word(1 + (i & 0x0F), TMCCEngineAction::RING_BELL);
+  });
+  uart->clear_tx();
+  // Speeds for one engine coalesce while they wait: fewer frames than commands
+  run("speed, one engine", bus, commands, [](uint32_t i) { return tmcc_engine_speed_word(1, i & 0x1F); });
+
+  std::fflush(stdout);
+  std::_Exit(0);
+}
@@ -0,0 +1,64 @@
+// Encode throughput of the word helpers, the frame table and the decoder.
+//
+// Usage: bench_encode [--quick]
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+
+#include "tmcc_protocol.h"
+
+using namespace tmcc;
+
+// Keeps results alive so the loops are not optimised away
+static volatile uint32_t sink;
+
+template<typename F> static void run(const char *name, uint32_t iterations, F &&body) {
+  uint32_t checksum = 0;
+  auto start = std::chrono::steady_clock::now();
+  for (uint32_t i = 0; i < iterations; i++) {
+    checksum += body(i);
+  }
+  auto end = std::chrono::steady_clock::now();
+  sink = checksum;
+  double ns = std::chrono::duration<double, std::nano>(end - start).count();
+  std::printf("%-28s %10u ops %8.2f ns/op %8.1f Mops/s\n", name, iterations, ns / iterations,
+              iterations * 1000.0 / ns);
+}
+
+int main(int argc, char **argv) {
+  bool quick = argc > 1 && std::strcmp(argv[1], "--quick") == 0;
+  uint32_t iterations = quick ? 100000 : 20000000;
+
+  run("engine action word", iterations, [](uint32_t i) {
+    return tmcc_engine_action_word(i & 0x7F, static_cast<TMCCEngineAction>(i % TMCC_ENGINE_ACTION_COUNT));
+  });
+  run("engine speed word", iterations, [](uint32_t i) { return tmcc_engine_speed_word(i & 0x7F, i & 0x1F); });
+  run("legacy speed word", iterations, [](uint32_t i) { return tmcc2_engine_speed_word(i & 0x7F, i % 200); });
+  run("switch word", iterations,
+      [](uint32_t i) { return tmcc_switch_word(i & 0x7F, (i & 1) ? TMCCSwitchAction::THROW_OUT : TMCCSwitchAction::THROW_THROUGH); });
+  run("frame table lookup", iterations, [](uint32_t i) {
+    static TMCCEngineFrameTable table = [] {
+      TMCCEngineFrameTable built;
+      tmcc_build_frame_table(TMCCObjectType::ENGINE, 12, TMCCProtocol::TMCC1, &built);
+      return built;
+    }();
+    return table.action_words[i % TMCC_ENGINE_ACTION_COUNT] + (table.speed_base | (i & 0x1F));
+  });
+  run("frame table build", iterations / 20, [](uint32_t i) {
+    TMCCEngineFrameTable table;
+    tmcc_build_frame_table((i & 1) ? TMCCObjectType::TRAIN : TMCCObjectType::ENGINE, i & 0x0F,
+                           (i & 2) ? TMCCProtocol::LEGACY : TMCCProtocol::TMCC1, &table);
+    return table.speed_base + table.action_words[i % TMCC_ENGINE_ACTION_COUNT];
+  });
+  run("legacy parameter frames", iterations, [](uint32_t i) {
+    TMCCFrame frames[TMCC2_PARAMETER_FRAME_COUNT];
+    tmcc2_make_parameter_frames(TMCC2_ENGINE_HEADER, i & 0x7F, TMCC2ParameterIndex::DIALOG, i & 0xFF, frames);
+    return frames[2].word;
+  });
+  run("decode word", iterations, [](uint32_t i) {
+    TMCCDecodedWord decoded;
+    return tmcc_decode_word(static_cast<uint16_t>(i * 40503u), &decoded) ? decoded.data : 0u;
+  });
+  return 0;
+}
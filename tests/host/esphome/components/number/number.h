@@ -0,0 +1,40 @@
+#pragma once
+
+namespace esphome {
+namespace number {
+
+class Number;
+
+class NumberCall {
+ public:
+  explicit NumberCall(Number *parent) : parent_(parent) {}
+  NumberCall &set_value(float value) {
+    this->value_ = value;
+    return *this;
+  }
+  void perform();
+
+ protected:
+  Number *parent_;
+  float value_{0.0f};
+};
+
+class Number {
+ public:
+  virtual ~Number() = default;
+  NumberCall make_call() { return NumberCall(this); }
+  void publish_state(float state) { this->state = state; }
+
+  float state{0.0f};
+
+ protected:
+  friend class NumberCall;
+  virtual void control(float value) = 0;
+};
+
+inline void NumberCall::perform() { this->parent_->control(this->value_); }
+
+}  // namespace number
+}  // namespace esphome
+
+#define LOG_NUMBER(prefix, type, obj) ((void) (obj))
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <string>
+
+namespace esphome {
+namespace select {
+
+class Select;
+
+class SelectCall {
+ public:
+  explicit SelectCall(Select *parent) : parent_(parent) {}
+  SelectCall &set_option(const std::string &option) {
+    this->option_ = option;
+    return *this;
+  }
+  void perform();
+
+ protected:
+  Select *parent_;
+  std::string option_;
+};
+
+class Select {
+ public:
+  virtual ~Select() = default;
+  SelectCall make_call() { return SelectCall(this); }
+  void publish_state(const std::string &state) { this->state = state; }
+
+  std::string state;
+
+ protected:
+  friend class SelectCall;
+  virtual void control(const std::string &value) = 0;
+};
+
+inline void SelectCall::perform() { this->parent_->control(this->option_); }
+
+}  // namespace select
+}  // namespace esphome
+
+#define LOG_SELECT(prefix, type, obj) ((void) (obj))
@@ -0,0 +1,52 @@
+#pragma once
+
+// Host stand-in for the ESPHome socket component: the same Socket
+// interface over plain POSIX sockets.
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/select.h>
+#include <sys/socket.h>
+#include <sys/types.h>
+#include <cerrno>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+namespace esphome {
+namespace socket {
+
+class Socket {
+ public:
+  explicit Socket(int fd) : fd_(fd) {}
+  ~Socket();
+  Socket(const Socket &) = delete;
+  Socket &operator=(const Socket &) = delete;
+
+  std::unique_ptr<Socket> accept(struct sockaddr *addr, socklen_t *addrlen);
+  int bind(const struct sockaddr *addr, socklen_t addrlen);
+  int close();
+  int connect(const struct sockaddr *addr, socklen_t addrlen);
+  int getpeername(struct sockaddr *addr, socklen_t *addrlen);
+  std::string getpeername();
+  int getsockopt(int level, int optname, void *optval, socklen_t *optlen);
+  int setsockopt(int level, int optname, const void *optval, socklen_t optlen);
+  int listen(int backlog);
+  ssize_t read(void *buf, size_t len);
+  ssize_t write(const void *buf, size_t len);
+  int setblocking(bool blocking);
+  int get_fd() const { return this->fd_; }
+
+ protected:
+  int fd_;
+};
+
+std::unique_ptr<Socket> socket(int domain, int type, int protocol);
+// IPv4 on the host
+std::unique_ptr<Socket> socket_ip(int type, int protocol);
+socklen_t set_sockaddr(struct sockaddr *addr, socklen_t addrlen, const std::string &ip_address, uint16_t port);
+socklen_t set_sockaddr_any(struct sockaddr *addr, socklen_t addrlen, uint16_t port);
+
+}  // namespace socket
+}  // namespace esphome
@@ -0,0 +1,59 @@
+#pragma once
+
+// Host stand-in for the ESPHome UART component. Written bytes are kept
+// with the time each one would finish on a simulated wire at the
+// configured baud rate (10 bits per byte), so tests can check both what
+// was sent and how it was paced. Received bytes are injected by the test,
+// or echoed back from the writes like a command base that repeats its
+// traffic.
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <vector>
+
+namespace esphome {
+namespace uart {
+
+struct UARTByte {
+  uint8_t value;
+  uint64_t wire_end_us;  // Simulated time the stop bit leaves the wire
+};
+
+class UARTComponent {
+ public:
+  void set_baud_rate(uint32_t baud_rate);
+  uint32_t get_baud_rate() const;
+
+  void write_array(const uint8_t *data, size_t len);
+  // Without real time the wire is "drained" at once; with it flush()
+  // sleeps until the simulated wire is idle, like the real driver
+  void flush();
+  int available();
+  bool read_byte(uint8_t *data);
+
+  // Host controls
+  void set_echo(bool echo);          // Written bytes come back on RX
+  void set_realtime(bool realtime);  // flush() waits for the simulated wire
+  void inject_rx(const uint8_t *data, size_t len);
+
+  // Snapshot of everything written so far
+  std::vector<UARTByte> get_tx() const;
+  size_t get_tx_size() const;
+  void clear_tx();
+
+ protected:
+  uint64_t byte_time_us_() const;
+
+  mutable std::mutex lock_;
+  uint32_t baud_rate_{9600};
+  bool echo_{false};
+  bool realtime_{false};
+  uint64_t wire_free_us_{0};  // Simulated time the last written byte ends
+  std::vector<UARTByte> tx_;
+  std::deque<uint8_t> rx_;
+};
+
+}  // namespace uart
+}  // namespace esphome
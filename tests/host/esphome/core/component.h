@@ -0,0 +1,102 @@
+#pragma once
+
+// Host stand-in for esphome/core/component.h. Components keep their own
+// named timers, which App.loop() runs from the calling (main) thread just
+// like the ESPHome scheduler does.
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace esphome {
+
+namespace setup_priority {
+static constexpr float BUS = 1000.0f;
+static constexpr float IO = 900.0f;
+static constexpr float HARDWARE = 800.0f;
+static constexpr float DATA = 600.0f;
+static constexpr float PROCESSOR = 400.0f;
+static constexpr float WIFI = 250.0f;
+static constexpr float AFTER_WIFI = 200.0f;
+static constexpr float AFTER_CONNECTION = 100.0f;
+static constexpr float LATE = -100.0f;
+}  // namespace setup_priority
+
+class Component {
+ public:
+  virtual ~Component() = default;
+
+  virtual void setup() {}
+  virtual void loop() {}
+  virtual void dump_config() {}
+  virtual float get_setup_priority() const { return setup_priority::DATA; }
+
+  void mark_failed() { this->failed_ = true; }
+  bool is_failed() const { return this->failed_; }
+
+  // Run due timers; called by App.loop()
+  void call_scheduler();
+
+ protected:
+  void set_interval(const std::string &name, uint32_t interval_ms, std::function<void()> &&f);
+  void set_interval(uint32_t interval_ms, std::function<void()> &&f);
+  bool cancel_interval(const std::string &name);
+  void set_timeout(const std::string &name, uint32_t timeout_ms, std::function<void()> &&f);
+  void set_timeout(uint32_t timeout_ms, std::function<void()> &&f);
+  bool cancel_timeout(const std::string &name);
+
+  struct Timer {
+    uint32_t id;
+    std::string name;  // Empty for anonymous timers
+    bool repeat;
+    uint32_t interval_ms;
+    uint32_t next_ms;
+    std::function<void()> callback;
+  };
+  void add_timer_(const std::string &name, bool repeat, uint32_t interval_ms, std::function<void()> &&f);
+  bool cancel_timer_(const std::string &name, bool repeat);
+
+  bool failed_{false};
+  std::vector<Timer> timers_;
+  uint32_t next_timer_id_{1};
+};
+
+class PollingComponent : public Component {
+ public:
+  PollingComponent() = default;
+  explicit PollingComponent(uint32_t update_interval) : update_interval_(update_interval) {}
+
+  virtual void update() = 0;
+  void set_update_interval(uint32_t update_interval) { this->update_interval_ = update_interval; }
+  uint32_t get_update_interval() const { return this->update_interval_; }
+
+ protected:
+  uint32_t update_interval_{60000};
+};
+
+/**
+ * Minimal Application: components registered by a test are set up and
+ * looped from the test thread. update() is left to the test.
+ */
+class Application {
+ public:
+  void register_component(Component *component);
+  void setup();
+  void loop();
+  // Loop until `done` returns true or `timeout_ms` passes; returns `done()`
+  bool loop_until(const std::function<bool()> &done, uint32_t timeout_ms);
+  // Loop for `duration_ms`
+  void loop_for(uint32_t duration_ms);
+  // Forget every registered component (they are not deleted)
+  void clear();
+
+ protected:
+  std::vector<Component *> components_;
+};
+
+extern Application App;  // NOLINT
+
+}  // namespace esphome
+
+#define LOG_UPDATE_INTERVAL(this) ((void) (this))
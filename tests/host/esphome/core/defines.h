@@ -0,0 +1,4 @@
+#pragma once
+
+// The host build passes its USE_TMCC_* feature flags on the compiler
+// command line (see tests/CMakeLists.txt) instead of generating them here.
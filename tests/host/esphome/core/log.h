@@ -0,0 +1,30 @@
+#pragma once
+
+// Host stand-in for esphome/core/log.h. Lines go to stderr when their
+// level is at or below TMCC_HOST_LOG (0 = none, 1 = errors ... 5 = verbose;
+// default 1), so test output stays readable.
+
+#include <cstdarg>
+
+namespace esphome {
+
+static constexpr int ESPHOME_LOG_LEVEL_ERROR = 1;
+static constexpr int ESPHOME_LOG_LEVEL_WARN = 2;
+static constexpr int ESPHOME_LOG_LEVEL_INFO = 3;
+static constexpr int ESPHOME_LOG_LEVEL_CONFIG = 4;
+static constexpr int ESPHOME_LOG_LEVEL_DEBUG = 5;
+static constexpr int ESPHOME_LOG_LEVEL_VERBOSE = 6;
+
+void esp_log_printf_(int level, const char *tag, int line, const char *format, ...)
+    __attribute__((format(printf, 4, 5)));
+
+}  // namespace esphome
+
+#define ESP_LOGE(tag, ...) ::esphome::esp_log_printf_(::esphome::ESPHOME_LOG_LEVEL_ERROR, tag, __LINE__, __VA_ARGS__)
+#define ESP_LOGW(tag, ...) ::esphome::esp_log_printf_(::esphome::ESPHOME_LOG_LEVEL_WARN, tag, __LINE__, __VA_ARGS__)
+#define ESP_LOGI(tag, ...) ::esphome::esp_log_printf_(::esphome::ESPHOME_LOG_LEVEL_INFO, tag, __LINE__, __VA_ARGS__)
+#define ESP_LOGCONFIG(tag, ...) \
+  ::esphome::esp_log_printf_(::esphome::ESPHOME_LOG_LEVEL_CONFIG, tag, __LINE__, __VA_ARGS__)
+#define ESP_LOGD(tag, ...) ::esphome::esp_log_printf_(::esphome::ESPHOME_LOG_LEVEL_DEBUG, tag, __LINE__, __VA_ARGS__)
+#define ESP_LOGV(tag, ...) \
+  ::esphome::esp_log_printf_(::esphome::ESPHOME_LOG_LEVEL_VERBOSE, tag, __LINE__, __VA_ARGS__)
@@ -0,0 +1,23 @@
+#pragma once
+
+// Host stand-in for the FreeRTOS kernel API used by the tmcc component.
+// Tasks are std::threads, mutexes are std::timed_mutex and one tick is one
+// millisecond. Only what the component calls is provided.
+
+#include <cstddef>
+#include <cstdint>
+
+typedef int32_t BaseType_t;
+typedef uint32_t UBaseType_t;
+typedef uint32_t TickType_t;
+
+#define pdFALSE ((BaseType_t) 0)
+#define pdTRUE ((BaseType_t) 1)
+#define pdFAIL pdFALSE
+#define pdPASS pdTRUE
+#define errQUEUE_FULL ((BaseType_t) 0)
+
+#define portMAX_DELAY ((TickType_t) 0xFFFFFFFF)
+#define portTICK_PERIOD_MS ((TickType_t) 1)
+#define pdMS_TO_TICKS(ms) ((TickType_t) (ms))
+#define portYIELD_FROM_ISR(woken) ((void) (woken))
@@ -0,0 +1,184 @@
+#include "esphome/core/component.h"
+#include "esphome/core/hal.h"
+#include "esphome/core/log.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+
+namespace esphome {
+
+// ============================================================================
+// Time
+// ============================================================================
+
+static const std::chrono::steady_clock::time_point START = std::chrono::steady_clock::now();
+
+uint32_t micros() {
+  auto elapsed = std::chrono::steady_clock::now() - START;
+  return static_cast<uint32_t>(std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count());
+}
+
+uint32_t millis() {
+  auto elapsed = std::chrono::steady_clock::now() - START;
+  return static_cast<uint32_t>(std::chrono::duration_cast<std::chrono::milliseconds>(elapsed).count());
+}
+
+void delay(uint32_t ms) {
+  std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+}
+
+void delayMicroseconds(uint32_t us) {
+  std::this_thread::sleep_for(std::chrono::microseconds(us));
+}
+
+// ============================================================================
+// Logging
+// ============================================================================
+
+static int log_level() {
+  static const int LEVEL = []() {
+    const char *value = std::getenv("TMCC_HOST_LOG");
+    return value != nullptr ? std::atoi(value) : ESPHOME_LOG_LEVEL_ERROR;
+  }();
+  return LEVEL;
+}
+
+void esp_log_printf_(int level, const char *tag, int line, const char *format, ...) {
+  if (level > log_level()) {
+    return;
+  }
+  static const char LETTERS[] = "?EWICDV";
+  char letter = (level >= 0 && level <= ESPHOME_LOG_LEVEL_VERBOSE) ? LETTERS[level] : '?';
+  std::fprintf(stderr, "[%c][%s:%d]: ", letter, tag, line);
+  va_list args;
+  va_start(args, format);
+  std::vfprintf(stderr, format, args);
+  va_end(args);
+  std::fputc('\n', stderr);
+}
+
+// ============================================================================
+// Component timers
+// ============================================================================
+
+void Component::add_timer_(const std::string &name, bool repeat, uint32_t interval_ms, std::function<void()> &&f) {
+  if (!name.empty()) {
+    // Like the ESPHome scheduler, a named timer replaces its namesake
+    this->cancel_timer_(name, repeat);
+  }
+  this->timers_.push_back(Timer{this->next_timer_id_++, name, repeat, interval_ms, millis() + interval_ms,
+                                std::move(f)});
+}
+
+bool Component::cancel_timer_(const std::string &name, bool repeat) {
+  auto it = std::find_if(this->timers_.begin(), this->timers_.end(),
+                         [&](const Timer &timer) { return timer.repeat == repeat && timer.name == name; });
+  if (it == this->timers_.end()) {
+    return false;
+  }
+  this->timers_.erase(it);
+  return true;
+}
+
+void Component::set_interval(const std::string &name, uint32_t interval_ms, std::function<void()> &&f) {
+  this->add_timer_(name, true, interval_ms, std::move(f));
+}
+
+void Component::set_interval(uint32_t interval_ms, std::function<void()> &&f) {
+  this->add_timer_("", true, interval_ms, std::move(f));
+}
+
+bool Component::cancel_interval(const std::string &name) {
+  return this->cancel_timer_(name, true);
+}
+
+void Component::set_timeout(const std::string &name, uint32_t timeout_ms, std::function<void()> &&f) {
+  this->add_timer_(name, false, timeout_ms, std::move(f));
+}
+
+void Component::set_timeout(uint32_t timeout_ms, std::function<void()> &&f) {
+  this->add_timer_("", false, timeout_ms, std::move(f));
+}
+
+bool Component::cancel_timeout(const std::string &name) {
+  return this->cancel_timer_(name, false);
+}
+
+void Component::call_scheduler() {
+  // Callbacks may add or cancel timers, so each due timer is looked up by
+  // id again before it runs
+  uint32_t now = millis();
+  std::vector<uint32_t> due;
+  for (const Timer &timer : this->timers_) {
+    if (static_cast<int32_t>(now - timer.next_ms) >= 0) {
+      due.push_back(timer.id);
+    }
+  }
+  for (uint32_t id : due) {
+    auto it = std::find_if(this->timers_.begin(), this->timers_.end(),
+                           [id](const Timer &timer) { return timer.id == id; });
+    if (it == this->timers_.end()) {
+      continue;
+    }
+    std::function<void()> callback = it->callback;
+    if (it->repeat) {
+      it->next_ms = now + it->interval_ms;
+    } else {
+      this->timers_.erase(it);
+    }
+    callback();
+  }
+}
+
+// ============================================================================
+// Application
+// ============================================================================
+
+Application App;  // NOLINT
+
+void Application::register_component(Component *component) {
+  this->components_.push_back(component);
+}
+
+void Application::setup() {
+  std::stable_sort(this->components_.begin(), this->components_.end(), [](Component *a, Component *b) {
+    return a->get_setup_priority() > b->get_setup_priority();
+  });
+  for (Component *component : this->components_) {
+    component->setup();
+  }
+}
+
+void Application::loop() {
+  for (Component *component : this->components_) {
+    component->call_scheduler();
+    if (!component->is_failed()) {
+      component->loop();
+    }
+  }
+}
+
+bool Application::loop_until(const std::function<bool()> &done, uint32_t timeout_ms) {
+  uint32_t start = millis();
+  while (!done()) {
+    if (millis() - start >= timeout_ms) {
+      return false;
+    }
+    this->loop();
+    std::this_thread::sleep_for(std::chrono::microseconds(200));
+  }
+  return true;
+}
+
+void Application::loop_for(uint32_t duration_ms) {
+  this->loop_until([]() { return false; }, duration_ms);
+}
+
+void Application::clear() {
+  this->components_.clear();
+}
+
+}  // namespace esphome
@@ -0,0 +1,157 @@
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+
+#include <chrono>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// ============================================================================
+// Tasks and notifications
+// ============================================================================
+
+struct HostTask {
+  std::mutex lock;
+  std::condition_variable notified;
+  uint32_t notify_count{0};
+};
+
+static thread_local HostTask *current_task = nullptr;
+
+static std::chrono::milliseconds ticks_to_duration(TickType_t ticks) {
+  return std::chrono::milliseconds(ticks * portTICK_PERIOD_MS);
+}
+
+BaseType_t xTaskCreate(TaskFunction_t function, const char * /*name*/, uint32_t /*stack_depth*/, void *arg,
+                       UBaseType_t /*priority*/, TaskHandle_t *handle) {
+  // Tasks never end and are never deleted, like the component's
+  HostTask *task = new HostTask();
+  if (handle != nullptr) {
+    *handle = task;
+  }
+  std::thread([task, function, arg]() {
+    current_task = task;
+    function(arg);
+  }).detach();
+  return pdPASS;
+}
+
+void vTaskDelay(TickType_t ticks) {
+  std::this_thread::sleep_for(ticks_to_duration(ticks));
+}
+
+BaseType_t xTaskNotifyGive(TaskHandle_t task) {
+  {
+    std::lock_guard<std::mutex> guard(task->lock);
+    task->notify_count++;
+  }
+  task->notified.notify_one();
+  return pdPASS;
+}
+
+void vTaskNotifyGiveFromISR(TaskHandle_t task, BaseType_t *higher_priority_task_woken) {
+  xTaskNotifyGive(task);
+  if (higher_priority_task_woken != nullptr) {
+    *higher_priority_task_woken = pdTRUE;
+  }
+}
+
+uint32_t ulTaskNotifyTake(BaseType_t clear_on_exit, TickType_t ticks) {
+  HostTask *task = current_task;
+  if (task == nullptr) {
+    // Not called from a task; behave like an expired timeout
+    return 0;
+  }
+  std::unique_lock<std::mutex> guard(task->lock);
+  auto ready = [task]() { return task->notify_count > 0; };
+  if (ticks == portMAX_DELAY) {
+    task->notified.wait(guard, ready);
+  } else if (!task->notified.wait_for(guard, ticks_to_duration(ticks), ready)) {
+    return 0;
+  }
+  uint32_t count = task->notify_count;
+  task->notify_count = clear_on_exit ? 0 : count - 1;
+  return count;
+}
+
+// ============================================================================
+// Mutexes
+// ============================================================================
+
+struct HostSemaphore {
+  std::timed_mutex mutex;
+};
+
+SemaphoreHandle_t xSemaphoreCreateMutex() {
+  return new HostSemaphore();
+}
+
+BaseType_t xSemaphoreTake(SemaphoreHandle_t semaphore, TickType_t ticks) {
+  if (ticks == portMAX_DELAY) {
+    semaphore->mutex.lock();
+    return pdTRUE;
+  }
+  return semaphore->mutex.try_lock_for(ticks_to_duration(ticks)) ? pdTRUE : pdFALSE;
+}
+
+BaseType_t xSemaphoreGive(SemaphoreHandle_t semaphore) {
+  semaphore->mutex.unlock();
+  return pdTRUE;
+}
+
+// ============================================================================
+// Queues
+// ============================================================================
+
+struct HostQueue {
+  std::mutex lock;
+  std::condition_variable changed;
+  size_t length;
+  size_t item_size;
+  std::deque<std::vector<uint8_t>> items;
+};
+
+QueueHandle_t xQueueCreate(UBaseType_t length, UBaseType_t item_size) {
+  HostQueue *queue = new HostQueue();
+  queue->length = length;
+  queue->item_size = item_size;
+  return queue;
+}
+
+BaseType_t xQueueSend(QueueHandle_t queue, const void *item, TickType_t ticks) {
+  std::unique_lock<std::mutex> guard(queue->lock);
+  auto has_room = [queue]() { return queue->items.size() < queue->length; };
+  if (ticks == portMAX_DELAY) {
+    queue->changed.wait(guard, has_room);
+  } else if (!queue->changed.wait_for(guard, ticks_to_duration(ticks), has_room)) {
+    return errQUEUE_FULL;
+  }
+  const uint8_t *bytes = static_cast<const uint8_t *>(item);
+  queue->items.emplace_back(bytes, bytes + queue->item_size);
+  queue->changed.notify_all();
+  return pdTRUE;
+}
+
+BaseType_t xQueueReceive(QueueHandle_t queue, void *item, TickType_t ticks) {
+  std::unique_lock<std::mutex> guard(queue->lock);
+  auto has_item = [queue]() { return !queue->items.empty(); };
+  if (ticks == portMAX_DELAY) {
+    queue->changed.wait(guard, has_item);
+  } else if (!queue->changed.wait_for(guard, ticks_to_duration(ticks), has_item)) {
+    return pdFALSE;
+  }
+  std::memcpy(item, queue->items.front().data(), queue->item_size);
+  queue->items.pop_front();
+  queue->changed.notify_all();
+  return pdTRUE;
+}
+
+UBaseType_t uxQueueMessagesWaiting(QueueHandle_t queue) {
+  std::lock_guard<std::mutex> guard(queue->lock);
+  return queue->items.size();
+}
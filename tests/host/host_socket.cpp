@@ -0,0 +1,123 @@
+#include "esphome/components/socket/socket.h"
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <cstring>
+
+namespace esphome {
+namespace socket {
+
+Socket::~Socket() {
+  this->close();
+}
+
+std::unique_ptr<Socket> Socket::accept(struct sockaddr *addr, socklen_t *addrlen) {
+  int fd = ::accept(this->fd_, addr, addrlen);
+  if (fd < 0) {
+    return nullptr;
+  }
+  return std::unique_ptr<Socket>(new Socket(fd));
+}
+
+int Socket::bind(const struct sockaddr *addr, socklen_t addrlen) {
+  return ::bind(this->fd_, addr, addrlen);
+}
+
+int Socket::close() {
+  if (this->fd_ < 0) {
+    return 0;
+  }
+  int result = ::close(this->fd_);
+  this->fd_ = -1;
+  return result;
+}
+
+int Socket::connect(const struct sockaddr *addr, socklen_t addrlen) {
+  return ::connect(this->fd_, addr, addrlen);
+}
+
+int Socket::getpeername(struct sockaddr *addr, socklen_t *addrlen) {
+  return ::getpeername(this->fd_, addr, addrlen);
+}
+
+std::string Socket::getpeername() {
+  struct sockaddr_in addr;
+  socklen_t len = sizeof(addr);
+  if (::getpeername(this->fd_, reinterpret_cast<struct sockaddr *>(&addr), &len) != 0) {
+    return "";
+  }
+  char buffer[INET_ADDRSTRLEN];
+  inet_ntop(AF_INET, &addr.sin_addr, buffer, sizeof(buffer));
+  return buffer;
+}
+
+int Socket::getsockopt(int level, int optname, void *optval, socklen_t *optlen) {
+  return ::getsockopt(this->fd_, level, optname, optval, optlen);
+}
+
+int Socket::setsockopt(int level, int optname, const void *optval, socklen_t optlen) {
+  return ::setsockopt(this->fd_, level, optname, optval, optlen);
+}
+
+int Socket::listen(int backlog) {
+  return ::listen(this->fd_, backlog);
+}
+
+ssize_t Socket::read(void *buf, size_t len) {
+  return ::recv(this->fd_, buf, len, 0);
+}
+
+ssize_t Socket::write(const void *buf, size_t len) {
+  // A peer that went away must not kill the test with SIGPIPE
+  return ::send(this->fd_, buf, len, MSG_NOSIGNAL);
+}
+
+int Socket::setblocking(bool blocking) {
+  int flags = fcntl(this->fd_, F_GETFL, 0);
+  if (flags < 0) {
+    return -1;
+  }
+  flags = blocking ? (flags & ~O_NONBLOCK) : (flags | O_NONBLOCK);
+  return fcntl(this->fd_, F_SETFL, flags);
+}
+
+std::unique_ptr<Socket> socket(int domain, int type, int protocol) {
+  int fd = ::socket(domain, type, protocol);
+  if (fd < 0) {
+    return nullptr;
+  }
+  return std::unique_ptr<Socket>(new Socket(fd));
+}
+
+std::unique_ptr<Socket> socket_ip(int type, int protocol) {
+  return socket(AF_INET, type, protocol);
+}
+
+socklen_t set_sockaddr(struct sockaddr *addr, socklen_t addrlen, const std::string &ip_address, uint16_t port) {
+  if (addrlen < sizeof(struct sockaddr_in)) {
+    return 0;
+  }
+  struct sockaddr_in *server = reinterpret_cast<struct sockaddr_in *>(addr);
+  std::memset(server, 0, sizeof(*server));
+  server->sin_family = AF_INET;
+  server->sin_port = htons(port);
+  if (inet_pton(AF_INET, ip_address.c_str(), &server->sin_addr) != 1) {
+    return 0;
+  }
+  return sizeof(*server);
+}
+
+socklen_t set_sockaddr_any(struct sockaddr *addr, socklen_t addrlen, uint16_t port) {
+  if (addrlen < sizeof(struct sockaddr_in)) {
+    return 0;
+  }
+  struct sockaddr_in *server = reinterpret_cast<struct sockaddr_in *>(addr);
+  std::memset(server, 0, sizeof(*server));
+  server->sin_family = AF_INET;
+  server->sin_port = htons(port);
+  server->sin_addr.s_addr = htonl(INADDR_ANY);
+  return sizeof(*server);
+}
+
+}  // namespace socket
+}  // namespace esphome
@@ -0,0 +1,106 @@
+#include "esphome/components/uart/uart.h"
+
+#include <algorithm>
+#include <chrono>
+#include <thread>
+
+namespace esphome {
+namespace uart {
+
+// Simulated wire time, so it never wraps during a test
+static uint64_t now_us() {
+  static const auto START = std::chrono::steady_clock::now();
+  return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - START).count();
+}
+
+void UARTComponent::set_baud_rate(uint32_t baud_rate) {
+  std::lock_guard<std::mutex> guard(this->lock_);
+  this->baud_rate_ = baud_rate;
+}
+
+uint32_t UARTComponent::get_baud_rate() const {
+  std::lock_guard<std::mutex> guard(this->lock_);
+  return this->baud_rate_;
+}
+
+uint64_t UARTComponent::byte_time_us_() const {
+  // Start bit, 8 data bits, stop bit
+  return 10ULL * 1000000ULL / this->baud_rate_;
+}
+
+void UARTComponent::write_array(const uint8_t *data, size_t len) {
+  std::lock_guard<std::mutex> guard(this->lock_);
+  // Bytes queue behind whatever is still on the simulated wire
+  uint64_t time = std::max(now_us(), this->wire_free_us_);
+  for (size_t i = 0; i < len; i++) {
+    time += this->byte_time_us_();
+    this->tx_.push_back(UARTByte{data[i], time});
+    if (this->echo_) {
+      this->rx_.push_back(data[i]);
+    }
+  }
+  this->wire_free_us_ = time;
+}
+
+void UARTComponent::flush() {
+  uint64_t wire_free;
+  {
+    std::lock_guard<std::mutex> guard(this->lock_);
+    if (!this->realtime_) {
+      return;
+    }
+    wire_free = this->wire_free_us_;
+  }
+  uint64_t now = now_us();
+  if (wire_free > now) {
+    std::this_thread::sleep_for(std::chrono::microseconds(wire_free - now));
+  }
+}
+
+int UARTComponent::available() {
+  std::lock_guard<std::mutex> guard(this->lock_);
+  return static_cast<int>(this->rx_.size());
+}
+
+bool UARTComponent::read_byte(uint8_t *data) {
+  std::lock_guard<std::mutex> guard(this->lock_);
+  if (this->rx_.empty()) {
+    return false;
+  }
+  *data = this->rx_.front();
+  this->rx_.pop_front();
+  return true;
+}
+
+void UARTComponent::set_echo(bool echo) {
+  std::lock_guard<std::mutex> guard(this->lock_);
+  this->echo_ = echo;
+}
+
+void UARTComponent::set_realtime(bool realtime) {
+  std::lock_guard<std::mutex> guard(this->lock_);
+  this->realtime_ = realtime;
+}
+
+void UARTComponent::inject_rx(const uint8_t *data, size_t len) {
+  std::lock_guard<std::mutex> guard(this->lock_);
+  this->rx_.insert(this->rx_.end(), data, data + len);
+}
+
+std::vector<UARTByte> UARTComponent::get_tx() const {
+  std::lock_guard<std::mutex> guard(this->lock_);
+  return this->tx_;
+}
+
+size_t UARTComponent::get_tx_size() const {
+  std::lock_guard<std::mutex> guard(this->lock_);
+  return this->tx_.size();
+}
+
+void UARTComponent::clear_tx() {
+  std::lock_guard<std::mutex> guard(this->lock_);
+  this->tx_.clear();
+}
+
+}  // namespace uart
+}  // namespace esphome
@@ -0,0 +1,128 @@
+// TMCCBridge with a local TCP client: re-framing, RX forwarding and
+// backpressure from the TX queue
+
+#include <unistd.h>
+
+#include <memory>
+
+#include "esphome/components/socket/socket.h"
+#include "tmcc_bridge.h"
+#include "tmcc_test.h"
+
+using namespace tmcc;
+using tmcc_test::HostBus;
+using tmcc_test::WireFrame;
+
+// One port per test, away from the ports other test runs may hold
+static uint16_t next_port() {
+  static uint16_t port = 20000 + getpid() % 20000;
+  return port++;
+}
+
+static TMCCBridge *make_bridge(const HostBus &host, uint16_t port) {
+  auto *bridge = new TMCCBridge();
+  bridge->set_bus(host.bus);
+  bridge->set_port(port);
+  bridge->setup();
+  esphome::App.register_component(bridge);
+  return bridge;
+}
+
+// Connect to the bridge and let it accept; nullptr on failure
+static std::unique_ptr<esphome::socket::Socket> connect_client(uint16_t port) {
+  auto client = esphome::socket::socket_ip(SOCK_STREAM, 0);
+  struct sockaddr_storage addr;
+  socklen_t len = esphome::socket::set_sockaddr(reinterpret_cast<struct sockaddr *>(&addr), sizeof(addr),
+                                                "127.0.0.1", port);
+  if (client == nullptr || client->connect(reinterpret_cast<struct sockaddr *>(&addr), len) != 0) {
+    return nullptr;
+  }
+  client->setblocking(false);
+  esphome::App.loop_for(20);
+  return client;
+}
+
+static bool send_bytes(esphome::socket::Socket *client, const uint8_t *data, size_t len) {
+  return client->write(data, len) == static_cast<ssize_t>(len);
+}
+
+static void append_frame(std::vector<uint8_t> &bytes, uint8_t header, uint16_t word) {
+  bytes.push_back(header);
+  bytes.push_back(word >> 8);
+  bytes.push_back(word & 0xFF);
+}
+
+TMCC_TEST(frames_split_across_reads_are_joined) {
+  HostBus host = tmcc_test::make_bus();
+  uint16_t port = next_port();
+  TMCCBridge *bridge = make_bridge(host, port);
+  ASSERT_TRUE(!bridge->is_failed());
+  auto client = connect_client(port);
+  ASSERT_TRUE(client != nullptr);
+
+  const uint16_t horn = tmcc_engine_action_word(1, TMCCEngineAction::BLOW_HORN1);
+  const uint16_t speed = tmcc2_engine_speed_word(12, 100);
+  // Half a frame, then its rest with noise and a Legacy frame cut in two
+  const uint8_t first[] = {TMCC1_HEADER, static_cast<uint8_t>(horn >> 8)};
+  const uint8_t second[] = {static_cast<uint8_t>(horn & 0xFF), 0x12, TMCC2_ENGINE_HEADER,
+                            static_cast<uint8_t>(speed >> 8)};
+  const uint8_t third[] = {static_cast<uint8_t>(speed & 0xFF)};
+  ASSERT_TRUE(send_bytes(client.get(), first, sizeof(first)));
+  esphome::App.loop_for(20);
+  ASSERT_TRUE(send_bytes(client.get(), second, sizeof(second)));
+  esphome::App.loop_for(20);
+  ASSERT_TRUE(send_bytes(client.get(), third, sizeof(third)));
+
+  ASSERT_TRUE(host.wait_frames(2));
+  std::vector<WireFrame> frames = host.frames();
+  ASSERT_EQ(frames.size(), 2u);
+  EXPECT_TRUE(frames[0] == (WireFrame{TMCC1_HEADER, horn}));
+  EXPECT_TRUE(frames[1] == (WireFrame{TMCC2_ENGINE_HEADER, speed}));
+}
+
+TMCC_TEST(received_frames_reach_the_client) {
+  HostBus host = tmcc_test::make_bus();
+  uint16_t port = next_port();
+  make_bridge(host, port);
+  auto client = connect_client(port);
+  ASSERT_TRUE(client != nullptr);
+
+  const uint8_t rx[] = {TMCC1_HEADER, 0x00, 0x9C, TMCC2_ENGINE_HEADER, 0xFE, 0xFE};
+  host.uart->inject_rx(rx, sizeof(rx));
+  std::vector<uint8_t> received;
+  ASSERT_TRUE(tmcc_test::wait_for([&]() {
+    uint8_t buffer[16];
+    ssize_t len = client->read(buffer, sizeof(buffer));
+    if (len > 0) {
+      received.insert(received.end(), buffer, buffer + len);
+    }
+    return received.size() >= sizeof(rx);
+  }));
+  EXPECT_TRUE(received == std::vector<uint8_t>(rx, rx + sizeof(rx)));
+}
+
+TMCC_TEST(full_queue_holds_the_client_back) {
+  HostBus host = tmcc_test::make_bus([](TMCCBus *bus) {
+    bus->set_queue_size(2);
+    bus->set_drop_policy(TMCCDropPolicy::DROP_NEWEST);
+  });
+  host.uart->set_realtime(true);
+  uint16_t port = next_port();
+  make_bridge(host, port);
+  auto client = connect_client(port);
+  ASSERT_TRUE(client != nullptr);
+
+  // Far more than the queue holds, in one write
+  std::vector<uint8_t> bytes;
+  for (uint8_t address = 1; address <= 40; address++) {
+    append_frame(bytes, TMCC1_HEADER, tmcc_engine_action_word(address, TMCCEngineAction::RING_BELL));
+  }
+  ASSERT_TRUE(send_bytes(client.get(), bytes.data(), bytes.size()));
+
+  ASSERT_TRUE(host.wait_frames(40, 5000));
+  EXPECT_EQ(host.bus->get_frames_dropped(), 0u);
+  std::vector<WireFrame> frames = host.frames();
+  for (uint8_t address = 1; address <= 40; address++) {
+    EXPECT_EQ(frames[address - 1].word, tmcc_engine_action_word(address, TMCCEngineAction::RING_BELL));
+  }
+}
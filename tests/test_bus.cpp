@@ -0,0 +1,246 @@
+// TMCCBus on the UART stub: what reaches the wire, in which order and when
+
+#include <algorithm>
+
+#include "tmcc_test.h"
+
+using namespace tmcc;
+using tmcc_test::HostBus;
+using tmcc_test::WireFrame;
+
+static const uint16_t BELL_1 = tmcc_engine_action_word(1, TMCCEngineAction::RING_BELL);
+static const uint16_t BELL_2 = tmcc_engine_action_word(2, TMCCEngineAction::RING_BELL);
+static const uint16_t HORN_1 = tmcc_engine_action_word(1, TMCCEngineAction::BLOW_HORN1);
+
+static size_t count_word(const std::vector<WireFrame> &frames, uint16_t word) {
+  return std::count_if(frames.begin(), frames.end(), [word](const WireFrame &frame) { return frame.word == word; });
+}
+
+static size_t index_of(const std::vector<WireFrame> &frames, uint16_t word) {
+  auto it = std::find_if(frames.begin(), frames.end(), [word](const WireFrame &frame) { return frame.word == word; });
+  return it - frames.begin();
+}
+
+TMCC_TEST(frame_goes_out_at_9600_baud) {
+  HostBus host = tmcc_test::make_bus();
+  ASSERT_TRUE(host.bus->send_tmcc1_frame(tmcc_engine_speed_word(5, 12)));
+  ASSERT_TRUE(host.wait_frames(1));
+
+  std::vector<esphome::uart::UARTByte> bytes = host.uart->get_tx();
+  ASSERT_EQ(bytes.size(), TMCC_FRAME_SIZE);
+  EXPECT_EQ(bytes[0].value, TMCC1_HEADER);
+  EXPECT_EQ((bytes[1].value << 8) | bytes[2].value, tmcc_engine_speed_word(5, 12));
+  // 10 bits per byte: one frame is 3.125 ms on the wire
+  EXPECT_EQ(bytes[1].wire_end_us - bytes[0].wire_end_us, 1041u);
+  EXPECT_EQ(bytes[2].wire_end_us - bytes[1].wire_end_us, 1041u);
+}
+
+TMCC_TEST(repetitions_and_statistics) {
+  HostBus host = tmcc_test::make_bus();
+  ASSERT_TRUE(host.bus->send_tmcc1_frame_repeated(BELL_1, 4));
+  ASSERT_TRUE(host.wait_frames(4));
+  EXPECT_TRUE(tmcc_test::wait_for([&host]() { return host.bus->is_tx_idle(); }));
+  std::vector<WireFrame> frames = host.frames();
+  EXPECT_EQ(frames.size(), 4u);
+  EXPECT_EQ(count_word(frames, BELL_1), 4u);
+  EXPECT_EQ(host.bus->get_frames_sent(), 4u);
+  EXPECT_EQ(host.bus->get_bytes_sent(), 12u);
+}
+
+TMCC_TEST(halt_preempts_a_burst_and_purges_motion) {
+  HostBus host = tmcc_test::make_bus([](TMCCBus *bus) { bus->set_halt_repetitions(3); });
+  host.uart->set_realtime(true);
+  ASSERT_TRUE(host.bus->send_tmcc1_frame_repeated(BELL_2, 20));
+  ASSERT_TRUE(host.wait_frames(1));
+  host.bus->send_tmcc1_frame(tmcc_engine_speed_word(1, 10));
+  host.bus->system_halt();
+  ASSERT_TRUE(host.wait_frames(23, 3000));
+
+  std::vector<WireFrame> frames = host.frames();
+  EXPECT_EQ(count_word(frames, TMCC1_SYSTEM_HALT_WORD), 3u);
+  // The halt goes out at the next frame boundary, well before the bells end
+  EXPECT_TRUE(index_of(frames, TMCC1_SYSTEM_HALT_WORD) < 5);
+  // The queued speed would restart the train; it never reaches the wire
+  EXPECT_EQ(count_word(frames, tmcc_engine_speed_word(1, 10)), 0u);
+  EXPECT_EQ(count_word(frames, BELL_2), 20u);
+  EXPECT_TRUE(host.bus->get_halt_latency_last_us() > 0);
+}
+
+TMCC_TEST(queued_speeds_coalesce) {
+  HostBus host = tmcc_test::make_bus();
+  host.uart->set_realtime(true);
+  // Keep the writer busy with another engine while the speeds queue up
+  ASSERT_TRUE(host.bus->send_tmcc1_frame_repeated(BELL_2, 10));
+  for (uint8_t speed = 1; speed <= 10; speed++) {
+    host.bus->engine_speed_absolute_tmcc1(1, speed);
+  }
+  ASSERT_TRUE(tmcc_test::wait_for([&host]() { return host.bus->is_tx_idle(); }, 3000));
+
+  std::vector<WireFrame> frames = host.frames();
+  size_t speeds = frames.size() - count_word(frames, BELL_2);
+  EXPECT_TRUE(speeds < 10);
+  EXPECT_EQ(speeds + host.bus->get_frames_coalesced(), 10u);
+  // Bells and speeds interleave; the newest speed always survives
+  auto last_speed = std::find_if(frames.rbegin(), frames.rend(),
+                                 [](const WireFrame &frame) { return frame.word != BELL_2; });
+  ASSERT_TRUE(last_speed != frames.rend());
+  EXPECT_EQ(last_speed->word, tmcc_engine_speed_word(1, 10));
+}
+
+TMCC_TEST(legacy_parameter_frames_go_out_back_to_back) {
+  HostBus host = tmcc_test::make_bus();
+  host.uart->set_realtime(true);
+  ASSERT_TRUE(host.bus->send_tmcc1_frame_repeated(BELL_2, 6));
+  host.bus->engine_parameter_tmcc2(1, TMCC2ParameterIndex::DIALOG, 3);
+  ASSERT_TRUE(host.wait_frames(9, 3000));
+
+  TMCCFrame expected[TMCC2_PARAMETER_FRAME_COUNT];
+  tmcc2_make_parameter_frames(TMCC2_ENGINE_HEADER, 1, TMCC2ParameterIndex::DIALOG, 3, expected);
+  std::vector<WireFrame> frames = host.frames();
+  size_t first = index_of(frames, expected[0].word);
+  ASSERT_TRUE(first + TMCC2_PARAMETER_FRAME_COUNT <= frames.size());
+  for (size_t i = 0; i < TMCC2_PARAMETER_FRAME_COUNT; i++) {
+    EXPECT_EQ(frames[first + i].header, expected[i].header);
+    EXPECT_EQ(frames[first + i].word, expected[i].word);
+  }
+}
+
+TMCC_TEST(stream_repeats_until_stopped) {
+  HostBus host = tmcc_test::make_bus([](TMCCBus *bus) { bus->set_stream_interval(5); });
+  ASSERT_TRUE(host.bus->start_tmcc1_stream(HORN_1, 10000));
+  ASSERT_TRUE(host.wait_frames(5));
+  host.bus->stop_tmcc1_stream(HORN_1);
+  ASSERT_TRUE(tmcc_test::wait_for([&host]() { return host.bus->is_tx_idle(); }));
+  size_t sent = host.frame_count();
+  esphome::App.loop_for(50);
+  EXPECT_EQ(host.frame_count(), sent);
+  EXPECT_EQ(count_word(host.frames(), HORN_1), sent);
+}
+
+TMCC_TEST(received_words_reach_frame_callbacks) {
+  HostBus host = tmcc_test::make_bus();
+  std::vector<WireFrame> received;
+  host.bus->add_on_frame_callback(
+      [&received](uint8_t header, uint16_t word) { received.push_back(WireFrame{header, word}); });
+  // A noise byte, then frames split the way a UART FIFO might deliver them
+  const uint8_t first[] = {0x12, TMCC1_HEADER, 0x00};
+  const uint8_t second[] = {0x9C, TMCC2_ENGINE_HEADER, 0xFE, 0xFE, TMCC1_HEADER, 0xFF, 0xFF};
+  host.uart->inject_rx(first, sizeof(first));
+  esphome::App.loop_for(10);
+  host.uart->inject_rx(second, sizeof(second));
+  ASSERT_TRUE(tmcc_test::wait_for([&received]() { return received.size() >= 3; }));
+  EXPECT_TRUE(received[0] == (WireFrame{TMCC1_HEADER, 0x009C}));
+  EXPECT_TRUE(received[1] == (WireFrame{TMCC2_ENGINE_HEADER, 0xFEFE}));
+  EXPECT_TRUE(received[2] == (WireFrame{TMCC1_HEADER, TMCC1_SYSTEM_HALT_WORD}));
+  EXPECT_EQ(host.bus->get_frames_received(), 3u);
+}
+
+TMCC_TEST(full_queue_drops_under_drop_newest) {
+  HostBus host = tmcc_test::make_bus([](TMCCBus *bus) {
+    bus->set_queue_size(2);
+    bus->set_drop_policy(TMCCDropPolicy::DROP_NEWEST);
+  });
+  host.uart->set_realtime(true);
+  size_t accepted = 0;
+  for (uint8_t address = 1; address <= 8; address++) {
+    accepted += host.bus->send_tmcc1_frame_repeated(tmcc_engine_action_word(address, TMCCEngineAction::RING_BELL), 5)
+                    ? 1
+                    : 0;
+  }
+  EXPECT_TRUE(accepted < 8);
+  EXPECT_EQ(host.bus->get_frames_dropped(), 8 - accepted);
+  ASSERT_TRUE(tmcc_test::wait_for([&host]() { return host.bus->is_tx_idle(); }, 3000));
+  EXPECT_EQ(host.frame_count(), accepted * 5);
+}
+
+TMCC_TEST(batch_is_all_or_nothing) {
+  HostBus host = tmcc_test::make_bus([](TMCCBus *bus) { bus->set_queue_size(4); });
+  host.uart->set_realtime(true);
+  TMCCFrame batch[6];
+  for (uint8_t i = 0; i < 6; i++) {
+    batch[i] = TMCCFrame{TMCC1_HEADER, tmcc_engine_action_word(i + 1, TMCCEngineAction::RING_BELL)};
+  }
+  EXPECT_FALSE(host.bus->send_batch(batch, 6));
+  EXPECT_EQ(host.bus->get_frames_dropped(), 6u);
+  EXPECT_TRUE(host.bus->send_batch(batch, 3));
+  ASSERT_TRUE(host.wait_frames(3));
+  std::vector<WireFrame> frames = host.frames();
+  for (size_t i = 0; i < 3; i++) {
+    EXPECT_EQ(frames[i].word, batch[i].word);
+  }
+}
+
+TMCC_TEST(batch_goes_out_back_to_back) {
+  HostBus host = tmcc_test::make_bus();
+  host.uart->set_realtime(true);
+  ASSERT_TRUE(host.bus->send_tmcc1_frame_repeated(BELL_2, 6));
+  ASSERT_TRUE(host.wait_frames(1));
+  TMCCFrame batch[4];
+  for (uint8_t i = 0; i < 4; i++) {
+    batch[i] = TMCCFrame{TMCC1_HEADER, tmcc_engine_action_word(i + 3, TMCCEngineAction::RING_BELL)};
+  }
+  ASSERT_TRUE(host.bus->send_batch(batch, 4));
+  ASSERT_TRUE(host.wait_frames(10, 3000));
+
+  // The bells for engine 2 may only come before or after the whole batch
+  std::vector<WireFrame> frames = host.frames();
+  size_t first = index_of(frames, batch[0].word);
+  ASSERT_TRUE(first + 4 <= frames.size());
+  for (size_t i = 0; i < 4; i++) {
+    EXPECT_EQ(frames[first + i].word, batch[i].word);
+  }
+}
+
+TMCC_TEST(halt_drops_a_waiting_batch_that_moves_trains) {
+  HostBus host = tmcc_test::make_bus([](TMCCBus *bus) { bus->set_halt_repetitions(1); });
+  host.uart->set_realtime(true);
+  ASSERT_TRUE(host.bus->send_tmcc1_frame_repeated(BELL_2, 4));
+  ASSERT_TRUE(host.wait_frames(1));
+  TMCCFrame moves[2] = {{TMCC1_HEADER, BELL_1}, {TMCC1_HEADER, tmcc_engine_speed_word(1, 10)}};
+  TMCCFrame sounds[2] = {{TMCC1_HEADER, BELL_1}, {TMCC1_HEADER, HORN_1}};
+  ASSERT_TRUE(host.bus->send_batch(moves, 2));
+  ASSERT_TRUE(host.bus->send_batch(sounds, 2));
+  host.bus->system_halt();
+  ASSERT_TRUE(tmcc_test::wait_for([&host]() { return host.bus->is_tx_idle(); }, 3000));
+
+  std::vector<WireFrame> frames = host.frames();
+  EXPECT_EQ(count_word(frames, tmcc_engine_speed_word(1, 10)), 0u);
+  EXPECT_EQ(count_word(frames, BELL_1), 1u);
+  EXPECT_EQ(count_word(frames, HORN_1), 1u);
+  EXPECT_TRUE(index_of(frames, TMCC1_SYSTEM_HALT_WORD) < index_of(frames, HORN_1));
+}
+
+TMCC_TEST(halt_interrupts_a_batch_on_the_wire) {
+  HostBus host = tmcc_test::make_bus([](TMCCBus *bus) { bus->set_halt_repetitions(1); });
+  host.uart->set_realtime(true);
+  TMCCFrame batch[8];
+  for (uint8_t i = 0; i < 8; i++) {
+    batch[i] = TMCCFrame{TMCC1_HEADER, tmcc_engine_speed_word(i + 1, 10)};
+  }
+  ASSERT_TRUE(host.bus->send_batch(batch, 8));
+  ASSERT_TRUE(host.wait_frames(1));
+  host.bus->system_halt();
+  ASSERT_TRUE(tmcc_test::wait_for([&host]() { return host.bus->is_tx_idle(); }, 3000));
+
+  // The halt follows the frame on the wire, and the rest of the batch is dropped
+  std::vector<WireFrame> frames = host.frames();
+  size_t halt = index_of(frames, TMCC1_SYSTEM_HALT_WORD);
+  ASSERT_TRUE(halt < frames.size());
+  EXPECT_TRUE(halt <= 2);
+  EXPECT_EQ(frames.size(), halt + 1);
+}
+
+TMCC_TEST(halt_is_accepted_when_brakes_fill_the_queue) {
+  HostBus host = tmcc_test::make_bus([](TMCCBus *bus) {
+    bus->set_queue_size(4);
+    bus->set_halt_repetitions(1);
+  });
+  host.uart->set_realtime(true);
+  // Repeated brakes stay queued until their last repetition is sent
+  for (uint8_t address = 1; address <= 4; address++) {
+    ASSERT_TRUE(host.bus->send_tmcc1_frame_repeated(tmcc_engine_action_word(address, TMCCEngineAction::BRAKE), 30));
+  }
+  host.bus->system_halt();
+  ASSERT_TRUE(tmcc_test::wait_for([&host]() { return count_word(host.frames(), TMCC1_SYSTEM_HALT_WORD) == 1; }));
+  EXPECT_EQ(host.bus->get_frames_dropped(), 1u);
+}
@@ -0,0 +1,46 @@
+// Recognising the command base echo of our own frames (tmcc_echo)
+
+#include "tmcc_echo.h"
+#include "tmcc_protocol.h"
+#include "tmcc_test.h"
+
+using namespace tmcc;
+
+static const uint16_t SPEED_5 = tmcc_engine_speed_word(1, 5);
+static const uint16_t SPEED_10 = tmcc_engine_speed_word(1, 10);
+
+TMCC_TEST(each_send_matches_one_echo) {
+  TMCCEchoFilter filter;
+  filter.on_sent(TMCC1_HEADER, SPEED_5, 0);
+  filter.on_sent(TMCC1_HEADER, SPEED_5, 10);
+  EXPECT_TRUE(filter.is_echo(TMCC1_HEADER, SPEED_5, 20));
+  EXPECT_TRUE(filter.is_echo(TMCC1_HEADER, SPEED_5, 20));
+  // A third copy came from someone else
+  EXPECT_FALSE(filter.is_echo(TMCC1_HEADER, SPEED_5, 20));
+  EXPECT_EQ(filter.get_echoes(), 2u);
+}
+
+TMCC_TEST(header_and_word_must_both_match) {
+  TMCCEchoFilter filter;
+  filter.on_sent(TMCC1_HEADER, SPEED_5, 0);
+  EXPECT_FALSE(filter.is_echo(TMCC2_ENGINE_HEADER, SPEED_5, 1));
+  EXPECT_FALSE(filter.is_echo(TMCC1_HEADER, SPEED_10, 1));
+  EXPECT_TRUE(filter.is_echo(TMCC1_HEADER, SPEED_5, 1));
+}
+
+TMCC_TEST(late_frames_are_not_echoes) {
+  TMCCEchoFilter filter;
+  filter.on_sent(TMCC1_HEADER, SPEED_5, 0);
+  EXPECT_FALSE(filter.is_echo(TMCC1_HEADER, SPEED_5, TMCC_ECHO_TIMEOUT_MS + 1));
+  EXPECT_EQ(filter.get_echoes(), 0u);
+}
+
+TMCC_TEST(full_ring_forgets_the_oldest) {
+  TMCCEchoFilter filter;
+  filter.on_sent(TMCC1_HEADER, SPEED_10, 0);
+  for (size_t i = 0; i < TMCC_ECHO_RING_SIZE; i++) {
+    filter.on_sent(TMCC1_HEADER, SPEED_5, 0);
+  }
+  EXPECT_FALSE(filter.is_echo(TMCC1_HEADER, SPEED_10, 1));
+  EXPECT_TRUE(filter.is_echo(TMCC1_HEADER, SPEED_5, 1));
+}
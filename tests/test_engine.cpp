@@ -0,0 +1,412 @@
+// TMCCEngine, TMCCTrain and TMCCCab on a host bus: every action, speed,
+// direction, shadow state, momentum, switching the cab's engine and
+// sequences driving them
+
+#include <algorithm>
+
+#include "tmcc_cab.h"
+#include "tmcc_engine.h"
+#include "tmcc_horn.h"
+#include "tmcc_sequence.h"
+#include "tmcc_test.h"
+#include "tmcc_train.h"
+
+using namespace tmcc;
+using tmcc_test::HostBus;
+using tmcc_test::WireFrame;
+
+static const TMCCEngineAction ALL_ACTIONS[] = {
+    TMCCEngineAction::FORWARD,      TMCCEngineAction::TOGGLE_DIRECTION, TMCCEngineAction::REVERSE,
+    TMCCEngineAction::BOOST,        TMCCEngineAction::FRONT_COUPLER,    TMCCEngineAction::REAR_COUPLER,
+    TMCCEngineAction::BRAKE,        TMCCEngineAction::AUX1_OFF,         TMCCEngineAction::AUX1_OPTION1,
+    TMCCEngineAction::AUX1_OPTION2, TMCCEngineAction::AUX1_ON,          TMCCEngineAction::AUX2_OFF,
+    TMCCEngineAction::AUX2_OPTION1, TMCCEngineAction::AUX2_OPTION2,     TMCCEngineAction::AUX2_ON,
+    TMCCEngineAction::BLOW_HORN1,   TMCCEngineAction::RING_BELL,        TMCCEngineAction::LET_OFF_SOUND,
+    TMCCEngineAction::BLOW_HORN2,
+};
+
+// Speed entity without codegen: records what the engine publishes
+class TestSpeed : public TMCCEngineSpeed {
+ public:
+  void set(float value) { this->make_call().set_value(value).perform(); }
+};
+
+class TestDirection : public TMCCEngineDirection {};
+
+static void attach(HostBus &host, TMCCEngine *engine, uint8_t address, TMCCProtocol protocol) {
+  engine->set_bus(host.bus);
+  engine->set_protocol(protocol);
+  engine->set_address(address);
+  engine->set_max_speed(protocol == TMCCProtocol::LEGACY ? TMCC2_MAX_SPEED : 31);
+  engine->set_horn_duration(10);
+  engine->setup();
+  esphome::App.register_component(engine);
+}
+
+static bool sent(const HostBus &host, uint8_t header, uint16_t word) {
+  std::vector<WireFrame> frames = host.frames();
+  return std::find(frames.begin(), frames.end(), WireFrame{header, word}) != frames.end();
+}
+
+// Wait until `word` was written and the queue is empty again
+static bool wait_sent(const HostBus &host, uint8_t header, uint16_t word) {
+  return tmcc_test::wait_for([&]() { return sent(host, header, word) && host.bus->is_tx_idle(); });
+}
+
+static bool wait_idle(const HostBus &host) {
+  bool idle = tmcc_test::wait_for([&host]() { return host.bus->is_tx_idle(); });
+  // The last frame taken from the queue may still be on its way out
+  esphome::App.loop_for(5);
+  return idle;
+}
+
+static uint16_t expected_word(TMCCObjectType type, TMCCProtocol protocol, uint8_t address, TMCCEngineAction action) {
+  if (protocol == TMCCProtocol::LEGACY) {
+    return tmcc2_engine_action_word(address, action);
+  }
+  return type == TMCCObjectType::TRAIN ? tmcc_train_action_word(address, action)
+                                       : tmcc_engine_action_word(address, action);
+}
+
+static uint8_t expected_header(TMCCObjectType type, TMCCProtocol protocol) {
+  if (protocol == TMCCProtocol::LEGACY) {
+    return type == TMCCObjectType::TRAIN ? TMCC2_TRAIN_HEADER : TMCC2_ENGINE_HEADER;
+  }
+  return TMCC1_HEADER;
+}
+
+// Run every action on `engine` one at a time and check its frame. Duplicate
+// suppression is off: REVERSE right after FORWARD, TOGGLE is a duplicate.
+static void check_every_action(HostBus &host, TMCCEngine *engine, TMCCObjectType type) {
+  host.bus->set_suppress_duplicates(false);
+  uint8_t header = expected_header(type, engine->get_protocol());
+  for (TMCCEngineAction action : ALL_ACTIONS) {
+    uint16_t word = expected_word(type, engine->get_protocol(), engine->get_address(), action);
+    host.uart->clear_tx();
+    engine->run_action(action);
+    if (!wait_sent(host, header, word)) {
+      std::printf("  action %u not sent\n", static_cast<unsigned>(action));
+      tmcc_test::fail(__FILE__, __LINE__, "wait_sent(host, header, word)");
+    }
+    EXPECT_EQ(engine->get_frames().action_words[static_cast<uint8_t>(action)], word);
+  }
+}
+
+TMCC_TEST(every_action_tmcc1_engine) {
+  HostBus host = tmcc_test::make_bus();
+  TMCCEngine *engine = new TMCCEngine();
+  attach(host, engine, 12, TMCCProtocol::TMCC1);
+  check_every_action(host, engine, TMCCObjectType::ENGINE);
+}
+
+TMCC_TEST(every_action_legacy_engine) {
+  HostBus host = tmcc_test::make_bus();
+  TMCCEngine *engine = new TMCCEngine();
+  attach(host, engine, 99, TMCCProtocol::LEGACY);
+  check_every_action(host, engine, TMCCObjectType::ENGINE);
+}
+
+TMCC_TEST(every_action_tmcc1_train) {
+  HostBus host = tmcc_test::make_bus();
+  TMCCTrain *train = new TMCCTrain();
+  attach(host, train, 7, TMCCProtocol::TMCC1);
+  check_every_action(host, train, TMCCObjectType::TRAIN);
+}
+
+TMCC_TEST(every_action_legacy_train) {
+  HostBus host = tmcc_test::make_bus();
+  TMCCTrain *train = new TMCCTrain();
+  attach(host, train, 3, TMCCProtocol::LEGACY);
+  check_every_action(host, train, TMCCObjectType::TRAIN);
+}
+
+TMCC_TEST(speed_is_clamped_and_published) {
+  HostBus host = tmcc_test::make_bus();
+  TMCCEngine *engine = new TMCCEngine();
+  TestSpeed *speed = new TestSpeed();
+  speed->set_engine(engine);
+  engine->set_speed_number(speed);
+  attach(host, engine, 4, TMCCProtocol::TMCC1);
+  engine->set_max_speed(18);
+
+  speed->set(25);
+  EXPECT_EQ(engine->get_target_speed(), 18);
+  EXPECT_EQ(speed->state, 18.0f);
+  EXPECT_TRUE(wait_sent(host, TMCC1_HEADER, tmcc_engine_speed_word(4, 18)));
+
+  // Legacy speeds use their own 200-step word
+  TMCCEngine *legacy = new TMCCEngine();
+  attach(host, legacy, 40, TMCCProtocol::LEGACY);
+  legacy->set_speed(150);
+  EXPECT_TRUE(wait_sent(host, TMCC2_ENGINE_HEADER, tmcc2_engine_speed_word(40, 150)));
+}
+
+TMCC_TEST(duplicates_are_suppressed_once_known) {
+  HostBus host = tmcc_test::make_bus();
+  TMCCEngine *engine = new TMCCEngine();
+  attach(host, engine, 2, TMCCProtocol::TMCC1);
+
+  engine->set_speed(6);
+  engine->set_direction_reverse();
+  ASSERT_TRUE(wait_sent(host, TMCC1_HEADER, tmcc_engine_action_word(2, TMCCEngineAction::REVERSE)));
+  ASSERT_TRUE(wait_idle(host));
+  size_t before = host.frame_count();
+  engine->set_speed(6);
+  engine->set_direction_reverse();
+  EXPECT_TRUE(wait_idle(host));
+  EXPECT_EQ(host.frame_count(), before);
+
+  // Brake changes the speed on board, so the next speed goes out again
+  engine->brake();
+  engine->set_speed(6);
+  EXPECT_TRUE(wait_idle(host));
+  EXPECT_EQ(host.frame_count(), before + 2);
+
+  // With suppression off every request is sent
+  host.bus->set_suppress_duplicates(false);
+  engine->set_direction_reverse();
+  EXPECT_TRUE(wait_idle(host));
+  EXPECT_EQ(host.frame_count(), before + 3);
+}
+
+TMCC_TEST(received_frames_update_shadow_state) {
+  HostBus host = tmcc_test::make_bus();
+  TMCCEngine *engine = new TMCCEngine();
+  TestSpeed *speed = new TestSpeed();
+  TestDirection *direction = new TestDirection();
+  engine->set_speed_number(speed);
+  engine->set_direction_switch(direction);
+  attach(host, engine, 9, TMCCProtocol::TMCC1);
+
+  uint16_t words[] = {tmcc_engine_speed_word(9, 14), tmcc_engine_action_word(9, TMCCEngineAction::REVERSE),
+                      tmcc_engine_speed_word(8, 3)};
+  for (uint16_t word : words) {
+    uint8_t frame[TMCC_FRAME_SIZE] = {TMCC1_HEADER, static_cast<uint8_t>(word >> 8), static_cast<uint8_t>(word)};
+    host.uart->inject_rx(frame, sizeof(frame));
+  }
+  ASSERT_TRUE(tmcc_test::wait_for([&host]() { return host.bus->get_frames_received() >= 3; }));
+  EXPECT_EQ(engine->get_current_speed(), 14);
+  EXPECT_EQ(speed->state, 14.0f);
+  EXPECT_FALSE(engine->is_forward());
+  EXPECT_FALSE(direction->state);
+
+  // The same speed from us is now a duplicate
+  engine->set_speed(14);
+  EXPECT_TRUE(wait_idle(host));
+  EXPECT_EQ(host.frame_count(), 0u);
+
+  // A halt from another controller stops everything
+  uint8_t halt[TMCC_FRAME_SIZE] = {TMCC1_HEADER, 0xFF, 0xFF};
+  host.uart->inject_rx(halt, sizeof(halt));
+  ASSERT_TRUE(tmcc_test::wait_for([engine]() { return engine->get_current_speed() == 0; }));
+  EXPECT_EQ(speed->state, 0.0f);
+}
+
+TMCC_TEST(frames_queued_by_others_update_shadow_state) {
+  HostBus host = tmcc_test::make_bus();
+  TMCCEngine *engine = new TMCCEngine();
+  TestSpeed *speed = new TestSpeed();
+  TestDirection *direction = new TestDirection();
+  engine->set_speed_number(speed);
+  engine->set_direction_switch(direction);
+  attach(host, engine, 9, TMCCProtocol::TMCC1);
+
+  // As from a batch service, the bridge or a replay: nothing goes through the engine
+  TMCCFrame batch[] = {{TMCC1_HEADER, tmcc_engine_speed_word(9, 14)},
+                       {TMCC1_HEADER, tmcc_engine_action_word(9, TMCCEngineAction::REVERSE)},
+                       {TMCC1_HEADER, tmcc_engine_speed_word(8, 3)}};
+  ASSERT_TRUE(host.bus->send_batch(batch, 3));
+  EXPECT_EQ(engine->get_current_speed(), 14);
+  EXPECT_EQ(speed->state, 14.0f);
+  EXPECT_FALSE(engine->is_forward());
+  EXPECT_FALSE(direction->state);
+  host.bus->send_frame(TMCC1_HEADER, tmcc_engine_action_word(9, TMCCEngineAction::TOGGLE_DIRECTION));
+  EXPECT_TRUE(engine->is_forward());
+
+  // The engine's own frames are not applied twice
+  engine->run_action(TMCCEngineAction::TOGGLE_DIRECTION);
+  EXPECT_FALSE(engine->is_forward());
+  ASSERT_TRUE(wait_idle(host));
+  host.uart->clear_tx();
+  engine->set_speed(14);
+  EXPECT_TRUE(wait_idle(host));
+  EXPECT_EQ(host.frame_count(), 0u);
+}
+
+TMCC_TEST(ramp_steps_to_the_target) {
+  HostBus host = tmcc_test::make_bus();
+  TMCCEngine *engine = new TMCCEngine();
+  attach(host, engine, 5, TMCCProtocol::TMCC1);
+  engine->set_acceleration(100);  // 5 steps per 50 ms
+  engine->set_speed(0);
+  ASSERT_TRUE(wait_idle(host));
+  host.uart->clear_tx();
+
+  engine->set_speed(20);
+  EXPECT_EQ(engine->get_target_speed(), 20);
+  ASSERT_TRUE(wait_sent(host, TMCC1_HEADER, tmcc_engine_speed_word(5, 20)));
+  std::vector<WireFrame> frames = host.frames();
+  std::vector<uint16_t> expected = {tmcc_engine_speed_word(5, 5), tmcc_engine_speed_word(5, 10),
+                                    tmcc_engine_speed_word(5, 15), tmcc_engine_speed_word(5, 20)};
+  ASSERT_EQ(frames.size(), expected.size());
+  for (size_t i = 0; i < expected.size(); i++) {
+    EXPECT_EQ(frames[i].word, expected[i]);
+  }
+  EXPECT_EQ(engine->get_current_speed(), 20);
+}
+
+TMCC_TEST(ramp_survives_its_own_echo) {
+  // Every frame written to the loopback transport comes straight back, as
+  // from a command base that echoes
+  auto *transport = new TMCCLoopbackTransport();
+  HostBus host;
+  host.bus = new TMCCBus();
+  host.bus->set_transport(transport);
+  host.bus->setup();
+  esphome::App.register_component(host.bus);
+  TMCCEngine *engine = new TMCCEngine();
+  attach(host, engine, 5, TMCCProtocol::TMCC1);
+  engine->set_acceleration(100);  // 5 steps per 50 ms
+  engine->set_speed(0);
+  ASSERT_TRUE(wait_idle(host));
+  engine->set_speed(20);
+
+  // The echo of each step must not be taken for another controller
+  // setting that speed, which would end the ramp there
+  ASSERT_TRUE(tmcc_test::wait_for([&]() { return host.bus->get_frames_echoed() == 5; }));
+  esphome::App.loop_for(100);
+  EXPECT_EQ(engine->get_current_speed(), 20);
+  EXPECT_EQ(engine->get_target_speed(), 20);
+  EXPECT_EQ(host.bus->get_frames_sent(), 5u);
+  EXPECT_EQ(host.bus->get_frames_received(), 5u);
+  EXPECT_EQ(transport->get_bytes_written(), 5 * TMCC_FRAME_SIZE);
+}
+
+TMCC_TEST(halt_stops_a_ramp) {
+  HostBus host = tmcc_test::make_bus([](TMCCBus *bus) { bus->set_halt_repetitions(2); });
+  TMCCEngine *engine = new TMCCEngine();
+  attach(host, engine, 5, TMCCProtocol::TMCC1);
+  engine->set_acceleration(20);  // 1 step per 50 ms
+  engine->set_speed(0);
+  engine->set_speed(30);
+  esphome::App.loop_for(120);
+  engine->stop();
+  EXPECT_EQ(engine->get_current_speed(), 0);
+  EXPECT_EQ(engine->get_target_speed(), 0);
+  ASSERT_TRUE(wait_idle(host));
+  size_t after_halt = host.frame_count();
+  esphome::App.loop_for(150);
+  EXPECT_EQ(host.frame_count(), after_halt);
+}
+
+TMCC_TEST(parameters_are_legacy_only) {
+  HostBus host = tmcc_test::make_bus();
+  TMCCEngine *tmcc1 = new TMCCEngine();
+  attach(host, tmcc1, 1, TMCCProtocol::TMCC1);
+  tmcc1->set_parameter(TMCC2ParameterIndex::DIALOG, 3);
+  EXPECT_TRUE(wait_idle(host));
+  EXPECT_EQ(host.frame_count(), 0u);
+
+  TMCCEngine *legacy = new TMCCEngine();
+  attach(host, legacy, 1, TMCCProtocol::LEGACY);
+  legacy->set_parameter(TMCC2ParameterIndex::DIALOG, 3);
+  EXPECT_TRUE(host.wait_frames(TMCC2_PARAMETER_FRAME_COUNT));
+  TMCCFrame expected[TMCC2_PARAMETER_FRAME_COUNT];
+  tmcc2_make_parameter_frames(TMCC2_ENGINE_HEADER, 1, TMCC2ParameterIndex::DIALOG, 3, expected);
+  std::vector<WireFrame> frames = host.frames();
+  for (size_t i = 0; i < TMCC2_PARAMETER_FRAME_COUNT && i < frames.size(); i++) {
+    EXPECT_EQ(frames[i].header, expected[i].header);
+    EXPECT_EQ(frames[i].word, expected[i].word);
+  }
+}
+
+TMCC_TEST(held_horn_does_not_block_the_engine) {
+  HostBus host = tmcc_test::make_bus();
+  host.uart->set_realtime(true);
+  TMCCEngine *engine = new TMCCEngine();
+  attach(host, engine, 6, TMCCProtocol::TMCC1);
+  uint16_t horn = tmcc_engine_action_word(6, TMCCEngineAction::BLOW_HORN1);
+  uint16_t speed = tmcc_engine_speed_word(6, 10);
+
+  engine->start_horn();
+  ASSERT_TRUE(host.wait_frames(3));
+  engine->set_speed(10);
+  ASSERT_TRUE(tmcc_test::wait_for([&]() { return sent(host, TMCC1_HEADER, speed); }, 100));
+  ASSERT_TRUE(host.wait_frames(host.frame_count() + 3));
+  // The horn kept sounding after the speed went out
+  std::vector<WireFrame> frames = host.frames();
+  EXPECT_EQ(frames.back().word, horn);
+
+  engine->stop_horn();
+  ASSERT_TRUE(wait_idle(host));
+  size_t stopped = host.frame_count();
+  esphome::App.loop_for(30);
+  EXPECT_EQ(host.frame_count(), stopped);
+}
+
+TMCC_TEST(cab_switch_stops_the_horn_signal) {
+  HostBus host = tmcc_test::make_bus();
+  host.uart->set_realtime(true);
+  static const TMCCCabEntry roster[] = {
+      {"A", 1, 31, TMCCProtocol::TMCC1},
+      {"B", 2, 31, TMCCProtocol::TMCC1},
+  };
+  // One blast far longer than the test
+  static const uint8_t segments[] = {250};
+  static const TMCCHornPattern pattern(segments, 1, TMCCEngineAction::BLOW_HORN1);
+  TMCCCab *cab = new TMCCCab();
+  cab->set_roster(roster, 2);
+  attach(host, cab, 1, TMCCProtocol::TMCC1);
+  uint16_t horn = tmcc_engine_action_word(1, TMCCEngineAction::BLOW_HORN1);
+
+  cab->play_horn_pattern(&pattern);
+  ASSERT_TRUE(tmcc_test::wait_for([&]() { return sent(host, TMCC1_HEADER, horn); }));
+  cab->select_engine(1);
+  ASSERT_TRUE(wait_idle(host));
+  size_t stopped = host.frame_count();
+  esphome::App.loop_for(30);
+  EXPECT_EQ(host.frame_count(), stopped);
+  EXPECT_FALSE(sent(host, TMCC1_HEADER, tmcc_engine_action_word(2, TMCCEngineAction::BLOW_HORN1)));
+}
+
+TMCC_TEST(cab_switch_stops_the_held_horn) {
+  HostBus host = tmcc_test::make_bus();
+  host.uart->set_realtime(true);
+  static const TMCCCabEntry roster[] = {
+      {"A", 1, 31, TMCCProtocol::TMCC1},
+      {"B", 2, 31, TMCCProtocol::TMCC1},
+  };
+  TMCCCab *cab = new TMCCCab();
+  cab->set_roster(roster, 2);
+  attach(host, cab, 1, TMCCProtocol::TMCC1);
+  uint16_t horn = tmcc_engine_action_word(1, TMCCEngineAction::BLOW_HORN1);
+
+  cab->start_horn();
+  ASSERT_TRUE(tmcc_test::wait_for([&]() { return sent(host, TMCC1_HEADER, horn); }));
+  cab->select_engine(1);
+  ASSERT_TRUE(wait_idle(host));
+  size_t stopped = host.frame_count();
+  esphome::App.loop_for(30);
+  EXPECT_EQ(host.frame_count(), stopped);
+}
+
+TMCC_TEST(sequence_follows_the_cab_engine) {
+  HostBus host = tmcc_test::make_bus();
+  static const TMCCCabEntry roster[] = {
+      {"A", 1, 31, TMCCProtocol::TMCC1},
+      {"B", 2, 31, TMCCProtocol::TMCC1},
+  };
+  TMCCCab *cab = new TMCCCab();
+  cab->set_roster(roster, 2);
+  attach(host, cab, 1, TMCCProtocol::TMCC1);
+  auto *sequence = new TMCCSequence();
+  sequence->set_bus(host.bus);
+  sequence->add_action_step(cab, TMCCEngineAction::RING_BELL, 1, 0);
+  sequence->setup();
+
+  // Built while engine A was active, run once B is
+  cab->select_engine(1);
+  sequence->start();
+  EXPECT_TRUE(wait_sent(host, TMCC1_HEADER, tmcc_engine_action_word(2, TMCCEngineAction::RING_BELL)));
+  EXPECT_FALSE(sent(host, TMCC1_HEADER, tmcc_engine_action_word(1, TMCCEngineAction::RING_BELL)));
+}
@@ -0,0 +1,59 @@
+// Adaptive frame gap from the command base echo (tmcc_pacing)
+
+#include "tmcc_pacing.h"
+#include "tmcc_test.h"
+
+using namespace tmcc;
+
+// Send one window of frames at `now_ms`, echoing all but `lost` of them
+static void send_window(TMCCRateController &rate, uint32_t now_ms, uint16_t lost) {
+  for (uint16_t i = 0; i < TMCC_PACING_WINDOW; i++) {
+    rate.on_sent(i, now_ms);
+    if (i >= lost) {
+      rate.on_received(i);
+    }
+  }
+}
+
+TMCC_TEST(fixed_gap_when_not_adaptive) {
+  TMCCRateController rate;
+  rate.configure(5, 50, false);
+  EXPECT_EQ(rate.get_gap_ms(), 5u);
+  send_window(rate, 0, TMCC_PACING_WINDOW);
+  EXPECT_FALSE(rate.update(10000));
+  EXPECT_EQ(rate.get_gap_ms(), 5u);
+}
+
+TMCC_TEST(losses_double_the_gap_up_to_the_maximum) {
+  TMCCRateController rate;
+  rate.configure(2, 10, true);
+  send_window(rate, 0, 4);
+  EXPECT_TRUE(rate.update(1000));
+  EXPECT_EQ(rate.get_gap_ms(), 4u);
+  send_window(rate, 1000, 4);
+  rate.update(2000);
+  send_window(rate, 2000, 4);
+  rate.update(3000);
+  EXPECT_EQ(rate.get_gap_ms(), 10u);
+  EXPECT_EQ(rate.get_lost(), 12u);
+}
+
+TMCC_TEST(clean_windows_shorten_the_gap) {
+  TMCCRateController rate;
+  rate.configure(0, 8, true);
+  send_window(rate, 0, 8);
+  rate.update(1000);
+  EXPECT_EQ(rate.get_gap_ms(), 1u);
+  send_window(rate, 1000, 0);
+  EXPECT_TRUE(rate.update(1000));
+  EXPECT_EQ(rate.get_gap_ms(), 0u);
+}
+
+TMCC_TEST(no_echo_at_all_switches_adaptive_off) {
+  TMCCRateController rate;
+  rate.configure(3, 30, true);
+  send_window(rate, 0, TMCC_PACING_WINDOW);
+  EXPECT_TRUE(rate.update(TMCC_PACING_ECHO_TIMEOUT_MS));
+  EXPECT_FALSE(rate.is_adaptive());
+  EXPECT_EQ(rate.get_gap_ms(), 3u);
+}
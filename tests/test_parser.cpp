@@ -0,0 +1,89 @@
+// Receive framing (tmcc_parser)
+
+#include "tmcc_parser.h"
+#include "tmcc_test.h"
+
+using namespace tmcc;
+
+static std::vector<uint16_t> feed_all(TMCCFrameParser &parser, const std::vector<uint8_t> &bytes,
+                                      std::vector<uint8_t> *headers = nullptr) {
+  std::vector<uint16_t> words;
+  TMCCFrame frame;
+  for (uint8_t byte : bytes) {
+    if (parser.feed(byte, &frame)) {
+      words.push_back(frame.word);
+      if (headers != nullptr) {
+        headers->push_back(frame.header);
+      }
+    }
+  }
+  return words;
+}
+
+TMCC_TEST(frames_in_a_row) {
+  TMCCFrameParser parser;
+  std::vector<uint16_t> expected = {0x009C, 0xFFFF};
+  EXPECT_TRUE(feed_all(parser, {0xFE, 0x00, 0x9C, 0xFE, 0xFF, 0xFF}) == expected);
+  EXPECT_EQ(parser.get_discarded_bytes(), 0u);
+}
+
+TMCC_TEST(frame_split_across_feeds) {
+  TMCCFrameParser parser;
+  EXPECT_TRUE(feed_all(parser, {0xFE, 0x00}).empty());
+  std::vector<uint16_t> expected = {0x0080};
+  EXPECT_TRUE(feed_all(parser, {0x80}) == expected);
+}
+
+TMCC_TEST(noise_is_skipped_until_a_header) {
+  TMCCFrameParser parser;
+  std::vector<uint16_t> expected = {0x00F2};
+  EXPECT_TRUE(feed_all(parser, {0x12, 0x34, 0xFE, 0x00, 0xF2}) == expected);
+  EXPECT_EQ(parser.get_discarded_bytes(), 2u);
+}
+
+TMCC_TEST(header_byte_inside_a_frame_is_data) {
+  TMCCFrameParser parser;
+  // Accessory words can carry 0xFE in either data byte
+  std::vector<uint16_t> expected = {0xFEFE};
+  EXPECT_TRUE(feed_all(parser, {0xFE, 0xFE, 0xFE}) == expected);
+}
+
+TMCC_TEST(legacy_frames_keep_their_header) {
+  TMCCFrameParser parser;
+  TMCCFrame frames[TMCC2_PARAMETER_FRAME_COUNT];
+  tmcc2_make_parameter_frames(TMCC2_ENGINE_HEADER, 1, TMCC2ParameterIndex::DIALOG, 3, frames);
+  std::vector<uint8_t> bytes;
+  for (const TMCCFrame &frame : frames) {
+    bytes.insert(bytes.end(), {frame.header, static_cast<uint8_t>(frame.word >> 8), static_cast<uint8_t>(frame.word)});
+  }
+  std::vector<uint8_t> headers;
+  std::vector<uint16_t> words = feed_all(parser, bytes, &headers);
+  ASSERT_EQ(words.size(), TMCC2_PARAMETER_FRAME_COUNT);
+  for (size_t i = 0; i < TMCC2_PARAMETER_FRAME_COUNT; i++) {
+    EXPECT_EQ(headers[i], frames[i].header);
+    EXPECT_EQ(words[i], frames[i].word);
+  }
+  EXPECT_EQ(parser.get_discarded_bytes(), 0u);
+}
+
+TMCC_TEST(header_byte_inside_a_legacy_frame_is_data) {
+  TMCCFrameParser parser;
+  // Engine 127's address byte is 0xFE; a TMCC1 frame follows
+  uint16_t legacy = tmcc2_engine_speed_word(127, 100);
+  ASSERT_EQ(legacy >> 8, TMCC1_HEADER);
+  std::vector<uint8_t> headers;
+  std::vector<uint16_t> words = feed_all(
+      parser, {TMCC2_ENGINE_HEADER, TMCC1_HEADER, static_cast<uint8_t>(legacy), TMCC1_HEADER, 0x00, 0x9C}, &headers);
+  std::vector<uint16_t> expected = {legacy, 0x009C};
+  EXPECT_TRUE(words == expected);
+  std::vector<uint8_t> expected_headers = {TMCC2_ENGINE_HEADER, TMCC1_HEADER};
+  EXPECT_TRUE(headers == expected_headers);
+}
+
+TMCC_TEST(reset_drops_a_partial_frame) {
+  TMCCFrameParser parser;
+  feed_all(parser, {0xFE, 0x00});
+  parser.reset();
+  std::vector<uint16_t> expected = {0x009C};
+  EXPECT_TRUE(feed_all(parser, {0xFE, 0x00, 0x9C}) == expected);
+}
@@ -0,0 +1,149 @@
+// Word encoders, decoder and frame classifiers (tmcc_protocol)
+
+#include "tmcc_protocol.h"
+#include "tmcc_test.h"
+
+using namespace tmcc;
+
+static const TMCCEngineAction ALL_ACTIONS[] = {
+    TMCCEngineAction::FORWARD,      TMCCEngineAction::TOGGLE_DIRECTION, TMCCEngineAction::REVERSE,
+    TMCCEngineAction::BOOST,        TMCCEngineAction::FRONT_COUPLER,    TMCCEngineAction::REAR_COUPLER,
+    TMCCEngineAction::BRAKE,        TMCCEngineAction::AUX1_OFF,         TMCCEngineAction::AUX1_OPTION1,
+    TMCCEngineAction::AUX1_OPTION2, TMCCEngineAction::AUX1_ON,          TMCCEngineAction::AUX2_OFF,
+    TMCCEngineAction::AUX2_OPTION1, TMCCEngineAction::AUX2_OPTION2,     TMCCEngineAction::AUX2_ON,
+    TMCCEngineAction::BLOW_HORN1,   TMCCEngineAction::RING_BELL,        TMCCEngineAction::LET_OFF_SOUND,
+    TMCCEngineAction::BLOW_HORN2,
+};
+
+static const TMCCObjectType ALL_TYPES[] = {
+    TMCCObjectType::ENGINE, TMCCObjectType::SWITCH, TMCCObjectType::ACCESSORY,
+    TMCCObjectType::TRAIN,  TMCCObjectType::ROUTE,
+};
+
+TMCC_TEST(every_object_type_round_trips) {
+  for (TMCCObjectType type : ALL_TYPES) {
+    for (uint8_t address : {uint8_t(0), uint8_t(1), uint8_t(9), tmcc_max_address(type)}) {
+      for (uint8_t cmd_class = 0; cmd_class < 4; cmd_class++) {
+        uint16_t word = tmcc_make_word(type, address, static_cast<TMCCCommandClass>(cmd_class), 0x15);
+        TMCCDecodedWord decoded;
+        ASSERT_TRUE(tmcc_decode_word(word, &decoded));
+        EXPECT_TRUE(decoded.type == type);
+        EXPECT_EQ(decoded.address, address);
+        EXPECT_EQ(static_cast<uint8_t>(decoded.cmd_class), cmd_class);
+        EXPECT_EQ(decoded.data, 0x15);
+      }
+    }
+  }
+}
+
+TMCC_TEST(max_address_per_type) {
+  EXPECT_EQ(tmcc_max_address(TMCCObjectType::ENGINE), 127);
+  EXPECT_EQ(tmcc_max_address(TMCCObjectType::SWITCH), 127);
+  EXPECT_EQ(tmcc_max_address(TMCCObjectType::ACCESSORY), 127);
+  EXPECT_EQ(tmcc_max_address(TMCCObjectType::TRAIN), 15);
+  EXPECT_EQ(tmcc_max_address(TMCCObjectType::ROUTE), 31);
+}
+
+TMCC_TEST(system_halt_is_not_an_object_word) {
+  TMCCDecodedWord decoded;
+  EXPECT_FALSE(tmcc_decode_word(TMCC1_SYSTEM_HALT_WORD, &decoded));
+  EXPECT_FALSE(tmcc_frame_is_motion(TMCC1_HEADER, TMCC1_SYSTEM_HALT_WORD));
+}
+
+TMCC_TEST(every_engine_action_encodes_for_each_protocol) {
+  for (TMCCEngineAction action : ALL_ACTIONS) {
+    uint8_t code = static_cast<uint8_t>(action);
+    TMCCDecodedWord decoded;
+
+    ASSERT_TRUE(tmcc_decode_word(tmcc_engine_action_word(42, action), &decoded));
+    EXPECT_TRUE(decoded.type == TMCCObjectType::ENGINE);
+    EXPECT_EQ(decoded.address, 42);
+    EXPECT_TRUE(decoded.cmd_class == TMCCCommandClass::ACTION);
+    EXPECT_EQ(decoded.data, code);
+
+    ASSERT_TRUE(tmcc_decode_word(tmcc_train_action_word(7, action), &decoded));
+    EXPECT_TRUE(decoded.type == TMCCObjectType::TRAIN);
+    EXPECT_EQ(decoded.address, 7);
+    EXPECT_EQ(decoded.data, code);
+
+    // Legacy: A A A A A A A 1 D D D D D D D D, action code in the low bits
+    uint16_t legacy = tmcc2_engine_action_word(42, action);
+    EXPECT_EQ(legacy >> 9, 42);
+    EXPECT_EQ(legacy & TMCC2_COMMAND_BIT, TMCC2_COMMAND_BIT);
+    EXPECT_EQ(legacy & 0xFF, code);
+  }
+}
+
+TMCC_TEST(frame_table_matches_the_word_helpers) {
+  TMCCEngineFrameTable table;
+  tmcc_build_frame_table(TMCCObjectType::ENGINE, 12, TMCCProtocol::TMCC1, &table);
+  EXPECT_EQ(table.header, TMCC1_HEADER);
+  EXPECT_EQ(table.speed_base, tmcc_engine_speed_word(12, 0));
+  for (TMCCEngineAction action : ALL_ACTIONS) {
+    EXPECT_EQ(table.action_words[static_cast<uint8_t>(action)], tmcc_engine_action_word(12, action));
+  }
+
+  tmcc_build_frame_table(TMCCObjectType::TRAIN, 3, TMCCProtocol::TMCC1, &table);
+  EXPECT_EQ(table.speed_base, tmcc_train_speed_word(3, 0));
+  EXPECT_EQ(table.action_words[static_cast<uint8_t>(TMCCEngineAction::RING_BELL)],
+            tmcc_train_action_word(3, TMCCEngineAction::RING_BELL));
+
+  tmcc_build_frame_table(TMCCObjectType::ENGINE, 12, TMCCProtocol::LEGACY, &table);
+  EXPECT_EQ(table.header, TMCC2_ENGINE_HEADER);
+  EXPECT_EQ(table.speed_base, tmcc2_engine_speed_word(12, 0));
+  tmcc_build_frame_table(TMCCObjectType::TRAIN, 12, TMCCProtocol::LEGACY, &table);
+  EXPECT_EQ(table.header, TMCC2_TRAIN_HEADER);
+}
+
+TMCC_TEST(switch_accessory_and_route_words) {
+  TMCCDecodedWord decoded;
+  ASSERT_TRUE(tmcc_decode_word(tmcc_switch_word(20, TMCCSwitchAction::THROW_OUT), &decoded));
+  EXPECT_TRUE(decoded.type == TMCCObjectType::SWITCH);
+  EXPECT_EQ(decoded.data, static_cast<uint8_t>(TMCCSwitchAction::THROW_OUT));
+
+  ASSERT_TRUE(tmcc_decode_word(tmcc_accessory_word(20, TMCCAccessoryAction::AUX2_ON), &decoded));
+  EXPECT_TRUE(decoded.type == TMCCObjectType::ACCESSORY);
+  EXPECT_EQ(decoded.data, static_cast<uint8_t>(TMCCAccessoryAction::AUX2_ON));
+
+  ASSERT_TRUE(tmcc_decode_word(tmcc_route_word(20, TMCCRouteAction::THROW), &decoded));
+  EXPECT_TRUE(decoded.type == TMCCObjectType::ROUTE);
+  EXPECT_EQ(decoded.address, 20);
+}
+
+TMCC_TEST(frame_classifiers) {
+  EXPECT_TRUE(tmcc_frame_is_absolute_speed(TMCC1_HEADER, tmcc_engine_speed_word(5, 10)));
+  EXPECT_TRUE(tmcc_frame_is_absolute_speed(TMCC2_ENGINE_HEADER, tmcc2_engine_speed_word(5, 150)));
+  EXPECT_FALSE(tmcc_frame_is_absolute_speed(TMCC1_HEADER, tmcc_switch_word(5, TMCCSwitchAction::THROW_OUT)));
+
+  EXPECT_TRUE(tmcc_frame_is_motion(TMCC1_HEADER, tmcc_engine_action_word(5, TMCCEngineAction::REVERSE)));
+  EXPECT_TRUE(tmcc_frame_is_motion(TMCC1_HEADER, tmcc_train_action_word(5, TMCCEngineAction::BOOST)));
+  EXPECT_FALSE(tmcc_frame_is_motion(TMCC1_HEADER, tmcc_engine_action_word(5, TMCCEngineAction::BLOW_HORN1)));
+  EXPECT_TRUE(tmcc_frame_is_motion(TMCC2_ENGINE_HEADER, tmcc2_engine_action_word(5, TMCCEngineAction::FORWARD)));
+
+  EXPECT_TRUE(tmcc_frame_is_brake(TMCC1_HEADER, tmcc_engine_action_word(5, TMCCEngineAction::BRAKE)));
+  EXPECT_TRUE(tmcc_frame_is_brake(TMCC2_TRAIN_HEADER, tmcc2_engine_action_word(5, TMCCEngineAction::BRAKE)));
+  EXPECT_FALSE(tmcc_frame_is_brake(TMCC1_HEADER, tmcc_engine_action_word(5, TMCCEngineAction::BOOST)));
+}
+
+TMCC_TEST(object_and_command_keys) {
+  // Speeds for one engine share a command key; other engines do not
+  EXPECT_EQ(tmcc_frame_command_key(TMCC1_HEADER, tmcc_engine_speed_word(5, 1)),
+            tmcc_frame_command_key(TMCC1_HEADER, tmcc_engine_speed_word(5, 30)));
+  EXPECT_NE(tmcc_frame_object_key(TMCC1_HEADER, tmcc_engine_speed_word(5, 1)),
+            tmcc_frame_object_key(TMCC1_HEADER, tmcc_engine_speed_word(6, 1)));
+  // Legacy continuation frames belong to the engine they continue
+  TMCCFrame frames[TMCC2_PARAMETER_FRAME_COUNT];
+  tmcc2_make_parameter_frames(TMCC2_ENGINE_HEADER, 9, TMCC2ParameterIndex::DIALOG, 0x05, frames);
+  EXPECT_EQ(tmcc_frame_object_key(frames[0].header, frames[0].word),
+            tmcc_frame_object_key(frames[2].header, frames[2].word));
+}
+
+TMCC_TEST(parameter_frames_checksum) {
+  TMCCFrame frames[TMCC2_PARAMETER_FRAME_COUNT];
+  tmcc2_make_parameter_frames(TMCC2_ENGINE_HEADER, 9, TMCC2ParameterIndex::LIGHTING, 0x22, frames);
+  EXPECT_EQ(frames[0].header, TMCC2_ENGINE_HEADER);
+  EXPECT_EQ(frames[1].header, TMCC2_MULTIWORD_HEADER);
+  EXPECT_EQ(frames[2].header, TMCC2_MULTIWORD_HEADER);
+  uint8_t sum = (frames[0].word >> 8) + (frames[0].word & 0xFF) + (frames[1].word >> 8) + (frames[1].word & 0xFF);
+  EXPECT_EQ(static_cast<uint8_t>(~sum), frames[2].word & 0xFF);
+}
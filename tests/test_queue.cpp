@@ -0,0 +1,353 @@
+// TX queue ordering: priority, round-robin, coalescing, chains and streams
+
+#include "tmcc_queue.h"
+#include "tmcc_test.h"
+
+using namespace tmcc;
+
+static TMCCTxEntry make_entry(uint16_t word, uint8_t repetitions = 1,
+                              TMCCPriority priority = TMCCPriority::NORMAL) {
+  TMCCTxEntry entry{};
+  entry.header = TMCC1_HEADER;
+  entry.word = word;
+  entry.repetitions = repetitions;
+  entry.priority = priority;
+  return entry;
+}
+
+static TMCCTxEntry make_stream(uint16_t word, uint32_t now_ms, uint32_t duration_ms, uint16_t interval_ms) {
+  TMCCTxEntry entry = make_entry(word);
+  entry.flags = TMCC_TX_FLAG_STREAM;
+  entry.interval_ms = interval_ms;
+  entry.due_ms = now_ms;
+  entry.until_ms = now_ms + duration_ms;
+  return entry;
+}
+
+// Take frames until the queue has nothing to send at `now_ms`
+static std::vector<uint16_t> drain(TMCCTxQueue &queue, uint32_t now_ms = 0, size_t limit = 100) {
+  std::vector<uint16_t> words;
+  TMCCTxEntry frame;
+  uint32_t wait_ms;
+  while (words.size() < limit && queue.take_frame(now_ms, &frame, &wait_ms)) {
+    words.push_back(frame.word);
+  }
+  return words;
+}
+
+static const uint16_t HORN_1 = tmcc_engine_action_word(1, TMCCEngineAction::BLOW_HORN1);
+static const uint16_t BELL_1 = tmcc_engine_action_word(1, TMCCEngineAction::RING_BELL);
+static const uint16_t BELL_2 = tmcc_engine_action_word(2, TMCCEngineAction::RING_BELL);
+static const uint16_t BRAKE_2 = tmcc_engine_action_word(2, TMCCEngineAction::BRAKE);
+
+TMCC_TEST(fifo_for_one_object) {
+  TMCCTxQueue queue;
+  ASSERT_TRUE(queue.init(8));
+  queue.push(make_entry(tmcc_engine_speed_word(1, 5)));
+  queue.push(make_entry(BELL_1));
+  queue.push(make_entry(HORN_1));
+  std::vector<uint16_t> expected = {tmcc_engine_speed_word(1, 5), BELL_1, HORN_1};
+  EXPECT_TRUE(drain(queue) == expected);
+  EXPECT_TRUE(queue.empty());
+}
+
+TMCC_TEST(full_queue_rejects_push) {
+  TMCCTxQueue queue;
+  ASSERT_TRUE(queue.init(2));
+  EXPECT_TRUE(queue.push(make_entry(BELL_1)));
+  EXPECT_TRUE(queue.push(make_entry(BELL_2)));
+  EXPECT_TRUE(queue.full());
+  EXPECT_FALSE(queue.push(make_entry(HORN_1)));
+  EXPECT_EQ(queue.size(), 2u);
+}
+
+TMCC_TEST(higher_priority_goes_first) {
+  TMCCTxQueue queue;
+  ASSERT_TRUE(queue.init(8));
+  queue.push(make_entry(BELL_1));
+  queue.push(make_entry(BRAKE_2, 1, TMCCPriority::HIGH));
+  queue.push(make_entry(TMCC1_SYSTEM_HALT_WORD, 1, TMCCPriority::HALT));
+  std::vector<uint16_t> expected = {TMCC1_SYSTEM_HALT_WORD, BRAKE_2, BELL_1};
+  EXPECT_TRUE(drain(queue) == expected);
+}
+
+TMCC_TEST(repetitions_interleave_round_robin) {
+  TMCCTxQueue queue;
+  ASSERT_TRUE(queue.init(8));
+  queue.push(make_entry(BELL_1, 3));
+  queue.push(make_entry(BELL_2, 2));
+  std::vector<uint16_t> expected = {BELL_1, BELL_2, BELL_1, BELL_2, BELL_1};
+  EXPECT_TRUE(drain(queue) == expected);
+}
+
+TMCC_TEST(coalesce_replaces_the_newest_speed) {
+  TMCCTxQueue queue;
+  ASSERT_TRUE(queue.init(8));
+  queue.push(make_entry(tmcc_engine_speed_word(1, 5)));
+  EXPECT_TRUE(queue.coalesce(make_entry(tmcc_engine_speed_word(1, 9))));
+  EXPECT_EQ(queue.size(), 1u);
+  // A different command for the engine in between keeps the order
+  queue.push(make_entry(BELL_1));
+  EXPECT_FALSE(queue.coalesce(make_entry(tmcc_engine_speed_word(1, 12))));
+  std::vector<uint16_t> expected = {tmcc_engine_speed_word(1, 9), BELL_1};
+  EXPECT_TRUE(drain(queue) == expected);
+}
+
+TMCC_TEST(chain_goes_out_back_to_back) {
+  TMCCTxQueue queue;
+  ASSERT_TRUE(queue.init(8));
+  TMCCFrame frames[TMCC2_PARAMETER_FRAME_COUNT];
+  tmcc2_make_parameter_frames(TMCC2_ENGINE_HEADER, 1, TMCC2ParameterIndex::DIALOG, 3, frames);
+  TMCCTxEntry entries[TMCC2_PARAMETER_FRAME_COUNT];
+  for (size_t i = 0; i < TMCC2_PARAMETER_FRAME_COUNT; i++) {
+    entries[i] = make_entry(frames[i].word);
+    entries[i].header = frames[i].header;
+  }
+  queue.push(make_entry(BELL_2));
+  ASSERT_TRUE(queue.push_chain(entries, TMCC2_PARAMETER_FRAME_COUNT));
+  queue.push(make_entry(BELL_2));
+
+  TMCCTxEntry frame;
+  uint32_t wait_ms;
+  // The bell may go first, depending on the round-robin order
+  ASSERT_TRUE(queue.take_frame(0, &frame, &wait_ms));
+  if (frame.word == BELL_2) {
+    ASSERT_TRUE(queue.take_frame(0, &frame, &wait_ms));
+  }
+  EXPECT_EQ(frame.word, frames[0].word);
+  // Neither the other bell nor a halt gets between the chained frames
+  queue.push(make_entry(TMCC1_SYSTEM_HALT_WORD, 1, TMCCPriority::HALT));
+  ASSERT_TRUE(queue.take_frame(0, &frame, &wait_ms));
+  EXPECT_EQ(frame.word, frames[1].word);
+  ASSERT_TRUE(queue.take_frame(0, &frame, &wait_ms));
+  EXPECT_EQ(frame.word, frames[2].word);
+  ASSERT_TRUE(queue.take_frame(0, &frame, &wait_ms));
+  EXPECT_EQ(frame.word, TMCC1_SYSTEM_HALT_WORD);
+}
+
+TMCC_TEST(chain_across_objects_is_not_interleaved) {
+  TMCCTxQueue queue;
+  ASSERT_TRUE(queue.init(8));
+  const uint16_t bell_3 = tmcc_engine_action_word(3, TMCCEngineAction::RING_BELL);
+  queue.push(make_entry(BELL_2, 3));
+  TMCCTxEntry chain[3] = {make_entry(BELL_1), make_entry(bell_3), make_entry(BELL_1)};
+  ASSERT_TRUE(queue.push_chain(chain, 3));
+  // Round-robin alone would alternate engines 1, 2 and 3
+  std::vector<uint16_t> words = drain(queue);
+  ASSERT_EQ(words.size(), 6u);
+  size_t first = 0;
+  while (first < words.size() && words[first] != BELL_1) {
+    first++;
+  }
+  ASSERT_TRUE(first + 3 <= words.size());
+  EXPECT_EQ(words[first + 1], bell_3);
+  EXPECT_EQ(words[first + 2], BELL_1);
+}
+
+TMCC_TEST(repeated_chain_frame_finishes_before_the_next) {
+  TMCCTxQueue queue;
+  ASSERT_TRUE(queue.init(8));
+  TMCCTxEntry chain[2] = {make_entry(BELL_1, 2), make_entry(BELL_2)};
+  ASSERT_TRUE(queue.push_chain(chain, 2));
+  queue.push(make_entry(HORN_1));
+  std::vector<uint16_t> expected = {BELL_1, BELL_1, BELL_2, HORN_1};
+  EXPECT_TRUE(drain(queue) == expected);
+}
+
+TMCC_TEST(descending_chain_keeps_its_order) {
+  TMCCTxQueue queue;
+  ASSERT_TRUE(queue.init(8));
+  const uint16_t bell_3 = tmcc_engine_action_word(3, TMCCEngineAction::RING_BELL);
+  const uint16_t bell_4 = tmcc_engine_action_word(4, TMCCEngineAction::RING_BELL);
+  const uint16_t bell_5 = tmcc_engine_action_word(5, TMCCEngineAction::RING_BELL);
+  queue.push(make_entry(bell_3));
+  queue.push(make_entry(bell_4));
+  TMCCTxEntry chain[2] = {make_entry(bell_5), make_entry(BELL_2)};
+  ASSERT_TRUE(queue.push_chain(chain, 2));
+  // The chain's turn comes with its first frame's engine, not the second's
+  std::vector<uint16_t> expected = {bell_3, bell_4, bell_5, BELL_2};
+  EXPECT_TRUE(drain(queue) == expected);
+}
+
+TMCC_TEST(preemptible_chain_lets_a_halt_in) {
+  TMCCTxQueue queue;
+  ASSERT_TRUE(queue.init(8));
+  TMCCTxEntry chain[3] = {make_entry(BELL_1), make_entry(BELL_2), make_entry(HORN_1)};
+  for (TMCCTxEntry &entry : chain) {
+    entry.flags = TMCC_TX_FLAG_PREEMPTIBLE;
+  }
+  ASSERT_TRUE(queue.push_chain(chain, 3));
+  queue.push(make_entry(tmcc_engine_speed_word(3, 5)));
+  TMCCTxEntry frame;
+  uint32_t wait_ms;
+  ASSERT_TRUE(queue.take_frame(0, &frame, &wait_ms));
+  EXPECT_EQ(frame.word, BELL_1);
+
+  // The halt goes next; normal traffic still waits for the rest of the chain
+  queue.push(make_entry(TMCC1_SYSTEM_HALT_WORD, 1, TMCCPriority::HALT));
+  std::vector<uint16_t> expected = {TMCC1_SYSTEM_HALT_WORD, BELL_2, HORN_1, tmcc_engine_speed_word(3, 5)};
+  EXPECT_TRUE(drain(queue) == expected);
+}
+
+TMCC_TEST(matching_chains_are_removed_whole) {
+  TMCCTxQueue queue;
+  ASSERT_TRUE(queue.init(8));
+  const uint16_t speed_1 = tmcc_engine_speed_word(1, 5);
+  TMCCTxEntry started[2] = {make_entry(BELL_1), make_entry(speed_1)};
+  TMCCTxEntry waiting[2] = {make_entry(BELL_2), make_entry(speed_1)};
+  TMCCTxEntry harmless[2] = {make_entry(BELL_1), make_entry(BELL_2)};
+  queue.push_chain(started, 2);
+  queue.push_chain(waiting, 2);
+  queue.push_chain(harmless, 2);
+  TMCCTxEntry frame;
+  uint32_t wait_ms;
+  ASSERT_TRUE(queue.take_frame(0, &frame, &wait_ms));
+  ASSERT_EQ(frame.word, BELL_1);
+
+  // The started chain is not preemptible, so it is left to finish
+  auto is_speed = [](const TMCCTxEntry &entry, uint32_t) {
+    return tmcc_frame_is_absolute_speed(entry.header, entry.word);
+  };
+  EXPECT_EQ(queue.remove_chains_if(is_speed, 0), 2u);
+  std::vector<uint16_t> expected = {speed_1, BELL_1, BELL_2};
+  EXPECT_TRUE(drain(queue) == expected);
+}
+
+TMCC_TEST(started_preemptible_chain_loses_its_unsent_frames) {
+  TMCCTxQueue queue;
+  ASSERT_TRUE(queue.init(8));
+  const uint16_t speed_1 = tmcc_engine_speed_word(1, 5);
+  TMCCTxEntry chain[3] = {make_entry(BELL_1), make_entry(HORN_1), make_entry(speed_1)};
+  for (TMCCTxEntry &entry : chain) {
+    entry.flags = TMCC_TX_FLAG_PREEMPTIBLE;
+  }
+  queue.push_chain(chain, 3);
+  queue.push(make_entry(BELL_2));
+  TMCCTxEntry frame;
+  uint32_t wait_ms;
+  ASSERT_TRUE(queue.take_frame(0, &frame, &wait_ms));
+  ASSERT_EQ(frame.word, BELL_1);
+
+  auto is_speed = [](const TMCCTxEntry &entry, uint32_t) {
+    return tmcc_frame_is_absolute_speed(entry.header, entry.word);
+  };
+  EXPECT_EQ(queue.remove_chains_if(is_speed, 0), 2u);
+  std::vector<uint16_t> expected = {BELL_2};
+  EXPECT_TRUE(drain(queue) == expected);
+}
+
+TMCC_TEST(chain_is_all_or_nothing) {
+  TMCCTxQueue queue;
+  ASSERT_TRUE(queue.init(2));
+  TMCCTxEntry entries[3] = {make_entry(1), make_entry(2), make_entry(3)};
+  EXPECT_FALSE(queue.push_chain(entries, 3));
+  EXPECT_TRUE(queue.empty());
+}
+
+TMCC_TEST(stream_repeats_per_slot_until_deadline) {
+  TMCCTxQueue queue;
+  ASSERT_TRUE(queue.init(8));
+  queue.push(make_stream(HORN_1, 1000, 100, 30));
+
+  TMCCTxEntry frame;
+  uint32_t wait_ms;
+  ASSERT_TRUE(queue.take_frame(1000, &frame, &wait_ms));
+  EXPECT_EQ(frame.word, HORN_1);
+  // Waiting for the next slot
+  EXPECT_FALSE(queue.take_frame(1010, &frame, &wait_ms));
+  EXPECT_EQ(wait_ms, 20u);
+  EXPECT_TRUE(queue.take_frame(1030, &frame, &wait_ms));
+  // Ended: removed at the next look
+  EXPECT_FALSE(queue.take_frame(1100, &frame, &wait_ms));
+  EXPECT_TRUE(queue.empty());
+}
+
+TMCC_TEST(update_stream_moves_the_deadline) {
+  TMCCTxQueue queue;
+  ASSERT_TRUE(queue.init(8));
+  queue.push(make_stream(HORN_1, 0, 100, 0));
+  EXPECT_TRUE(queue.update_stream(TMCC1_HEADER, HORN_1, 500));
+  TMCCTxEntry frame;
+  uint32_t wait_ms;
+  EXPECT_TRUE(queue.take_frame(300, &frame, &wait_ms));
+  EXPECT_TRUE(queue.update_stream(TMCC1_HEADER, HORN_1, 300));
+  EXPECT_FALSE(queue.take_frame(300, &frame, &wait_ms));
+  EXPECT_FALSE(queue.update_stream(TMCC1_HEADER, HORN_1, 900));
+}
+
+TMCC_TEST(evict_oldest_skips_chains_and_higher_priorities) {
+  TMCCTxQueue queue;
+  ASSERT_TRUE(queue.init(8));
+  TMCCTxEntry chain[2] = {make_entry(1), make_entry(2)};
+  queue.push_chain(chain, 2);
+  queue.push(make_entry(BRAKE_2, 1, TMCCPriority::HIGH));
+  queue.push(make_entry(BELL_1));
+  EXPECT_TRUE(queue.evict_oldest(TMCCPriority::NORMAL));
+  EXPECT_EQ(queue.size(), 3u);
+  EXPECT_FALSE(queue.evict_oldest(TMCCPriority::NORMAL));
+  EXPECT_TRUE(queue.evict_oldest(TMCCPriority::HIGH));
+  EXPECT_EQ(queue.size(), 2u);
+}
+
+static bool is_bell(const TMCCTxEntry &entry, uint32_t /*unused*/) {
+  return (entry.word & 0x1F) == static_cast<uint8_t>(TMCCEngineAction::RING_BELL);
+}
+
+TMCC_TEST(remove_if_keeps_the_rest_in_order) {
+  TMCCTxQueue queue;
+  ASSERT_TRUE(queue.init(8));
+  queue.push(make_entry(BELL_1));
+  queue.push(make_entry(HORN_1));
+  queue.push(make_entry(BELL_2));
+  queue.push(make_entry(tmcc_engine_speed_word(1, 4)));
+  EXPECT_EQ(queue.remove_if(is_bell, 0), 2u);
+  std::vector<uint16_t> expected = {HORN_1, tmcc_engine_speed_word(1, 4)};
+  EXPECT_TRUE(drain(queue) == expected);
+}
+
+TMCC_TEST(halt_evicts_anything_but_a_halt) {
+  TMCCTxQueue queue;
+  ASSERT_TRUE(queue.init(4));
+  TMCCTxEntry chain[3] = {make_entry(1), make_entry(2), make_entry(3)};
+  queue.push_chain(chain, 3);
+  queue.push(make_entry(BRAKE_2, 5, TMCCPriority::HIGH));
+  // Brakes go before chains
+  EXPECT_TRUE(queue.evict_for_halt());
+  EXPECT_EQ(queue.size(), 3u);
+  // A chain goes as a whole, even halfway through
+  TMCCTxEntry frame;
+  uint32_t wait_ms;
+  ASSERT_TRUE(queue.take_frame(0, &frame, &wait_ms));
+  EXPECT_EQ(frame.word, 1);
+  queue.push(make_entry(TMCC1_SYSTEM_HALT_WORD, 1, TMCCPriority::HALT));
+  queue.push(make_entry(TMCC1_SYSTEM_HALT_WORD, 1, TMCCPriority::HALT));
+  EXPECT_TRUE(queue.evict_for_halt());
+  EXPECT_EQ(queue.size(), 2u);
+  // The writer does not wait for the rest of the evicted chain
+  ASSERT_TRUE(queue.take_frame(0, &frame, &wait_ms));
+  EXPECT_EQ(frame.word, TMCC1_SYSTEM_HALT_WORD);
+  EXPECT_FALSE(queue.evict_for_halt());
+}
+
+TMCC_TEST(sounding_stream_lets_later_commands_through) {
+  TMCCTxQueue queue;
+  ASSERT_TRUE(queue.init(8));
+  queue.push(make_stream(HORN_1, 0, 1000, 0));
+  TMCCTxEntry frame;
+  uint32_t wait_ms;
+  ASSERT_TRUE(queue.take_frame(0, &frame, &wait_ms));
+  EXPECT_EQ(frame.word, HORN_1);
+  queue.push(make_entry(BELL_1));
+  queue.push(make_entry(tmcc_engine_speed_word(1, 8)));
+  std::vector<uint16_t> expected = {BELL_1, tmcc_engine_speed_word(1, 8), HORN_1, HORN_1};
+  EXPECT_TRUE(drain(queue, 10, 4) == expected);
+}
+
+TMCC_TEST(unstarted_stream_keeps_its_place) {
+  TMCCTxQueue queue;
+  ASSERT_TRUE(queue.init(8));
+  queue.push(make_stream(HORN_1, 0, 1000, 0));
+  queue.push(make_entry(BELL_1));
+  std::vector<uint16_t> expected = {HORN_1, BELL_1, HORN_1};
+  EXPECT_TRUE(drain(queue, 0, 3) == expected);
+}
@@ -0,0 +1,67 @@
+// Session recording format and ring (tmcc_recording)
+
+#include "tmcc_recording.h"
+#include "tmcc_test.h"
+
+using namespace tmcc;
+
+TMCC_TEST(record_round_trips) {
+  const uint8_t headers[] = {TMCC1_HEADER, TMCC2_ENGINE_HEADER, TMCC2_TRAIN_HEADER, TMCC2_MULTIWORD_HEADER};
+  for (uint8_t header : headers) {
+    for (uint32_t delta : {0u, 127u, 128u, 3125u, 0xFFFFFFFFu}) {
+      TMCCRecordedFrame frame{delta, 0xA55A, header, 7, header == TMCC2_ENGINE_HEADER};
+      uint8_t buffer[TMCC_RECORD_MAX_SIZE];
+      size_t len = tmcc_record_encode(frame, buffer);
+      ASSERT_TRUE(len > 0 && len <= TMCC_RECORD_MAX_SIZE);
+      TMCCRecordedFrame decoded;
+      ASSERT_EQ(tmcc_record_decode(buffer, len, &decoded), len);
+      EXPECT_EQ(decoded.delta_us, delta);
+      EXPECT_EQ(decoded.word, 0xA55A);
+      EXPECT_EQ(decoded.header, header);
+      EXPECT_EQ(decoded.repetitions, 7);
+      EXPECT_EQ(decoded.chain_next, frame.chain_next);
+      // A record cut short is not decoded
+      EXPECT_EQ(tmcc_record_decode(buffer, len - 1, &decoded), 0u);
+    }
+  }
+}
+
+TMCC_TEST(varint_sizes) {
+  uint8_t buffer[TMCC_RECORD_MAX_SIZE];
+  EXPECT_EQ(tmcc_record_encode(TMCCRecordedFrame{127, 0, TMCC1_HEADER, 1, false}, buffer), 4u);
+  EXPECT_EQ(tmcc_record_encode(TMCCRecordedFrame{128, 0, TMCC1_HEADER, 1, false}, buffer), 5u);
+  EXPECT_EQ(tmcc_record_encode(TMCCRecordedFrame{0xFFFFFFFF, 0, TMCC1_HEADER, 1, false}, buffer), 8u);
+  // Headers outside the format are refused
+  EXPECT_EQ(tmcc_record_encode(TMCCRecordedFrame{0, 0, 0x12, 1, false}, buffer), 0u);
+}
+
+TMCC_TEST(ring_keeps_the_latest_records) {
+  TMCCRecording recording;
+  ASSERT_TRUE(recording.init(16));  // Four 4-byte records
+  for (uint16_t i = 0; i < 6; i++) {
+    EXPECT_TRUE(recording.append(1000 + i * 100, TMCC1_HEADER, i, 1, false));
+  }
+  EXPECT_EQ(recording.get_record_count(), 4u);
+  EXPECT_EQ(recording.get_records_dropped(), 2u);
+
+  size_t offset = 0;
+  TMCCRecordedFrame frame;
+  for (uint16_t i = 2; i < 6; i++) {
+    ASSERT_TRUE(recording.read(&offset, &frame));
+    EXPECT_EQ(frame.word, i);
+    EXPECT_EQ(frame.delta_us, 100u);
+  }
+  EXPECT_FALSE(recording.read(&offset, &frame));
+}
+
+TMCC_TEST(clear_starts_a_new_session) {
+  TMCCRecording recording;
+  ASSERT_TRUE(recording.init(64));
+  recording.append(5, TMCC1_HEADER, 1, 1, false);
+  recording.clear();
+  EXPECT_EQ(recording.size(), 0u);
+  EXPECT_EQ(recording.get_record_count(), 0u);
+  size_t offset = 0;
+  TMCCRecordedFrame frame;
+  EXPECT_FALSE(recording.read(&offset, &frame));
+}
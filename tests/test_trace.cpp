@@ -0,0 +1,49 @@
+// Trace ring (tmcc_trace)
+
+#include "tmcc_test.h"
+#include "tmcc_trace.h"
+
+using namespace tmcc;
+
+static TMCCTraceRecord make_record(uint16_t word) {
+  TMCCTraceRecord record{};
+  record.timestamp_us = word * 10;
+  record.word = word;
+  record.header = TMCC1_HEADER;
+  record.repetitions = 1;
+  record.source = TMCCTraceSource::TX;
+  return record;
+}
+
+TMCC_TEST(uninitialised_buffer_ignores_records) {
+  TMCCTraceBuffer trace;
+  trace.record(make_record(1));
+  EXPECT_EQ(trace.size(), 0u);
+}
+
+TMCC_TEST(keeps_the_newest_records_oldest_first) {
+  TMCCTraceBuffer trace;
+  ASSERT_TRUE(trace.init(4));
+  for (uint16_t word = 1; word <= 6; word++) {
+    trace.record(make_record(word));
+  }
+  EXPECT_EQ(trace.size(), 4u);
+  EXPECT_EQ(trace.get_total_recorded(), 6u);
+  TMCCTraceRecord records[4];
+  ASSERT_EQ(trace.copy(0, records, 4), 4u);
+  for (uint16_t i = 0; i < 4; i++) {
+    EXPECT_EQ(records[i].word, i + 3);
+  }
+  // Partial copies start at a logical position
+  ASSERT_EQ(trace.copy(3, records, 4), 1u);
+  EXPECT_EQ(records[0].word, 6);
+}
+
+TMCC_TEST(clear_empties_the_ring) {
+  TMCCTraceBuffer trace;
+  ASSERT_TRUE(trace.init(4));
+  trace.record(make_record(1));
+  trace.clear();
+  EXPECT_EQ(trace.size(), 0u);
+  EXPECT_EQ(trace.capacity(), 4u);
+}
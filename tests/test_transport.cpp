@@ -0,0 +1,187 @@
+// Loopback and TCP transports on their own, without a bus: bytes in and
+// out, drops, and a TCP connection that never blocks the caller
+
+#include <unistd.h>
+
+#include <memory>
+
+#include "esphome/components/socket/socket.h"
+#include "esphome/core/hal.h"
+#include "tmcc_socket_transport.h"
+#include "tmcc_test.h"
+#include "tmcc_transport.h"
+
+using namespace tmcc;
+using esphome::socket::Socket;
+
+// Longest a transport call may take while the server is missing or silent
+static const uint32_t NON_BLOCKING_MS = 100;
+
+// One port per test, clear of the bridge test's range
+static uint16_t next_port() {
+  static uint16_t port = 40000 + getpid() % 20000;
+  return port++;
+}
+
+// A non-blocking listener on 127.0.0.1, standing in for the simulator
+static std::unique_ptr<Socket> listen_on(uint16_t port) {
+  auto server = esphome::socket::socket_ip(SOCK_STREAM, 0);
+  int enable = 1;
+  struct sockaddr_storage addr;
+  socklen_t len = esphome::socket::set_sockaddr(reinterpret_cast<struct sockaddr *>(&addr), sizeof(addr),
+                                                "127.0.0.1", port);
+  if (server == nullptr || server->setsockopt(SOL_SOCKET, SO_REUSEADDR, &enable, sizeof(enable)) != 0 ||
+      server->bind(reinterpret_cast<struct sockaddr *>(&addr), len) != 0 || server->listen(1) != 0) {
+    return nullptr;
+  }
+  server->setblocking(false);
+  return server;
+}
+
+static TMCCSocketTransport *make_socket_transport(const char *address, uint16_t port) {
+  auto *transport = new TMCCSocketTransport();
+  transport->set_address(address);
+  transport->set_port(port);
+  return transport;
+}
+
+// Poll the transport, as the receive task does, until the server accepts it
+static std::unique_ptr<Socket> accept_transport(Socket *server, TMCCSocketTransport *transport) {
+  std::unique_ptr<Socket> peer;
+  uint8_t byte;
+  tmcc_test::wait_for([&]() {
+    transport->read(&byte, 1);
+    peer = server->accept(nullptr, nullptr);
+    return peer != nullptr;
+  });
+  if (peer != nullptr) {
+    peer->setblocking(false);
+  }
+  return peer;
+}
+
+// ============================================================================
+// Loopback
+// ============================================================================
+
+TMCC_TEST(loopback_returns_what_was_written) {
+  TMCCLoopbackTransport transport;
+  ASSERT_TRUE(transport.begin());
+  const uint8_t frame[] = {TMCC1_HEADER, 0x00, 0x9C};
+  transport.write(frame, sizeof(frame));
+  transport.write(frame, sizeof(frame));
+
+  // Smaller reads than were written, then nothing left
+  uint8_t buffer[4];
+  EXPECT_EQ(transport.read(buffer, sizeof(buffer)), 4u);
+  EXPECT_EQ(buffer[3], TMCC1_HEADER);
+  EXPECT_EQ(transport.read(buffer, sizeof(buffer)), 2u);
+  EXPECT_EQ(buffer[1], 0x9C);
+  EXPECT_EQ(transport.read(buffer, sizeof(buffer)), 0u);
+  EXPECT_EQ(transport.get_bytes_written(), 6u);
+  EXPECT_EQ(transport.get_bytes_dropped(), 0u);
+}
+
+TMCC_TEST(loopback_drops_bytes_when_full) {
+  TMCCLoopbackTransport transport;
+  ASSERT_TRUE(transport.begin());
+  uint8_t bytes[TMCC_LOOPBACK_SIZE + 10];
+  for (size_t i = 0; i < sizeof(bytes); i++) {
+    bytes[i] = static_cast<uint8_t>(i);
+  }
+  transport.write(bytes, sizeof(bytes));
+  EXPECT_EQ(transport.get_bytes_dropped(), 10u);
+
+  // The oldest bytes are kept, and the ring takes writes again once read
+  uint8_t buffer[TMCC_LOOPBACK_SIZE];
+  ASSERT_EQ(transport.read(buffer, sizeof(buffer)), TMCC_LOOPBACK_SIZE);
+  EXPECT_EQ(buffer[0], 0);
+  EXPECT_EQ(buffer[TMCC_LOOPBACK_SIZE - 1], static_cast<uint8_t>(TMCC_LOOPBACK_SIZE - 1));
+  transport.write(bytes, 3);
+  EXPECT_EQ(transport.read(buffer, sizeof(buffer)), 3u);
+  EXPECT_EQ(transport.get_bytes_dropped(), 10u);
+}
+
+// ============================================================================
+// TCP
+// ============================================================================
+
+TMCC_TEST(socket_carries_bytes_both_ways) {
+  uint16_t port = next_port();
+  auto server = listen_on(port);
+  ASSERT_TRUE(server != nullptr);
+  TMCCSocketTransport *transport = make_socket_transport("127.0.0.1", port);
+  ASSERT_TRUE(transport->begin());
+  auto peer = accept_transport(server.get(), transport);
+  ASSERT_TRUE(peer != nullptr);
+
+  // The handshake may finish on the next call; writes before it are dropped
+  const uint8_t frame[] = {TMCC1_HEADER, 0x00, 0x9C};
+  std::vector<uint8_t> received;
+  ASSERT_TRUE(tmcc_test::wait_for([&]() {
+    if (received.empty()) {
+      transport->write(frame, sizeof(frame));
+    }
+    uint8_t buffer[16];
+    ssize_t len = peer->read(buffer, sizeof(buffer));
+    if (len > 0) {
+      received.insert(received.end(), buffer, buffer + len);
+    }
+    return received.size() >= sizeof(frame);
+  }));
+  EXPECT_TRUE(received == std::vector<uint8_t>(frame, frame + sizeof(frame)));
+  EXPECT_EQ(transport->get_bytes_dropped() % sizeof(frame), 0u);
+
+  const uint8_t reply[] = {TMCC2_ENGINE_HEADER, 0xFE, 0xFE};
+  ASSERT_EQ(peer->write(reply, sizeof(reply)), static_cast<ssize_t>(sizeof(reply)));
+  received.clear();
+  ASSERT_TRUE(tmcc_test::wait_for([&]() {
+    uint8_t buffer[16];
+    size_t len = transport->read(buffer, sizeof(buffer));
+    received.insert(received.end(), buffer, buffer + len);
+    return received.size() >= sizeof(reply);
+  }));
+  EXPECT_TRUE(received == std::vector<uint8_t>(reply, reply + sizeof(reply)));
+}
+
+TMCC_TEST(socket_notices_the_server_closing) {
+  uint16_t port = next_port();
+  auto server = listen_on(port);
+  ASSERT_TRUE(server != nullptr);
+  TMCCSocketTransport *transport = make_socket_transport("127.0.0.1", port);
+  ASSERT_TRUE(transport->begin());
+  auto peer = accept_transport(server.get(), transport);
+  ASSERT_TRUE(peer != nullptr);
+  peer->close();
+
+  // Once read() sees the close, writes are dropped until the retry is due
+  const uint8_t frame[] = {TMCC1_HEADER, 0x00, 0x9C};
+  ASSERT_TRUE(tmcc_test::wait_for([&]() {
+    uint32_t dropped = transport->get_bytes_dropped();
+    uint8_t buffer[4];
+    transport->read(buffer, sizeof(buffer));
+    transport->write(frame, sizeof(frame));
+    return transport->get_bytes_dropped() == dropped + sizeof(frame);
+  }));
+}
+
+TMCC_TEST(socket_never_blocks_without_a_server) {
+  // Nothing listens on the first; the second is not routed on a test host,
+  // so its connect would otherwise hang until the kernel gives up
+  uint16_t port = next_port();
+  const char *addresses[] = {"127.0.0.1", "10.255.255.1"};
+  for (const char *address : addresses) {
+    TMCCSocketTransport *transport = make_socket_transport(address, port);
+    ASSERT_TRUE(transport->begin());
+    const uint8_t frame[] = {TMCC1_HEADER, 0x00, 0x9C};
+    uint8_t buffer[4];
+    for (int i = 0; i < 20; i++) {
+      uint32_t start = esphome::millis();
+      EXPECT_EQ(transport->read(buffer, sizeof(buffer)), 0u);
+      transport->write(frame, sizeof(frame));
+      EXPECT_TRUE(esphome::millis() - start < NON_BLOCKING_MS);
+      esphome::delay(5);
+    }
+    EXPECT_EQ(transport->get_bytes_dropped(), 20 * sizeof(frame));
+  }
+}
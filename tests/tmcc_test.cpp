@@ -0,0 +1,98 @@
+#include "tmcc_test.h"
+
+#include <cstdlib>
+#include <cstring>
+
+namespace tmcc_test {
+
+struct Test {
+  const char *name;
+  TestFunction function;
+};
+
+static std::vector<Test> &tests() {
+  static std::vector<Test> list;
+  return list;
+}
+
+static int failures = 0;
+
+Registrar::Registrar(const char *name, TestFunction function) {
+  tests().push_back(Test{name, function});
+}
+
+void fail(const char *file, int line, const char *expression) {
+  std::printf("  %s:%d: check failed: %s\n", file, line, expression);
+  failures++;
+}
+
+std::vector<WireFrame> split_frames(const std::vector<uint8_t> &bytes) {
+  std::vector<WireFrame> frames;
+  for (size_t i = 0; i + tmcc::TMCC_FRAME_SIZE <= bytes.size(); i += tmcc::TMCC_FRAME_SIZE) {
+    frames.push_back(WireFrame{bytes[i], static_cast<uint16_t>((bytes[i + 1] << 8) | bytes[i + 2])});
+  }
+  return frames;
+}
+
+std::vector<WireFrame> HostBus::frames() const {
+  std::vector<uint8_t> bytes;
+  for (const esphome::uart::UARTByte &byte : this->uart->get_tx()) {
+    bytes.push_back(byte.value);
+  }
+  return split_frames(bytes);
+}
+
+size_t HostBus::frame_count() const {
+  return this->uart->get_tx_size() / tmcc::TMCC_FRAME_SIZE;
+}
+
+bool HostBus::wait_frames(size_t count, uint32_t timeout_ms) const {
+  return wait_for([this, count]() { return this->frame_count() >= count; }, timeout_ms);
+}
+
+HostBus make_bus(const std::function<void(tmcc::TMCCBus *)> &configure) {
+  HostBus host;
+  host.uart = new esphome::uart::UARTComponent();
+  host.transport = new tmcc::TMCCUARTTransport();
+  host.transport->set_uart(host.uart);
+  host.bus = new tmcc::TMCCBus();
+  host.bus->set_transport(host.transport);
+  if (configure) {
+    configure(host.bus);
+  }
+  host.bus->setup();
+  esphome::App.register_component(host.bus);
+  return host;
+}
+
+bool wait_for(const std::function<bool()> &done, uint32_t timeout_ms) {
+  return esphome::App.loop_until(done, timeout_ms);
+}
+
+}  // namespace tmcc_test
+
+// Usage: <test> [name]  runs every test, or only the one named
+int main(int argc, char **argv) {
+  int run = 0;
+  int failed_tests = 0;
+  for (const tmcc_test::Test &test : tmcc_test::tests()) {
+    if (argc > 1 && std::strcmp(argv[1], test.name) != 0) {
+      continue;
+    }
+    int before = tmcc_test::failures;
+    std::printf("[ RUN  ] %s\n", test.name);
+    std::fflush(stdout);
+    test.function();
+    // Components registered by one test must not be looped by the next
+    esphome::App.clear();
+    bool passed = tmcc_test::failures == before;
+    std::printf("[ %s ] %s\n", passed ? " OK " : "FAIL", test.name);
+    failed_tests += passed ? 0 : 1;
+    run++;
+  }
+  std::printf("%d test(s), %d failed\n", run, failed_tests);
+  std::fflush(stdout);
+  // Bus tasks run until the process exits and the objects they use are
+  // never freed, so skip static destructors
+  std::_Exit(failed_tests == 0 && run > 0 ? EXIT_SUCCESS : EXIT_FAILURE);
+}
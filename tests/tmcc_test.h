@@ -0,0 +1,85 @@
+#pragma once
+
+// Minimal test harness for the host build. Each test file defines tests
+// with TMCC_TEST and links tmcc_test.cpp, which provides main().
+
+#include <cstdint>
+#include <cstdio>
+#include <functional>
+#include <vector>
+
+#include "esphome/components/uart/uart.h"
+#include "esphome/core/component.h"
+#include "tmcc.h"
+#include "tmcc_protocol.h"
+#include "tmcc_uart_transport.h"
+
+namespace tmcc_test {
+
+using TestFunction = void (*)();
+
+struct Registrar {
+  Registrar(const char *name, TestFunction function);
+};
+
+// Record a failed check; the test keeps running unless it returns
+void fail(const char *file, int line, const char *expression);
+
+// One frame as it went out on the wire
+struct WireFrame {
+  uint8_t header;
+  uint16_t word;
+  bool operator==(const WireFrame &other) const { return header == other.header && word == other.word; }
+};
+
+// Split bytes written to the wire into 3-byte frames
+std::vector<WireFrame> split_frames(const std::vector<uint8_t> &bytes);
+
+// A bus on the UART stub, set up and registered with App. Bus objects are
+// never freed: their tasks run until the process exits. Only `bus` is set
+// when a test runs the bus on another transport.
+struct HostBus {
+  esphome::uart::UARTComponent *uart{nullptr};
+  tmcc::TMCCUARTTransport *transport{nullptr};
+  tmcc::TMCCBus *bus{nullptr};
+
+  // Every frame written so far, and how many
+  std::vector<WireFrame> frames() const;
+  size_t frame_count() const;
+  // Wait until at least `count` frames were written
+  bool wait_frames(size_t count, uint32_t timeout_ms = 2000) const;
+};
+// `configure` runs before setup(), for queue size, pacing, ...
+HostBus make_bus(const std::function<void(tmcc::TMCCBus *)> &configure = nullptr);
+
+// Run App.loop() until `done` or the timeout; true if `done` held
+bool wait_for(const std::function<bool()> &done, uint32_t timeout_ms = 2000);
+
+}  // namespace tmcc_test
+
+#define TMCC_TEST(name) \
+  static void name(); \
+  static const ::tmcc_test::Registrar name##_registrar(#name, name); \
+  static void name()
+
+#define EXPECT_TRUE(expression) \
+  do { \
+    if (!(expression)) { \
+      ::tmcc_test::fail(__FILE__, __LINE__, #expression); \
+    } \
+  } while (0)
+
+#define EXPECT_FALSE(expression) EXPECT_TRUE(!(expression))
+#define EXPECT_EQ(a, b) EXPECT_TRUE((a) == (b))
+#define EXPECT_NE(a, b) EXPECT_TRUE((a) != (b))
+
+// Stop the current test on failure
+#define ASSERT_TRUE(expression) \
+  do { \
+    if (!(expression)) { \
+      ::tmcc_test::fail(__FILE__, __LINE__, #expression); \
+      return; \
+    } \
+  } while (0)
+
+#define ASSERT_EQ(a, b) ASSERT_TRUE((a) == (b))
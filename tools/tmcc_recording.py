@@ -0,0 +1,89 @@
+#!/usr/bin/env python3
+"""Decode a TMCC recorder dump to text.
+
+The recorder's dump button logs the recording as lines like
+
+    [I][tmcc.recorder:170]: REC 0000: 00 01 FE 00 41 ...
+
+Pass a saved log (or pipe one in); every REC line is collected in order and
+decoded. With --binary the input is the raw recording bytes instead. The
+format is described in components/tmcc/tmcc_recording.h.
+"""
+
+import argparse
+import re
+import sys
+
+HEADERS = (0xFE, 0xF8, 0xF9, 0xFB)
+MAX_VARINT_SIZE = 5
+REC_LINE = re.compile(r"REC ([0-9A-Fa-f]{4}):((?: [0-9A-Fa-f]{2})+)")
+
+
+def bytes_from_log(text):
+    data = bytearray()
+    for match in REC_LINE.finditer(text):
+        offset = int(match.group(1), 16)
+        if offset != len(data) % 0x10000:
+            raise ValueError(f"REC line at offset 0x{offset:04X} is missing data before it")
+        data.extend(int(byte, 16) for byte in match.group(2).split())
+    return bytes(data)
+
+
+def decode(data):
+    """Yield (delta_us, header, word, repetitions, chain_next) per record."""
+    pos = 0
+    while pos < len(data):
+        delta = 0
+        for shift in range(MAX_VARINT_SIZE):
+            if pos >= len(data):
+                raise ValueError(f"Truncated record at byte {pos}")
+            byte = data[pos]
+            pos += 1
+            delta |= (byte & 0x7F) << (7 * shift)
+            if not byte & 0x80:
+                break
+        else:
+            raise ValueError(f"Bad delta at byte {pos}")
+        if pos + 3 > len(data):
+            raise ValueError(f"Truncated record at byte {pos}")
+        control = data[pos]
+        word = (data[pos + 1] << 8) | data[pos + 2]
+        pos += 3
+        yield delta, HEADERS[(control >> 5) & 0x03], word, control & 0x1F, bool(control & 0x80)
+
+
+def describe(header, word):
+    if header == 0xFE and word == 0xFFFF:
+        return "system halt"
+    if header == 0xFE:
+        return f"tmcc1 type={word >> 14} address={(word >> 7) & 0x7F} data=0x{word & 0x7F:02X}"
+    return f"legacy address={(word >> 9) & 0x7F} data=0x{word & 0x1FF:03X}"
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("input", nargs="?", default="-", help="log file, or - for stdin")
+    parser.add_argument("--binary", action="store_true", help="input is the raw recording")
+    args = parser.parse_args()
+
+    if args.binary:
+        stream = sys.stdin.buffer if args.input == "-" else open(args.input, "rb")
+        data = stream.read()
+    else:
+        stream = sys.stdin if args.input == "-" else open(args.input, encoding="utf-8")
+        data = bytes_from_log(stream.read())
+
+    time_us = 0
+    for index, (delta, header, word, repetitions, chain_next) in enumerate(decode(data)):
+        # The first delta refers to a command no longer in the ring
+        if index > 0:
+            time_us += delta
+        chain = " +" if chain_next else ""
+        print(
+            f"{time_us / 1000:10.3f} ms  [0x{header:02X}, 0x{word >> 8:02X}, 0x{word & 0xFF:02X}]"
+            f" x{repetitions:<2} {describe(header, word)}{chain}"
+        )
+
+
+if __name__ == "__main__":
+    main()